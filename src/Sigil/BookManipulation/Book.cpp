@@ -29,12 +29,13 @@
 #include <QtWidgets/QProgressDialog>
 
 #include "BookManipulation/Book.h"
+#include "BookManipulation/BookReports.h"
 #include "BookManipulation/CleanSource.h"
 #include "BookManipulation/FolderKeeper.h"
 #include "BookManipulation/XercesCppUse.h"
 #include "Misc/TempFolder.h"
 #include "Misc/Utility.h"
-#include "Misc/HTMLSpellCheck.h"
+#include "Misc/XMLEntities.h"
 #include "ResourceObjects/HTMLResource.h"
 #include "ResourceObjects/NCXResource.h"
 #include "ResourceObjects/OPFResource.h"
@@ -140,11 +141,17 @@ const QString HTML_COVER_SOURCE =
 Book::Book()
     :
     m_Mainfolder(*new FolderKeeper(this)),
+    m_HTMLFileDataCache(new HTMLFileDataCache()),
     m_IsModified(false)
 {
 }
 
 
+Book::~Book()
+{
+}
+
+
 QUrl Book::GetBaseUrl() const
 {
     return QUrl::fromLocalFile(m_Mainfolder.GetFullPathToTextFolder() + "/");
@@ -795,41 +802,56 @@ QList<HTMLResource *> Book::GetNonWellFormedHTMLFiles()
 
 QSet<QString> Book::GetWordsInHTMLFiles()
 {
-    QStringList all_words;
-    const QList<HTMLResource *> html_resources = m_Mainfolder.GetResourceTypeList<HTMLResource>(false);
-    QFuture<QStringList> future = QtConcurrent::mapped(html_resources, GetWordsInHTMLFileMapped);
+    return GetWordIndex().GetWordCounts().keys().toSet();
+}
 
-    for (int i = 0; i < future.results().count(); i++) {
-        QStringList result = future.resultAt(i);
-        all_words.append(result);
-    }
+QHash<QString, int> Book::GetUniqueWordsInHTMLFiles()
+{
+    return GetWordIndex().GetWordCounts();
+}
 
-    return all_words.toSet();
+WordIndex &Book::GetWordIndex()
+{
+    m_WordIndex.Update(m_Mainfolder.GetResourceTypeList<HTMLResource>(false));
+    return m_WordIndex;
 }
 
-QStringList Book::GetWordsInHTMLFileMapped(HTMLResource *html_resource)
+HTMLFileDataCache &Book::GetHTMLFileDataCache()
 {
-    return HTMLSpellCheck::GetAllWords(html_resource->GetText());
+    return *m_HTMLFileDataCache;
 }
 
-QHash<QString, int> Book::GetUniqueWordsInHTMLFiles()
+QHash<QChar, int> Book::GetCharactersInHTMLFiles()
 {
-    QHash<QString, int> all_words;
+    QHash<QChar, int> all_characters;
+    // The entity tables are built lazily; do it before the worker threads need them.
+    XMLEntities::instance();
     const QList<HTMLResource *> html_resources = m_Mainfolder.GetResourceTypeList<HTMLResource>(false);
-    QFuture<QStringList> future = QtConcurrent::mapped(html_resources, GetWordsInHTMLFileMapped);
+    QFuture<QHash<QChar, int>> future = QtConcurrent::mapped(html_resources, GetCharactersInHTMLFileMapped);
 
     for (int i = 0; i < future.results().count(); i++) {
-        QStringList result = future.resultAt(i);
-        foreach (QString word, result) {
-            if (all_words.contains(word)) {
-                all_words[word]++;
-            } else {
-                all_words[word] = 1;
-            }
+        QHashIterator<QChar, int> it(future.resultAt(i));
+
+        while (it.hasNext()) {
+            it.next();
+            all_characters[it.key()] += it.value();
         }
     }
 
-    return all_words;
+    return all_characters;
+}
+
+QHash<QChar, int> Book::GetCharactersInHTMLFileMapped(HTMLResource *html_resource)
+{
+    QHash<QChar, int> characters;
+    const QString text = XhtmlDoc::GetVisibleTextInHtml(html_resource->GetText());
+    foreach (const QChar c, text) {
+        // Line breaks are layout, not content.
+        if (c != '\n' && c != '\r' && c != '\t') {
+            characters[c]++;
+        }
+    }
+    return characters;
 }
 
 QHash<QString, QStringList> Book::GetStylesheetsInHTMLFiles()
@@ -952,6 +974,25 @@ void Book::SaveAllResourcesToDisk()
 }
 
 
+void Book::SaveDirtyResourcesToDisk()
+{
+    QList<Resource *> resources;
+    foreach(Resource * resource, m_Mainfolder.GetResourceList()) {
+        if (resource->IsDirty()) {
+            resources.append(resource);
+        }
+    }
+
+    if (resources.isEmpty()) {
+        return;
+    }
+
+    m_Mainfolder.SuspendWatchingResources();
+    QtConcurrent::blockingMap(resources, SaveOneResourceToDisk);
+    m_Mainfolder.ResumeWatchingResources();
+}
+
+
 bool Book::IsModified() const
 {
     return m_IsModified;
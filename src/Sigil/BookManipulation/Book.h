@@ -27,13 +27,16 @@
 
 #include <QtCore/QHash>
 #include <QtCore/QObject>
+#include <QtCore/QScopedPointer>
 #include <QtCore/QUrl>
 #include <QtCore/QVariant>
 #include "BookManipulation/Metadata.h"
+#include "BookManipulation/WordIndex.h"
 #include "BookManipulation/XhtmlDoc.h"
 #include "ResourceObjects/Resource.h"
 
 class CSSResource;
+struct HTMLFileDataCache;
 class SVGResource;
 class FolderKeeper;
 class HTMLResource;
@@ -57,6 +60,8 @@ public:
      */
     Book();
 
+    ~Book();
+
     /**
      * Returns the base url of the book.
      * This is the location of the text folder
@@ -224,10 +229,30 @@ public:
     QStringList GetClassesInHTMLFile(QString filename);
 
     QSet<QString> GetWordsInHTMLFiles();
-    static QStringList GetWordsInHTMLFileMapped(HTMLResource *html_resource);
 
     QHash<QString, int> GetUniqueWordsInHTMLFiles();
 
+    /**
+     * Returns the index of the words in the HTML files,
+     * brought up to date with the current text of the files.
+     */
+    WordIndex &GetWordIndex();
+
+    /**
+     * Returns the report data of the HTML files kept between
+     * calls to BookReports::GetHTMLFileData().
+     */
+    HTMLFileDataCache &GetHTMLFileDataCache();
+
+    /**
+     * Counts every character displayed in the HTML files.
+     * Files are processed in parallel and their counts merged.
+     *
+     * @return The number of times each character is used.
+     */
+    QHash<QChar, int> GetCharactersInHTMLFiles();
+    static QHash<QChar, int> GetCharactersInHTMLFileMapped(HTMLResource *html_resource);
+
     QHash<QString, QStringList> GetStylesheetsInHTMLFiles();
     static boost::tuple<QString, QStringList> GetStylesheetsInHTMLFileMapped(HTMLResource *html_resource);
     QStringList GetStylesheetsInHTMLFile(HTMLResource *html_resource);
@@ -261,6 +286,13 @@ public:
      */
     void SaveAllResourcesToDisk();
 
+    /**
+     * Saves only the resources that hold changes not yet on disk.
+     * Cheaper than SaveAllResourcesToDisk() when few resources
+     * have been edited since the last save.
+     */
+    void SaveDirtyResourcesToDisk();
+
 
     /**
      * Returns the modified state of the book. A book
@@ -392,6 +424,16 @@ private:
      */
     FolderKeeper &m_Mainfolder;
 
+    /**
+     * The words in the HTML files. @see GetWordIndex()
+     */
+    WordIndex m_WordIndex;
+
+    /**
+     * @see GetHTMLFileDataCache()
+     */
+    QScopedPointer<HTMLFileDataCache> m_HTMLFileDataCache;
+
     /**
      * A hash with meta information about the book. The keys are
      * are the metadata names, and the values are the lists of
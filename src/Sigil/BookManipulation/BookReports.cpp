@@ -23,6 +23,7 @@
 
 #include <QtCore/QFile>
 #include <QtCore/QHashIterator>
+#include <QtConcurrent/QtConcurrent>
 #include <QtGui/QFont>
 #include <QtWidgets/QMessageBox>
 #include <QtWidgets/QApplication>
@@ -32,22 +33,162 @@
 #include "BookManipulation/BookReports.h"
 #include "BookManipulation/FolderKeeper.h"
 #include "Misc/CSSInfo.h"
+#include "Misc/HTMLSpellCheck.h"
 #include "Misc/SettingsStore.h"
+#include "Misc/SpellCheck.h"
+#include "sigil_constants.h"
+#include "sigil_exception.h"
+
+QHash<QString, BookReports::HTMLFileData> BookReports::GetHTMLFileData(QSharedPointer<Book> book)
+{
+    // Words are split using the word characters of the dictionary
+    SpellCheck *sc = SpellCheck::instance();
+    sc->waitForDictionary();
+    HTMLFileDataCache &book_cache = book->GetHTMLFileDataCache();
+
+    if (book_cache.dictionary != sc->currentDictionary() ||
+        book_cache.word_chars != sc->getWordChars()) {
+        book_cache.files.clear();
+        book_cache.dictionary = sc->currentDictionary();
+        book_cache.word_chars = sc->getWordChars();
+    }
+
+    QList<HTMLResource *> html_resources = book->GetFolderKeeper().GetResourceTypeList<HTMLResource>(false);
+    QList<HTMLResource *> stale_resources;
+    QList<int> stale_versions;
+    QHash<QString, HTMLFileDataCache::CachedHTMLFileData> cache;
+    foreach(HTMLResource * html_resource, html_resources) {
+        const QString identifier = html_resource->GetIdentifier();
+        const int version = html_resource->GetTextVersion();
+
+        if (book_cache.files.contains(identifier) &&
+            book_cache.files.value(identifier).text_version == version) {
+            cache.insert(identifier, book_cache.files.value(identifier));
+        } else {
+            stale_resources.append(html_resource);
+            stale_versions.append(version);
+        }
+    }
+
+    if (!stale_resources.isEmpty()) {
+        QList<BookReports::HTMLFileData> results = QtConcurrent::blockingMapped(stale_resources, GetHTMLFileDataMapped);
+
+        for (int i = 0; i < stale_resources.count(); i++) {
+            HTMLFileDataCache::CachedHTMLFileData cached;
+            cached.text_version = stale_versions.at(i);
+            cached.data = results.at(i);
+            cache.insert(stale_resources.at(i)->GetIdentifier(), cached);
+        }
+    }
+
+    // Only keep the files still in the book
+    book_cache.files = cache;
+    QHash<QString, BookReports::HTMLFileData> html_file_data;
+    foreach(HTMLResource * html_resource, html_resources) {
+        BookReports::HTMLFileData data = cache.value(html_resource->GetIdentifier()).data;
+        // Renaming a file does not change its text version
+        data.filename = html_resource->Filename();
+        html_file_data.insert(data.filename, data);
+    }
+    return html_file_data;
+}
+
+BookReports::HTMLFileData BookReports::GetHTMLFileDataMapped(HTMLResource *html_resource)
+{
+    BookReports::HTMLFileData data;
+    data.filename = html_resource->Filename();
+    QString text;
+    {
+        QReadLocker locker(&html_resource->GetLock());
+        text = html_resource->GetText();
+    }
+    data.well_formed = XhtmlDoc::IsDataWellFormed(text);
+    foreach(HTMLSpellCheck::MisspelledWord word, HTMLSpellCheck::GetWords(text)) {
+        data.words[word.language][word.text]++;
+    }
+    data.stylesheets = XhtmlDoc::GetLinkedStylesheets(text);
+
+    try {
+        data.links = XhtmlDoc::GetTagsInDocument(text, "a");
+    } catch (ErrorParsingXml) {
+        // No links then.
+    }
+
+    // The remaining data needs a DOM, which we can't build from broken markup.
+    if (!data.well_formed) {
+        return data;
+    }
+
+    boost::shared_ptr<xc::DOMDocument> document = XhtmlDoc::LoadTextIntoDocument(text);
+    data.images = XhtmlDoc::GetAllMediaPathsFromMediaChildren(*document.get(), IMAGE_TAGS);
+    data.video = XhtmlDoc::GetAllMediaPathsFromMediaChildren(*document.get(), VIDEO_TAGS);
+    data.audio = XhtmlDoc::GetAllMediaPathsFromMediaChildren(*document.get(), AUDIO_TAGS);
+    data.classes = XhtmlDoc::GetAllDescendantClasses(*document->getDocumentElement());
+    data.ids = XhtmlDoc::GetAllDescendantIDs(*document->getDocumentElement());
+    return data;
+}
+
+QHash<QString, int> BookReports::CountMisspelledWords(const QHash<QString, BookReports::HTMLFileData> &html_file_data)
+{
+    // Each dictionary is only used by one thread at a time,
+    // so this part stays on the calling thread.
+    SpellCheck *sc = SpellCheck::instance();
+    QHash<QString, QHash<QString, bool> > word_is_correct;
+    QHash<QString, int> misspelled_counts;
+    foreach(BookReports::HTMLFileData data, html_file_data) {
+        int misspelled = 0;
+        QHashIterator<QString, QHash<QString, int> > language_it(data.words);
+
+        while (language_it.hasNext()) {
+            language_it.next();
+            const QString &language = language_it.key();
+            QHash<QString, bool> &is_correct = word_is_correct[language];
+            QHashIterator<QString, int> it(language_it.value());
+
+            while (it.hasNext()) {
+                it.next();
+
+                if (!is_correct.contains(it.key())) {
+                    is_correct.insert(it.key(), sc->spell(it.key(), language));
+                }
+
+                if (!is_correct.value(it.key())) {
+                    misspelled += it.value();
+                }
+            }
+        }
+
+        misspelled_counts.insert(data.filename, misspelled);
+    }
+    return misspelled_counts;
+}
+
+int BookReports::CountAllWords(const BookReports::HTMLFileData &html_file_data)
+{
+    int count = 0;
+    foreach(QHash<QString, int> language_words, html_file_data.words) {
+        foreach(int word_count, language_words) {
+            count += word_count;
+        }
+    }
+    return count;
+}
 
 QList<BookReports::StyleData *> BookReports::GetHTMLClassUsage(QSharedPointer<Book> book, bool show_progress)
 {
     QList<HTMLResource *> html_resources = book->GetFolderKeeper().GetResourceTypeList<HTMLResource>(false);
     QList<CSSResource *> css_resources = book->GetFolderKeeper().GetResourceTypeList<CSSResource>(false);
     QList<BookReports::StyleData *> html_classes_usage;
-    // Save each CSS file's text so we don't have to reload it when checking each HTML file
-    QHash<QString, QString> css_text;
+    // Parse each CSS file once so we don't have to reparse it for every class in every HTML file
+    QHash<QString, QSharedPointer<CSSInfo>> css_info_for_file;
     foreach(CSSResource * css_resource, css_resources) {
         QString css_filename = "../" + css_resource->GetRelativePathToOEBPS();
 
-        if (!css_text.contains(css_filename)) {
-            css_text[css_filename] = css_resource->GetText();
+        if (!css_info_for_file.contains(css_filename)) {
+            css_info_for_file[css_filename] = QSharedPointer<CSSInfo>(new CSSInfo(css_resource->GetText(), true));
         }
     }
+    QHash<QString, BookReports::HTMLFileData> html_file_data = GetHTMLFileData(book);
 
     // Display progress dialog
     QProgressDialog progress(QObject::tr("Collecting classes..."), 0, 0, html_resources.count(), QApplication::activeWindow());
@@ -67,10 +208,10 @@ QList<BookReports::StyleData *> BookReports::GetHTMLClassUsage(QSharedPointer<Bo
 
         QString html_filename = html_resource->Filename();
         // Get the unique list of classes in this file
-        QStringList classes_in_file = book->GetClassesInHTMLFile(html_filename);
+        QStringList classes_in_file = html_file_data.value(html_filename).classes;
         classes_in_file.removeDuplicates();
         // Get the linked stylesheets for this file
-        QStringList linked_stylesheets = book->GetStylesheetsInHTMLFile(html_resource);
+        QStringList linked_stylesheets = html_file_data.value(html_filename).stylesheets;
         // Look at each class from the HTML file
         foreach(QString class_name, classes_in_file) {
             QString found_location;
@@ -84,9 +225,8 @@ QList<BookReports::StyleData *> BookReports::GetHTMLClassUsage(QSharedPointer<Bo
             class_usage->html_class_name = class_part;
             // Look in each stylesheet
             foreach(QString css_filename, linked_stylesheets) {
-                if (css_text.contains(css_filename)) {
-                    CSSInfo css_info(css_text[css_filename], true);
-                    CSSInfo::CSSSelector *selector = css_info.getCSSSelectorForElementClass(element_part, class_part);
+                if (css_info_for_file.contains(css_filename)) {
+                    CSSInfo::CSSSelector *selector = css_info_for_file[css_filename]->getCSSSelectorForElementClass(element_part, class_part);
 
                     // If class matched a selector in a linked stylesheet, we're done
                     if (selector && (selector->classNames.count() > 0)) {
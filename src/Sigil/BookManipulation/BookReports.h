@@ -46,8 +46,64 @@ public:
         int css_selector_position;
     };
 
+    // Everything the reports need to know about one HTML file,
+    // gathered in a single pass over its text
+    struct HTMLFileData {
+        QString filename;
+        bool well_formed;
+        // Word counts keyed by the language of the words
+        QHash<QString, QHash<QString, int> > words;
+        QStringList images;
+        QStringList video;
+        QStringList audio;
+        QStringList stylesheets;
+        QStringList classes;
+        QStringList ids;
+        QList<XhtmlDoc::XMLElement> links;
+
+        HTMLFileData() : well_formed(true) {}
+    };
+
+    /**
+     * Returns the report data for every HTML file in the book, keyed by filename.
+     * Files are processed in parallel. Results are cached by the text
+     * version of each resource, so only files that changed since the
+     * last call are processed again.
+     */
+    static QHash<QString, BookReports::HTMLFileData> GetHTMLFileData(QSharedPointer<Book> book);
+
+    /**
+     * Returns the number of misspelled words in each file, keyed by filename.
+     * Each distinct word in the book is spellchecked only once.
+     */
+    static QHash<QString, int> CountMisspelledWords(const QHash<QString, BookReports::HTMLFileData> &html_file_data);
+
+    static int CountAllWords(const BookReports::HTMLFileData &html_file_data);
+
     static QList<BookReports::StyleData *> GetHTMLClassUsage(QSharedPointer<Book> book, bool show_progress = false);
     static QList<BookReports::StyleData *> GetCSSSelectorUsage(QSharedPointer<Book> book, QList<BookReports::StyleData *> html_classes_usage);
+
+private:
+    static BookReports::HTMLFileData GetHTMLFileDataMapped(HTMLResource *html_resource);
+};
+
+/**
+ * The report data of the HTML files of one book.
+ * Kept by the Book between calls to BookReports::GetHTMLFileData().
+ */
+struct HTMLFileDataCache {
+    struct CachedHTMLFileData {
+        // The text version the data was computed from
+        int text_version;
+        BookReports::HTMLFileData data;
+    };
+
+    // Keyed by resource identifier
+    QHash<QString, CachedHTMLFileData> files;
+
+    // The dictionary and its word characters the words were split with
+    QString dictionary;
+    QString word_chars;
 };
 
 #endif // BOOKREPORTS_H
@@ -22,9 +22,14 @@
 #include <boost/tuple/tuple.hpp>
 #include <buffio.h>
 
+#include <QtCore/QEventLoop>
+#include <QtCore/QFutureWatcher>
+#include <QtCore/QHash>
 #include <QtCore/QString>
 #include <QtCore/QStringList>
+#include <QtCore/QThreadStorage>
 #include <QtCore/QWriteLocker>
+#include <QtConcurrent/QtConcurrent>
 #include <QtWidgets/QApplication>
 #include <QtWidgets/QProgressDialog>
 #include <QRegularExpression>
@@ -33,6 +38,7 @@
 #include "BookManipulation/CleanSource.h"
 #include "BookManipulation/XhtmlDoc.h"
 #include "Misc/HTMLPrettyPrint.h"
+#include "Misc/SettingsSnapshot.h"
 #include "Misc/SettingsStore.h"
 #include "sigil_constants.h"
 #include "sigil_exception.h"
@@ -77,6 +83,23 @@ static const QString SVG_BLOCK_ELEMENTS         = "a,altGlyph,altGlyphDef,altGly
 static const QString SVG_INLINE_ELEMENTS = "image";
 static const QString SVG_EMPTY_ELEMENTS = "image";
 
+// Tidy documents holding the options for each TidyType.
+// Kept per thread so the options are only set up once per thread
+// and then copied into every new document.
+class TidyOptionTemplates
+{
+public:
+    ~TidyOptionTemplates() {
+        foreach(TidyDoc tidy_document, templates) {
+            tidyRelease(tidy_document);
+        }
+    }
+
+    QHash<int, TidyDoc> templates;
+};
+
+static QThreadStorage<TidyOptionTemplates *> s_TidyOptionTemplates;
+
 static QString HTML5_BLOCK_ELEMENTS       = "article,aside,audio,canvas,datagrid,details,dialog"
         ",figcaption,figure,footer,header,hgroup,menu,nav,section,source,summary,video";
 
@@ -92,8 +115,7 @@ static QString EMPTY_ELEMENTS             = HTML5_EMPTY_ELEMENTS  + "," + SVG_EM
 // of provided book XHTML source code
 QString CleanSource::Clean(const QString &source)
 {
-    SettingsStore settings;
-    SettingsStore::CleanLevel level = settings.cleanLevel();
+    SettingsStore::CleanLevel level = SettingsSnapshot::instance()->cleanLevel();
     QString newsource = PreprocessSpecialCases(source);
 
     switch (level) {
@@ -369,6 +391,22 @@ TidyDoc CleanSource::TidyOptions(TidyDoc tidy_document, TidyType type, int max_c
 }
 
 
+TidyDoc CleanSource::TidyOptionsTemplate(TidyType type)
+{
+    if (!s_TidyOptionTemplates.hasLocalData()) {
+        s_TidyOptionTemplates.setLocalData(new TidyOptionTemplates());
+    }
+
+    QHash<int, TidyDoc> &templates = s_TidyOptionTemplates.localData()->templates;
+
+    if (!templates.contains(type)) {
+        templates.insert(type, TidyOptions(tidyCreate(), type));
+    }
+
+    return templates.value(type);
+}
+
+
 // Runs HTML Tidy on the provided XHTML source code
 QString CleanSource::HTMLTidy(const QString &source, TidyType type)
 {
@@ -379,11 +417,10 @@ QString CleanSource::HTMLTidy(const QString &source, TidyType type)
     TidyDoc tidy_document = tidyCreate();
     TidyBuffer output = { 0 };
     TidyBuffer errbuf = { 0 };
+    tidyOptCopyConfig(tidy_document, TidyOptionsTemplate(type));
 
     if (type == Tidy_Clean) {
-        tidy_document = TidyOptions(tidy_document, type, MaxSigilCSSClassIndex(CSSStyleTags(source)));
-    } else {
-        tidy_document = TidyOptions(tidy_document, type);
+        tidyOptSetInt(tidy_document, TidyClassStartID, MaxSigilCSSClassIndex(CSSStyleTags(source)));
     }
 
     // Write all errors to error buffer
@@ -605,9 +642,8 @@ QString CleanSource::PrettifyDOCTYPEHeader(const QString &source)
 
 QString CleanSource::CharToEntity(const QString &source)
 {
-    SettingsStore settings;
     QString new_source = source;
-    QList<std::pair <ushort, QString>> codenames = settings.preserveEntityCodeNames();
+    QList<std::pair <ushort, QString>> codenames = SettingsSnapshot::instance()->preserveEntityCodeNames();
     std::pair <ushort, QString> epair;
     foreach(epair, codenames) {
         new_source.replace(QChar(epair.first), epair.second);
@@ -618,16 +654,38 @@ QString CleanSource::CharToEntity(const QString &source)
 
 void CleanSource::ReformatAll(QList <HTMLResource *> resources, QString(clean_func)(const QString &source))
 {
-    //QList <Resource *> resources = m_OPFModel.GetResourceListInFolder( Resource::HTMLResourceType );
-    QProgressDialog progress(QObject::tr("Cleaning..."), 0, 0, resources.count(), Utility::GetMainWindow());
+    QProgressDialog progress(QObject::tr("Cleaning..."), QObject::tr("Cancel"), 0, resources.count(), Utility::GetMainWindow());
+    progress.setWindowModality(Qt::WindowModal);
     progress.setMinimumDuration(PROGRESS_BAR_MINIMUM_DURATION);
-    int progress_value = 0;
-    progress.setValue(progress_value);
+    progress.setValue(0);
+    QStringList sources;
     foreach(HTMLResource * resource, resources) {
-        progress.setValue(progress_value++);
-        qApp->processEvents();
-        QWriteLocker locker(&resource->GetLock());
-        resource->SetText(clean_func(resource->GetText()));
+        QReadLocker locker(&resource->GetLock());
+        sources.append(resource->GetText());
     }
-}
 
+    // Clean all the files on worker threads while the
+    // progress dialog stays responsive here.
+    QFutureWatcher<QString> watcher;
+    QEventLoop loop;
+    QObject::connect(&watcher, SIGNAL(progressValueChanged(int)), &progress, SLOT(setValue(int)));
+    QObject::connect(&progress, SIGNAL(canceled()), &watcher, SLOT(cancel()));
+    QObject::connect(&watcher, SIGNAL(finished()), &loop, SLOT(quit()));
+    watcher.setFuture(QtConcurrent::mapped(sources, clean_func));
+    loop.exec();
+
+    // A cancelled run leaves every file untouched.
+    if (watcher.isCanceled()) {
+        return;
+    }
+
+    QStringList cleaned = watcher.future().results();
+
+    for (int i = 0; i < resources.count(); ++i) {
+        if (cleaned.at(i) != sources.at(i)) {
+            HTMLResource *resource = resources.at(i);
+            QWriteLocker locker(&resource->GetLock());
+            resource->SetText(cleaned.at(i));
+        }
+    }
+}
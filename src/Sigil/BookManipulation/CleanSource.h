@@ -57,6 +57,9 @@ public:
 
     static QString CharToEntity(const QString &source);
 
+    // Runs clean_fun over all the resources in parallel and
+    // sets the results only once every file has been cleaned.
+    // Nothing is changed if the user cancels.
     static void ReformatAll(QList <HTMLResource *> resources, QString(clean_fun)(const QString &source));
 
 private:
@@ -100,6 +103,10 @@ private:
 
     static TidyDoc TidyOptions(TidyDoc tidy_document, TidyType type, int max_class_index = 0);
 
+    // Returns a document with the options for the type already set,
+    // to be copied into new documents. Owned by the calling thread.
+    static TidyDoc TidyOptionsTemplate(TidyType type);
+
     // Runs HTML Tidy on the provided XHTML source code
     static QString HTMLTidy(const QString &source, TidyType type);
 
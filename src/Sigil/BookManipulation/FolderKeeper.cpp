@@ -22,6 +22,7 @@
 #include <QtCore/QDir>
 #include <QtCore/QFile>
 #include <QtCore/QFileInfo>
+#include <QtCore/QSet>
 #include <QtCore/QString>
 #include <QtCore/QThread>
 #include <QtCore/QTime>
@@ -92,6 +93,7 @@ FolderKeeper::FolderKeeper(QObject *parent)
     m_OPF(NULL),
     m_NCX(NULL),
     m_FSWatcher(new QFileSystemWatcher()),
+    m_RenamingResources(false),
     m_FullPathToMainFolder(m_TempFolder.GetPath())
 {
     CreateFolderStructure();
@@ -200,6 +202,7 @@ Resource &FolderKeeper::AddContentFileToFolder(const QString &fullfilepath, bool
 
     if (update_opf) {
         emit ResourceAdded(*resource);
+        emit ResourcesChanged();
     }
 
     return *resource;
@@ -377,11 +380,81 @@ void FolderKeeper::RemoveResource(const Resource &resource)
 
     m_SuspendedWatchedFiles.removeAll(resource.GetFullPath());
     emit ResourceRemoved(resource);
+    emit ResourcesChanged();
 }
 
 void FolderKeeper::ResourceRenamed(const Resource &resource, const QString &old_full_path)
 {
+    // RenameResources updates the OPF and the watches for all its resources at once
+    if (m_RenamingResources) {
+        return;
+    }
+
     m_OPF->ResourceRenamed(resource, old_full_path);
+    QHash<QString, QString> new_paths;
+    new_paths[ old_full_path ] = resource.GetFullPath();
+    UpdateWatchedPaths(new_paths);
+    emit ResourcesChanged();
+}
+
+QHash<Resource *, QString> FolderKeeper::RenameResources(const QList<Resource *> &resources,
+                                                         const QStringList &new_filenames)
+{
+    Q_ASSERT(resources.count() == new_filenames.count());
+    QHash<Resource *, QString> old_full_paths;
+    QHash<const Resource *, QString> opf_updates;
+    QHash<QString, QString> new_paths;
+    m_RenamingResources = true;
+
+    for (int i = 0; i < resources.count(); ++i) {
+        Resource *resource = resources.at(i);
+        QString old_full_path = resource->GetFullPath();
+
+        if (resource->RenameTo(new_filenames.at(i))) {
+            old_full_paths[ resource ] = old_full_path;
+            opf_updates[ resource ] = old_full_path;
+            new_paths[ old_full_path ] = resource->GetFullPath();
+        }
+    }
+
+    m_RenamingResources = false;
+
+    if (!old_full_paths.isEmpty()) {
+        m_OPF->ResourcesRenamed(opf_updates);
+        UpdateWatchedPaths(new_paths);
+        emit ResourcesChanged();
+    }
+
+    return old_full_paths;
+}
+
+void FolderKeeper::UpdateWatchedPaths(const QHash<QString, QString> &new_paths)
+{
+    QSet<QString> watched = m_FSWatcher->files().toSet();
+    QStringList removed;
+    QStringList added;
+    QHashIterator<QString, QString> it(new_paths);
+
+    while (it.hasNext()) {
+        it.next();
+
+        if (watched.contains(it.key())) {
+            removed.append(it.key());
+            added.append(it.value());
+        }
+
+        // Watching is suspended while saving, so it resumes with the new path
+        int suspended = m_SuspendedWatchedFiles.indexOf(it.key());
+
+        if (suspended != -1) {
+            m_SuspendedWatchedFiles[ suspended ] = it.value();
+        }
+    }
+
+    if (!removed.isEmpty()) {
+        m_FSWatcher->removePaths(removed);
+        m_FSWatcher->addPaths(added);
+    }
 }
 
 void FolderKeeper::ResourceFileChanged(const QString &path) const
@@ -223,6 +223,21 @@ public:
      */
     void WatchResourceFile(const Resource &resource);
 
+    /**
+     * Renames several resources in one go. All the files are renamed
+     * first, then the OPF is updated for all of them in a single pass
+     * and the renamed files are watched under their new paths.
+     * ResourcesChanged is emitted once at the end instead of
+     * once for every resource.
+     *
+     * @param resources The resources to rename.
+     * @param new_filenames The new filename of each resource.
+     * @return The full paths the renamed resources had before the rename.
+     *         Resources that could not be renamed are not included.
+     */
+    QHash<Resource *, QString> RenameResources(const QList<Resource *> &resources,
+                                               const QStringList &new_filenames);
+
     /**
      * Dueing Save operations from Sigil we need to suspend/resume file watching.
      */
@@ -245,6 +260,13 @@ signals:
      */
     void ResourceRemoved(const Resource &resource);
 
+    /**
+     * Emitted after a resource was added, removed or renamed
+     * and the OPF has been updated for it. Carries no arguments
+     * so it can be queued across threads.
+     */
+    void ResourcesChanged();
+
 public slots:
 
     /**
@@ -281,6 +303,13 @@ private:
      */
     void CreateInfrastructureFiles();
 
+    /**
+     * Moves the watches of files that were renamed to their new paths.
+     *
+     * @param new_paths The new full paths keyed by the old full paths.
+     */
+    void UpdateWatchedPaths(const QHash<QString, QString> &new_paths);
+
     /**
      * Dereferences two pointers and compares the values with "<".
      *
@@ -334,6 +363,12 @@ private:
     QFileSystemWatcher *m_FSWatcher;
     QStringList m_SuspendedWatchedFiles;
 
+    /**
+     * \c true while RenameResources is renaming the files,
+     * so the individual renames don't update the OPF.
+     */
+    bool m_RenamingResources;
+
     // Full paths to all the folders in the publication
     QString m_FullPathToMainFolder;
     QString m_FullPathToMetaInfFolder;
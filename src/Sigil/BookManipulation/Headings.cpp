@@ -20,21 +20,16 @@
 *************************************************************************/
 
 #include <boost/bind/bind.hpp>
-#include <boost/tuple/tuple.hpp>
 
 #include <QtCore/QtCore>
+#include <QtCore/QRegularExpression>
 #include <QtCore/QString>
 #include <QtCore/QStringList>
 #include <QtConcurrent/QtConcurrent>
 
 #include "BookManipulation/Headings.h"
-#include "BookManipulation/XercesCppUse.h"
 #include "BookManipulation/XhtmlDoc.h"
-#include "Misc/Utility.h"
 #include "ResourceObjects/HTMLResource.h"
-#include "sigil_constants.h"
-
-using boost::make_tuple;
 
 
 // The maximum allowed distance (in lines) that a heading
@@ -43,11 +38,15 @@ using boost::make_tuple;
 // The value was picked arbitrarily.
 static const int ALLOWED_HEADING_DISTANCE = 20;
 
-const QStringList HEADING_TAGS = QStringList() << "h1" << "h2" << "h3" << "h4" << "h5" << "h6";
-
 const QString SIGIL_NOT_IN_TOC_CLASS = "sigil_not_in_toc";
 const QString OLD_SIGIL_NOT_IN_TOC_CLASS = "sigilNotInTOC";
 
+// Comments and script elements are matched so that anything
+// inside of them is skipped. Quoted attribute values may contain '>'.
+const QString HEADING_TOKENS = "<!--.*?-->|<script[\\s>].*?</script\\s*>|<body[\\s/>]|"
+                               "<(/?)h([1-6])((?:\\s(?:[^>\"']|\"[^\"]*\"|'[^']*')*)?)>";
+const QString ATTRIBUTE = "([^\\s=/>]+)\\s*=\\s*(?:\"([^\"]*)\"|'([^']*)')";
+
 
 // Returns a list of headings from the provided XHTML source;
 // the list is flat, the headings are *not* in a hierarchy tree
@@ -71,50 +70,111 @@ QList<Headings::Heading> Headings::GetHeadingListForOneFile(HTMLResource *html_r
         bool include_unwanted_headings)
 {
     Q_ASSERT(html_resource);
-    // We have to store the shared pointer and then reference it otherwise it will
-    // not a have reference and the DOMDocument will be destroyed.
-    shared_ptr<xc::DOMDocument> d = XhtmlDoc::LoadTextIntoDocument(html_resource->GetText());
-    const xc::DOMDocument &document = *d.get();
-    QList<xc::DOMElement *> dom_elements = XhtmlDoc::GetTagMatchingDescendants(document, "body");
-
-    // We want to ensure we don't try to get an element out of an empty list.
-    // This could happen if there is no body but there should never be an HTMLResource
-    // without a body.
-    if (dom_elements.isEmpty()) {
-        return QList<Headings::Heading>();
+    const int text_version = html_resource->GetTextVersion();
+    QList<Headings::Heading> all_headings;
+
+    if (!html_resource->GetCachedHeadings(text_version, all_headings)) {
+        all_headings = ReadHeadings(html_resource->GetText());
+        html_resource->SetCachedHeadings(text_version, all_headings);
     }
 
-    xc::DOMElement &body_element = *dom_elements.at(0);
-    QList<xc::DOMElement *> heading_nodes = XhtmlDoc::GetTagMatchingDescendants(document, HEADING_TAGS);
-    int num_heading_nodes = heading_nodes.count();
     QList<Headings::Heading> headings;
+    foreach(Heading heading, all_headings) {
+        if (heading.include_in_toc || include_unwanted_headings) {
+            heading.resource_file = html_resource;
+            heading.text_version  = text_version;
+            headings.append(heading);
+        }
+    }
+    return headings;
+}
 
-    for (int i = 0; i < num_heading_nodes; ++i) {
-        xc::DOMElement &element = *heading_nodes.at(i);
-        Q_ASSERT(&element);
-        Heading heading;
-        heading.resource_file  = html_resource;
-        heading.document       = d;
-        heading.element        = &element;
-        heading.title          = element.hasAttribute(QtoX("title"))
-                                 ? XtoQ(element.getAttribute(QtoX("title"))).simplified()
-                                 : QString();
-        heading.orig_title     = heading.title;
-        heading.text           = !heading.title.isNull() ?
-                                 heading.title :
-                                 XtoQ(element.getTextContent()).simplified();
-        heading.level          = QString(XtoQ(element.getTagName()).at(1)).toInt();
-        heading.orig_level     = heading.level;
-        QString classes        = XtoQ(element.getAttribute(QtoX("class")));
-        heading.include_in_toc = !(classes.contains(SIGIL_NOT_IN_TOC_CLASS) ||
-                                   classes.contains(OLD_SIGIL_NOT_IN_TOC_CLASS));
-        heading.at_file_start  =
-            i == 0 &&
-            XhtmlDoc::NodeLineNumber(element) -
-            XhtmlDoc::NodeLineNumber(body_element) < ALLOWED_HEADING_DISTANCE;
-        heading.is_changed     = false;
 
-        if (heading.include_in_toc || include_unwanted_headings) {
+QList<Headings::Heading> Headings::ReadHeadings(const QString &source)
+{
+    QList<Headings::Heading> headings;
+    QRegularExpression heading_tokens(HEADING_TOKENS,
+                                      QRegularExpression::DotMatchesEverythingOption |
+                                      QRegularExpression::CaseInsensitiveOption);
+    QRegularExpression attribute_search(ATTRIBUTE);
+    QRegularExpressionMatchIterator tokens = heading_tokens.globalMatch(source);
+    int body_offset = -1;
+    bool in_heading = false;
+    Heading heading;
+
+    while (tokens.hasNext()) {
+        QRegularExpressionMatch token = tokens.next();
+
+        if (token.capturedRef(2).isEmpty()) {
+            if (body_offset == -1 && token.capturedRef().startsWith("<body", Qt::CaseInsensitive)) {
+                body_offset = token.capturedStart();
+            }
+
+            continue;
+        }
+
+        // There should never be an HTMLResource without a body,
+        // and there are no headings outside of it.
+        if (body_offset == -1) {
+            continue;
+        }
+
+        int level = token.capturedRef(2).toInt();
+
+        if (token.capturedRef(1).isEmpty()) {
+            // Headings can't be nested, so we only look at the outermost one.
+            if (in_heading) {
+                continue;
+            }
+
+            in_heading = true;
+            heading = Heading();
+            heading.resource_file    = NULL;
+            heading.text_version     = 0;
+            heading.start_tag_offset = token.capturedStart();
+            heading.start_tag_length = token.capturedLength();
+            heading.level            = level;
+            heading.orig_level       = level;
+            QRegularExpressionMatchIterator attributes = attribute_search.globalMatch(token.capturedRef(3).toString());
+
+            while (attributes.hasNext()) {
+                QRegularExpressionMatch attribute = attributes.next();
+                QString value = attribute.captured(2) + attribute.captured(3);
+
+                // ResolveHTMLEntities needs a QWebPage, which can't be used on worker threads
+                if (value.contains('&')) {
+                    value = XhtmlDoc::GetVisibleTextInHtml(value);
+                }
+
+                if (attribute.capturedRef(1) == "title") {
+                    // An empty title still replaces the heading's text
+                    heading.title = value.isNull() ? QString("") : value.simplified();
+                } else if (attribute.capturedRef(1) == "id") {
+                    heading.id = value;
+                } else if (attribute.capturedRef(1) == "class") {
+                    heading.classes = value;
+                }
+            }
+        } else if (in_heading && level == heading.level) {
+            in_heading = false;
+            heading.end_tag_offset = token.capturedStart();
+            heading.end_tag_length = token.capturedLength();
+            heading.element_source = source.mid(heading.start_tag_offset,
+                                                heading.end_tag_offset + heading.end_tag_length - heading.start_tag_offset);
+            heading.orig_title     = heading.title;
+            heading.orig_id        = heading.id;
+            heading.orig_classes   = heading.classes;
+            heading.text           = !heading.title.isNull() ?
+                                     heading.title :
+                                     XhtmlDoc::GetVisibleTextInHtml(
+                                         source.mid(heading.start_tag_offset + heading.start_tag_length,
+                                                    heading.end_tag_offset - heading.start_tag_offset - heading.start_tag_length)).simplified();
+            heading.include_in_toc = !(heading.classes.contains(SIGIL_NOT_IN_TOC_CLASS) ||
+                                       heading.classes.contains(OLD_SIGIL_NOT_IN_TOC_CLASS));
+            heading.at_file_start  =
+                headings.isEmpty() &&
+                source.midRef(body_offset, heading.start_tag_offset - body_offset).count('\n') < ALLOWED_HEADING_DISTANCE;
+            heading.is_changed     = false;
             headings.append(heading);
         }
     }
@@ -123,6 +183,92 @@ QList<Headings::Heading> Headings::GetHeadingListForOneFile(HTMLResource *html_r
 }
 
 
+static bool StartTagOffsetGreaterThan(const Headings::Heading &first, const Headings::Heading &second)
+{
+    return first.start_tag_offset > second.start_tag_offset;
+}
+
+
+QString Headings::GetSourceWithHeadingChanges(const QString &source, QList<Heading> headings, bool *ok)
+{
+    if (ok) {
+        *ok = true;
+    }
+
+    QString new_source = source;
+    // Work from the end of the file so the offsets
+    // of the headings before are still valid.
+    qSort(headings.begin(), headings.end(), StartTagOffsetGreaterThan);
+    foreach(Heading heading, headings) {
+        if (!heading.is_changed) {
+            continue;
+        }
+
+        QString orig_tag_name = "h" + QString::number(heading.orig_level);
+        QString new_tag_name = "h" + QString::number(heading.level);
+
+        // Refuse to touch a source the heading was not read from.
+        // Tag names were matched case insensitively when reading.
+        if (new_source.midRef(heading.start_tag_offset + 1, 2).compare(orig_tag_name, Qt::CaseInsensitive) != 0 ||
+            new_source.midRef(heading.end_tag_offset + 2, 2).compare(orig_tag_name, Qt::CaseInsensitive) != 0) {
+            if (ok) {
+                *ok = false;
+            }
+
+            return source;
+        }
+
+        if (heading.level != heading.orig_level) {
+            new_source.replace(heading.end_tag_offset, heading.end_tag_length, "</" % new_tag_name % ">");
+        }
+
+        QString start_tag = new_source.mid(heading.start_tag_offset, heading.start_tag_length);
+        start_tag.replace(1, 2, new_tag_name);
+
+        if (heading.classes != heading.orig_classes) {
+            start_tag = SetStartTagAttribute(start_tag, "class", heading.classes, true);
+        }
+
+        if (heading.id != heading.orig_id) {
+            start_tag = SetStartTagAttribute(start_tag, "id", heading.id, true);
+        }
+
+        if (heading.title != heading.orig_title) {
+            start_tag = SetStartTagAttribute(start_tag, "title", heading.title, false);
+        }
+
+        new_source.replace(heading.start_tag_offset, heading.start_tag_length, start_tag);
+    }
+    return new_source;
+}
+
+
+QString Headings::SetStartTagAttribute(const QString &start_tag,
+                                       const QString &name,
+                                       const QString &value,
+                                       bool remove_if_empty)
+{
+    QRegularExpression attribute_search("\\s" % QRegularExpression::escape(name) %
+                                        "\\s*=\\s*(?:\"[^\"]*\"|'[^']*')");
+    QRegularExpressionMatch match = attribute_search.match(start_tag);
+    QString attribute;
+
+    if (!value.isEmpty() || !remove_if_empty) {
+        attribute = " " % name % "=\"" % value.toHtmlEscaped() % "\"";
+    }
+
+    QString new_start_tag = start_tag;
+
+    if (match.hasMatch()) {
+        new_start_tag.replace(match.capturedStart(), match.capturedLength(), attribute);
+    } else {
+        new_start_tag.insert(new_start_tag.length() - 1, attribute);
+    }
+
+    return new_start_tag;
+}
+
+
 // Takes a flat list of headings and returns a list with those
 // headings sorted into a hierarchy
 QList<Headings::Heading> Headings::MakeHeadingHeirarchy(const QList<Heading> &headings)
@@ -23,17 +23,11 @@
 #ifndef HEADINGS_H
 #define HEADINGS_H
 
-#include <boost/shared_ptr.hpp>
-
 #include <QtCore/QList>
 #include <QtCore/QMetaType>
-
-#include "BookManipulation/XercesHUse.h"
-
-using boost::shared_ptr;
+#include <QtCore/QString>
 
 class HTMLResource;
-class QString;
 
 class Headings
 {
@@ -46,10 +40,19 @@ public:
         // The HTMLResource file the heading belongs to
         HTMLResource *resource_file;
 
-        shared_ptr<xc::DOMDocument> document;
+        // The text version of the file the offsets below refer to
+        int text_version;
+
+        // The position of the heading's start tag in the file's source
+        int start_tag_offset;
+        int start_tag_length;
+
+        // The position of the heading's end tag in the file's source
+        int end_tag_offset;
+        int end_tag_length;
 
-        // The DomElement of the heading in the file's DomDocument
-        xc::DOMElement *element;
+        // The source of the whole heading element
+        QString element_source;
 
         // Represents what the heading should
         // look like in the TOC.
@@ -59,6 +62,14 @@ public:
         QString title;
         QString orig_title;
 
+        // Represents the current id attribute if any
+        QString id;
+        QString orig_id;
+
+        // Represents the current class attribute if any
+        QString classes;
+        QString orig_classes;
+
         // The level of the heading, from 1 to 6
         // (lower number means 'bigger' heading )
         int level;
@@ -96,9 +107,19 @@ public:
     static QList<Heading> GetHeadingList(QList<HTMLResource *> html_resources,
                                          bool include_unwanted_headings = false);
 
+    // The headings of a file are found by scanning its source rather than
+    // by parsing it into a DOM, and are cached until the file's text changes.
     static QList<Heading> GetHeadingListForOneFile(HTMLResource *html_resource,
             bool include_unwanted_headings = false);
 
+    // Returns the source with the changes made to the provided headings
+    // applied. Only the start and end tags of the changed headings are
+    // rewritten; the rest of the source is left untouched. The headings
+    // must have been read from this source; if a heading's tags are not
+    // where it says they are, the source is returned unchanged and ok,
+    // if provided, is set to false.
+    static QString GetSourceWithHeadingChanges(const QString &source, QList<Heading> headings, bool *ok = NULL);
+
     // Takes a flat list of headings and returns a list with those
     // headings sorted into a hierarchy
     static QList<Heading> MakeHeadingHeirarchy(const QList<Heading> &headings);
@@ -107,6 +128,16 @@ public:
     static QList<Heading> GetFlattenedHeadings(const QList<Heading> &headings);
 
 private:
+    // Scans the source for heading elements; unwanted headings are included
+    static QList<Heading> ReadHeadings(const QString &source);
+
+    // Sets the attribute in the provided start tag, adding it if needed;
+    // an empty value removes the attribute when remove_if_empty is true
+    static QString SetStartTagAttribute(const QString &start_tag,
+                                        const QString &name,
+                                        const QString &value,
+                                        bool remove_if_empty);
+
     // Flattens the provided heading node and its children
     // into a list and returns it
     static QList<Heading> FlattenHeadingNode(Heading heading);
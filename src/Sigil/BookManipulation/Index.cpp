@@ -20,6 +20,7 @@
 **
 *************************************************************************/
 
+#include <boost/bind/bind.hpp>
 #include <boost/shared_ptr.hpp>
 
 #include <QtCore/QtCore>
@@ -41,6 +42,10 @@ using boost::shared_ptr;
 
 const QString SIGIL_INDEX_CLASS = "sigil_index_marker";
 const QString SIGIL_INDEX_ID_PREFIX = "sigil_index_id_";
+// Characters that give a pattern a meaning other than its literal text
+const QString INDEX_PATTERN_SPECIAL_CHARS = "\\^$.|?*+()[]{}";
+// Quantifiers that make the character before them optional
+const QString INDEX_PATTERN_OPTIONAL_CHARS = "?*{";
 
 bool Index::BuildIndex(QList<HTMLResource *> html_resources)
 {
@@ -48,27 +53,114 @@ bool Index::BuildIndex(QList<HTMLResource *> html_resources)
     // Display progress dialog
     QProgressDialog progress(QObject::tr("Creating Index..."), QObject::tr("Cancel"), 0, html_resources.count(), QApplication::activeWindow());
     progress.setMinimumDuration(0);
-    int progress_value = 0;
-    progress.setValue(progress_value);
-    qApp->processEvents();
-    // Must do sequentially in order to keep sections in order
-    foreach(HTMLResource * html_resource, html_resources) {
-        // Set progress value and ensure dialog has time to display when doing extensive updates
-        if (progress.wasCanceled()) {
-            return false;
+    progress.setValue(0);
+    // Every pattern is compiled once for the whole book
+    // instead of once per id node.
+    const QList<IndexMatcher> matchers = CompileMatchers();
+    // Index the files on worker threads while the progress dialog
+    // stays responsive here.
+    QFutureWatcher<FileResult> watcher;
+    QEventLoop loop;
+    QObject::connect(&watcher, SIGNAL(progressValueChanged(int)), &progress, SLOT(setValue(int)));
+    QObject::connect(&progress, SIGNAL(canceled()), &watcher, SLOT(cancel()));
+    QObject::connect(&watcher, SIGNAL(finished()), &loop, SLOT(quit()));
+    watcher.setFuture(QtConcurrent::mapped(html_resources, boost::bind(AddIndexIDsOneFile, _1, boost::cref(matchers))));
+    loop.exec();
+
+    // A cancelled run leaves every file untouched.
+    if (watcher.isCanceled()) {
+        return false;
+    }
+
+    // Entries are added in file order to keep sections in order
+    for (int i = 0; i < html_resources.count(); ++i) {
+        HTMLResource *html_resource = html_resources.at(i);
+        FileResult result = watcher.resultAt(i);
+
+        if (!result.new_text.isEmpty()) {
+            QWriteLocker locker(&html_resource->GetLock());
+            html_resource->SetText(result.new_text);
         }
 
-        progress.setValue(progress_value++);
-        qApp->processEvents();
-        AddIndexIDsOneFile(html_resource);
+        QString filename = html_resource->Filename();
+        foreach(IndexEntry entry, result.entries) {
+            IndexEntries::instance()->AddOneEntry(entry.text, filename, entry.index_id_value);
+        }
     }
+
     return true;
 }
 
-void Index::AddIndexIDsOneFile(HTMLResource *html_resource)
+QList<Index::IndexMatcher> Index::CompileMatchers()
+{
+    QList<IndexMatcher> matchers;
+    QList<IndexEditorModel::indexEntry *> entries = IndexEditorModel::instance()->GetEntries();
+    foreach(IndexEditorModel::indexEntry * entry, entries) {
+        if (!entry->pattern.isEmpty()) {
+            matchers.append(CompileMatcher(entry->pattern, entry->index_entry));
+        }
+    }
+    qDeleteAll(entries);
+    return matchers;
+}
+
+Index::IndexMatcher Index::CompileMatcher(const QString &pattern, const QString &index_entry)
+{
+    IndexMatcher matcher;
+    matcher.regex = QRegularExpression(pattern);
+#if QT_VERSION >= QT_VERSION_CHECK(5, 4, 0)
+    // JIT compile now rather than after the first few matches
+    matcher.regex.optimize();
+#endif
+    int special = 0;
+
+    while (special < pattern.length() && !INDEX_PATTERN_SPECIAL_CHARS.contains(pattern.at(special))) {
+        special++;
+    }
+
+    matcher.literal_only = special == pattern.length();
+
+    if (matcher.literal_only) {
+        matcher.required_literal = pattern;
+    } else if (!pattern.contains("|")) {
+        // The text before the first special character has to be in every match
+        // unless a quantifier right after it makes its last character optional.
+        matcher.required_literal = pattern.left(special);
+
+        if (INDEX_PATTERN_OPTIONAL_CHARS.contains(pattern.at(special))) {
+            matcher.required_literal.chop(1);
+        }
+    }
+
+    if (index_entry.isEmpty()) {
+        // If no index text, use the pattern
+        matcher.index_entry = pattern;
+    } else if (index_entry.endsWith("/")) {
+        // If index text is a category then append the pattern
+        matcher.index_entry = index_entry + pattern;
+    } else {
+        // Use the given index text
+        matcher.index_entry = index_entry;
+    }
+
+    return matcher;
+}
+
+bool Index::Matches(const IndexMatcher &matcher, const QString &text)
+{
+    if (!matcher.required_literal.isEmpty() && !text.contains(matcher.required_literal)) {
+        return false;
+    }
+
+    return matcher.literal_only || text.contains(matcher.regex);
+}
+
+Index::FileResult Index::AddIndexIDsOneFile(HTMLResource *html_resource, const QList<IndexMatcher> &matchers)
 {
-    QWriteLocker locker(&html_resource->GetLock());
+    FileResult result;
+    QReadLocker locker(&html_resource->GetLock());
     shared_ptr<xc::DOMDocument> d = XhtmlDoc::LoadTextIntoDocument(html_resource->GetText());
+    locker.unlock();
     QList<xc::DOMNode *> nodes = XhtmlDoc::GetIDNodes(*d.get());
     bool resource_updated = false;
     int index_id_number = 1;
@@ -113,11 +205,11 @@ void Index::AddIndexIDsOneFile(HTMLResource *html_resource)
 
         // Use the existing id if there is one, else add one if node contains index item
         if (element.hasAttribute(QtoX("id"))) {
-            CreateIndexEntry(text_node_text, html_resource, index_id_value, is_custom_index_entry, custom_index_value);
+            CreateIndexEntry(text_node_text, matchers, index_id_value, is_custom_index_entry, custom_index_value, result.entries);
         } else {
             index_id_value = SIGIL_INDEX_ID_PREFIX + QString::number(index_id_number);
 
-            if (CreateIndexEntry(text_node_text, html_resource, index_id_value, is_custom_index_entry, custom_index_value)) {
+            if (CreateIndexEntry(text_node_text, matchers, index_id_value, is_custom_index_entry, custom_index_value, result.entries)) {
                 element.setAttribute(QtoX("id"), QtoX(index_id_value));
                 resource_updated = true;
                 index_id_number++;
@@ -126,45 +218,28 @@ void Index::AddIndexIDsOneFile(HTMLResource *html_resource)
     }
 
     if (resource_updated) {
-        html_resource->SetText(XhtmlDoc::GetDomDocumentAsString(*d.get()));
+        result.new_text = XhtmlDoc::GetDomDocumentAsString(*d.get());
     }
+
+    return result;
 }
 
-bool Index::CreateIndexEntry(const QString text, HTMLResource *html_resource, QString index_id_value, bool is_custom_index_entry, QString custom_index_value)
+bool Index::CreateIndexEntry(const QString &text, const QList<IndexMatcher> &matchers, const QString &index_id_value, bool is_custom_index_entry, const QString &custom_index_value, QList<IndexEntry> &entries)
 {
     bool created_index = false;
-    QList<IndexEditorModel::indexEntry *> entries;
+    QList<IndexMatcher> custom_matchers;
 
-    if (is_custom_index_entry) {
-        IndexEditorModel::indexEntry *custom_entry = new IndexEditorModel::indexEntry();
-        custom_entry->pattern = text;
-        custom_entry->index_entry = custom_index_value;
-        entries.append(custom_entry);
-    } else {
-        entries = IndexEditorModel::instance()->GetEntries();
+    if (is_custom_index_entry && !text.isEmpty()) {
+        custom_matchers.append(CompileMatcher(text, custom_index_value));
     }
 
-    foreach(IndexEditorModel::indexEntry * entry, entries) {
-        QString index_pattern = entry->pattern;
-        if (index_pattern.isEmpty()) {
-            continue;
-        }
-
-        QRegularExpression index_regex(index_pattern);
-
-        if (text.contains(index_regex)) {
+    foreach(const IndexMatcher & matcher, is_custom_index_entry ? custom_matchers : matchers) {
+        if (Matches(matcher, text)) {
             created_index = true;
-            QString index_entry = entry->index_entry;
-            if (index_entry.isEmpty()) {
-                // If no index text, use the pattern
-                IndexEntries::instance()->AddOneEntry(index_pattern, html_resource->Filename(), index_id_value);
-            } else if (entry->index_entry.endsWith("/")) {
-                // If index text is a category then append the pattern
-                IndexEntries::instance()->AddOneEntry(index_entry + index_pattern, html_resource->Filename(), index_id_value);
-            } else {
-                // Use the given index text
-                IndexEntries::instance()->AddOneEntry(index_entry, html_resource->Filename(), index_id_value);
-            }
+            IndexEntry entry;
+            entry.text = matcher.index_entry;
+            entry.index_id_value = index_id_value;
+            entries.append(entry);
         }
     }
     return created_index;
@@ -24,6 +24,10 @@
 #ifndef INDEX_H
 #define INDEX_H
 
+#include <QtCore/QList>
+#include <QtCore/QRegularExpression>
+#include <QtCore/QString>
+
 class HTMLResource;
 
 /**
@@ -37,10 +41,43 @@ class Index
 public:
     static bool BuildIndex(QList<HTMLResource *> html_resources);
 
+    /**
+     * An Index dialog pattern compiled once for the whole book.
+     */
+    struct IndexMatcher {
+        QRegularExpression regex;
+        // Text the pattern can only match if it contains
+        QString required_literal;
+        // The pattern has no special characters so the literal test is the match
+        bool literal_only;
+        // The entry added to the index when the pattern matches
+        QString index_entry;
+    };
+
+    struct IndexEntry {
+        QString text;
+        QString index_id_value;
+    };
+
+    /**
+     * What indexing one file produced, applied once every file is done.
+     */
+    struct FileResult {
+        // Empty if the file does not need to change
+        QString new_text;
+        QList<IndexEntry> entries;
+    };
+
 private:
-    static void AddIndexIDsOneFile(HTMLResource *html_resource);
+    static QList<IndexMatcher> CompileMatchers();
+
+    static IndexMatcher CompileMatcher(const QString &pattern, const QString &index_entry);
+
+    static FileResult AddIndexIDsOneFile(HTMLResource *html_resource, const QList<IndexMatcher> &matchers);
+
+    static bool CreateIndexEntry(const QString &text, const QList<IndexMatcher> &matchers, const QString &index_id_value, bool is_custom_index_entry, const QString &custom_index_value, QList<IndexEntry> &entries);
 
-    static bool CreateIndexEntry(const QString text, HTMLResource *html_resource, QString index_id_name, bool is_custom_index_entry, QString custom_index_name);
+    static bool Matches(const IndexMatcher &matcher, const QString &text);
 };
 
 #endif // INDEX_H
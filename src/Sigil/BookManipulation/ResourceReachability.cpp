@@ -0,0 +1,310 @@
+/************************************************************************
+**
+**  Copyright (C) 2015  Sigil Developers
+**
+**  This file is part of Sigil.
+**
+**  Sigil is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  Sigil is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with Sigil.  If not, see <http://www.gnu.org/licenses/>.
+**
+*************************************************************************/
+
+#include <QtCore/QDir>
+#include <QtCore/QFileInfo>
+#include <QtCore/QHash>
+#include <QtCore/QRegularExpression>
+#include <QtCore/QSet>
+#include <QtCore/QStringBuilder>
+#include <QtConcurrent/QtConcurrent>
+
+#include "BookManipulation/Book.h"
+#include "BookManipulation/FolderKeeper.h"
+#include "BookManipulation/ResourceReachability.h"
+#include "Misc/CSSInfo.h"
+#include "Misc/Utility.h"
+#include "ResourceObjects/CSSResource.h"
+#include "ResourceObjects/OPFResource.h"
+#include "ResourceObjects/TextResource.h"
+
+using boost::make_tuple;
+using boost::tie;
+using boost::tuple;
+
+// Attributes that can point to another file
+const QString REFERENCE_ATTRIBUTES = "\\s(?:src|href|xlink:href|poster|data|altimg)\\s*=\\s*(?:\"([^\"]*)\"|'([^']*)')";
+// References in stylesheets, style elements and style attributes
+const QString STYLE_REFERENCES = "url\\s*\\(\\s*(?:\"([^\"]*)\"|'([^']*)'|([^)\\s]*))\\s*\\)|@import\\s+(?:\"([^\"]*)\"|'([^']*)')";
+
+
+ResourceReachability::UnusedResources ResourceReachability::FindUnusedResources(QSharedPointer<Book> book, bool find_unused_selectors)
+{
+    FolderKeeper &folder_keeper = book->GetFolderKeeper();
+    QList<Resource *> resources = folder_keeper.GetResourceList();
+    QHash<QString, Resource *> resources_by_path;
+    QList<Resource *> text_resources;
+    QStringList roots;
+    foreach(Resource * resource, resources) {
+        QString path = QDir::cleanPath(resource->GetFullPath());
+        resources_by_path[ path ] = resource;
+        Resource::ResourceType type = resource->Type();
+
+        if (type == Resource::OPFResourceType) {
+            continue;
+        }
+
+        if (qobject_cast<TextResource *>(resource)) {
+            text_resources.append(resource);
+        }
+
+        if (type == Resource::HTMLResourceType ||
+            type == Resource::NCXResourceType ||
+            type == Resource::MiscTextResourceType) {
+            roots.append(path);
+        }
+    }
+    // The guide and the cover image
+    QString opf_folder = QFileInfo(book->GetOPF().GetFullPath()).absolutePath();
+    foreach(QString href, book->GetOPF().GetGuideSemanticNameForPaths().keys()) {
+        QString path = ResolveReference(opf_folder, href);
+
+        if (!path.isEmpty()) {
+            roots.append(path);
+        }
+    }
+    // Build the edges of the graph
+    QHash<QString, QStringList> references;
+    QFuture<tuple<QString, QStringList>> reference_future = QtConcurrent::mapped(text_resources, GetReferencesMapped);
+    QFuture<tuple<QString, QSharedPointer<CSSInfo>>> css_future;
+
+    if (find_unused_selectors) {
+        QList<CSSResource *> css_resources = folder_keeper.GetResourceTypeList<CSSResource>(true);
+        css_future = QtConcurrent::mapped(css_resources, GetStylesheetMapped);
+    }
+
+    for (int i = 0; i < reference_future.results().count(); i++) {
+        QString path;
+        QStringList paths;
+        tie(path, paths) = reference_future.resultAt(i);
+        references[ path ] = paths;
+    }
+
+    // Mark
+    QSet<QString> reachable;
+    QStringList to_visit = roots;
+
+    while (!to_visit.isEmpty()) {
+        QString path = to_visit.takeLast();
+
+        if (reachable.contains(path) || !resources_by_path.contains(path)) {
+            continue;
+        }
+
+        reachable.insert(path);
+        to_visit.append(references.value(path));
+    }
+
+    // Sweep
+    UnusedResources unused;
+    foreach(Resource * resource, folder_keeper.GetResourceTypeList<Resource>(true)) {
+        if (reachable.contains(QDir::cleanPath(resource->GetFullPath()))) {
+            continue;
+        }
+
+        Resource::ResourceType type = resource->Type();
+
+        if (type == Resource::ImageResourceType ||
+            type == Resource::SVGResourceType ||
+            type == Resource::VideoResourceType ||
+            type == Resource::AudioResourceType) {
+            unused.media.append(resource);
+        } else if (type == Resource::FontResourceType) {
+            unused.fonts.append(resource);
+        } else if (type == Resource::CSSResourceType) {
+            unused.stylesheets.append(resource);
+        }
+    }
+
+    if (!find_unused_selectors) {
+        return unused;
+    }
+
+    // Index the class selectors of each stylesheet by class name
+    QHash<QString, QHash<QString, QList<CSSInfo::CSSSelector *>>> class_selectors;
+    QList<QString> css_paths;
+    QList<QList<CSSInfo::CSSSelector *>> css_selectors;
+
+    for (int i = 0; i < css_future.results().count(); i++) {
+        QString path;
+        QSharedPointer<CSSInfo> css_info;
+        tie(path, css_info) = css_future.resultAt(i);
+        QList<CSSInfo::CSSSelector *> selectors = css_info->getClassSelectors();
+        QHash<QString, QList<CSSInfo::CSSSelector *>> &by_class = class_selectors[ path ];
+        foreach(CSSInfo::CSSSelector * selector, selectors) {
+            foreach(QString class_name, selector->classNames) {
+                // A selector can name the same class twice
+                if (by_class[ class_name ].isEmpty() || by_class[ class_name ].last() != selector) {
+                    by_class[ class_name ].append(selector);
+                }
+            }
+        }
+        css_paths.append(path);
+        css_selectors.append(selectors);
+    }
+
+    // Mark the selectors used by the classes in each HTML file. The first
+    // linked stylesheet with a matching selector wins, and within a
+    // stylesheet the first selector for the class that either has no
+    // element or names the element. The matches are remembered per
+    // stylesheet, since the same classes are used over and over.
+    QSet<CSSInfo::CSSSelector *> used_selectors;
+    QHash<QString, QHash<QString, CSSInfo::CSSSelector *>> matches;
+    QHash<QString, BookReports::HTMLFileData> html_file_data = BookReports::GetHTMLFileData(book);
+    foreach(HTMLResource * html_resource, folder_keeper.GetResourceTypeList<HTMLResource>(false)) {
+        const BookReports::HTMLFileData &data = html_file_data[ html_resource->Filename() ];
+        QString html_folder = QFileInfo(html_resource->GetFullPath()).absolutePath();
+        QStringList linked_stylesheets;
+        foreach(QString stylesheet, data.stylesheets) {
+            QString path = ResolveReference(html_folder, stylesheet);
+
+            if (class_selectors.contains(path)) {
+                linked_stylesheets.append(path);
+            }
+        }
+        QSet<QString> classes_in_file = data.classes.toSet();
+        foreach(QString element_class, classes_in_file) {
+            QString element_name = element_class.split(".").at(0);
+            QString class_name = element_class.split(".").at(1);
+            foreach(QString css_path, linked_stylesheets) {
+                QHash<QString, CSSInfo::CSSSelector *> &css_matches = matches[ css_path ];
+                CSSInfo::CSSSelector *match = NULL;
+
+                if (css_matches.contains(element_class)) {
+                    match = css_matches.value(element_class);
+                } else {
+                    foreach(CSSInfo::CSSSelector * selector, class_selectors[ css_path ].value(class_name)) {
+                        // Always match on wildcard class selector
+                        if (selector->elementNames.isEmpty()) {
+                            match = selector;
+                            break;
+                        }
+
+                        // Doublecheck that the full element.class is actually in the text
+                        // to avoid, e.g.,  div class="test" matching p.test + div
+                        if (selector->elementNames.contains(element_name) &&
+                            selector->groupText.contains(element_name % "." % class_name)) {
+                            match = selector;
+                            break;
+                        }
+                    }
+                    css_matches.insert(element_class, match);
+                }
+
+                if (match) {
+                    used_selectors.insert(match);
+                    break;
+                }
+            }
+        }
+    }
+
+    for (int i = 0; i < css_paths.count(); i++) {
+        Resource *css_resource = resources_by_path.value(css_paths.at(i));
+        QString css_filename = "../" + css_resource->GetRelativePathToOEBPS();
+        foreach(CSSInfo::CSSSelector * selector, css_selectors.at(i)) {
+            if (used_selectors.contains(selector)) {
+                continue;
+            }
+
+            BookReports::StyleData *selector_usage = new BookReports::StyleData();
+            selector_usage->css_filename = css_filename;
+            selector_usage->css_selector_text = selector->groupText;
+            selector_usage->css_selector_position = selector->position;
+            selector_usage->css_selector_line = selector->line;
+            unused.selectors.append(selector_usage);
+        }
+    }
+
+    return unused;
+}
+
+
+tuple<QString, QStringList> ResourceReachability::GetReferencesMapped(Resource *resource)
+{
+    TextResource *text_resource = qobject_cast<TextResource *>(resource);
+    QString text;
+    {
+        QReadLocker locker(&resource->GetLock());
+        text = text_resource->GetText();
+    }
+    QString folder = QFileInfo(resource->GetFullPath()).absolutePath();
+    QStringList patterns;
+
+    if (resource->Type() != Resource::CSSResourceType) {
+        patterns.append(REFERENCE_ATTRIBUTES);
+    }
+
+    patterns.append(STYLE_REFERENCES);
+    QStringList references;
+    foreach(QString pattern, patterns) {
+        QRegularExpressionMatchIterator matches = QRegularExpression(pattern).globalMatch(text);
+
+        while (matches.hasNext()) {
+            QRegularExpressionMatch match = matches.next();
+
+            // Only one of the alternatives matched
+            for (int i = 1; i <= match.lastCapturedIndex(); i++) {
+                if (!match.capturedRef(i).isEmpty()) {
+                    QString path = ResolveReference(folder, match.captured(i));
+
+                    if (!path.isEmpty()) {
+                        references.append(path);
+                    }
+
+                    break;
+                }
+            }
+        }
+    }
+    references.removeDuplicates();
+    return make_tuple(QDir::cleanPath(resource->GetFullPath()), references);
+}
+
+
+tuple<QString, QSharedPointer<CSSInfo>> ResourceReachability::GetStylesheetMapped(CSSResource *css_resource)
+{
+    QString text;
+    {
+        QReadLocker locker(&css_resource->GetLock());
+        text = css_resource->GetText();
+    }
+    return make_tuple(QDir::cleanPath(css_resource->GetFullPath()),
+                      QSharedPointer<CSSInfo>(new CSSInfo(text, true)));
+}
+
+
+QString ResourceReachability::ResolveReference(const QString &folder, const QString &reference)
+{
+    QString path = reference.trimmed();
+    int end = path.indexOf(QRegularExpression("[#?]"));
+
+    if (end != -1) {
+        path.truncate(end);
+    }
+
+    // Remote files, data: urls and the like
+    if (path.isEmpty() || path.contains(':')) {
+        return QString();
+    }
+
+    return QDir::cleanPath(folder + "/" + Utility::URLDecodePath(path));
+}
@@ -0,0 +1,94 @@
+/************************************************************************
+**
+**  Copyright (C) 2015  Sigil Developers
+**
+**  This file is part of Sigil.
+**
+**  Sigil is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  Sigil is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with Sigil.  If not, see <http://www.gnu.org/licenses/>.
+**
+*************************************************************************/
+
+#pragma once
+#ifndef RESOURCEREACHABILITY_H
+#define RESOURCEREACHABILITY_H
+
+#include <boost/tuple/tuple.hpp>
+
+#include <QtCore/QList>
+#include <QtCore/QSharedPointer>
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+
+#include "BookManipulation/BookReports.h"
+
+class Book;
+class CSSInfo;
+class CSSResource;
+class Resource;
+
+/**
+ * Finds the files and styles of a book that nothing uses.
+ *
+ * The book is treated as a graph: every text file is scanned once
+ * (in parallel) for the files it references through attributes,
+ * url() and @import. Starting from the roots - the HTML files, the
+ * NCX, the other text files and everything in the guide including
+ * the cover image - everything that can be reached is marked.
+ * Whatever is left unmarked is unused.
+ *
+ * Class selectors are marked the same way, by matching the classes
+ * used in each HTML file against the stylesheets that file links to.
+ */
+class ResourceReachability
+{
+
+public:
+    struct UnusedResources {
+        // Images (including SVG), video and audio
+        QList<Resource *> media;
+        QList<Resource *> fonts;
+        QList<Resource *> stylesheets;
+
+        // Class selectors that no HTML element matches.
+        // The caller owns these.
+        QList<BookReports::StyleData *> selectors;
+    };
+
+    /**
+     * Finds the unused files and class selectors of the book.
+     *
+     * @param book The book to search.
+     * @param find_unused_selectors Set to \c false when only the unused
+     *        files are needed. This skips parsing the stylesheets and the
+     *        HTML files for their classes, and selectors is left empty.
+     */
+    static UnusedResources FindUnusedResources(QSharedPointer<Book> book, bool find_unused_selectors = true);
+
+private:
+    /**
+     * Returns the full path of the resource and the
+     * full paths of all the files it references.
+     */
+    static boost::tuple<QString, QStringList> GetReferencesMapped(Resource *resource);
+
+    static boost::tuple<QString, QSharedPointer<CSSInfo>> GetStylesheetMapped(CSSResource *css_resource);
+
+    /**
+     * Turns a reference found in a file in folder into a full path.
+     * Returns an empty string for references outside of the book.
+     */
+    static QString ResolveReference(const QString &folder, const QString &reference);
+};
+
+#endif // RESOURCEREACHABILITY_H
@@ -0,0 +1,155 @@
+/************************************************************************
+**
+**  Copyright (C) 2015  Sigil Developers
+**
+**  This file is part of Sigil.
+**
+**  Sigil is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  Sigil is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with Sigil.  If not, see <http://www.gnu.org/licenses/>.
+**
+*************************************************************************/
+
+#include <QtCore/QReadLocker>
+#include <QtConcurrent/QtConcurrent>
+
+#include "BookManipulation/WordIndex.h"
+#include "Misc/HTMLSpellCheck.h"
+#include "Misc/SpellCheck.h"
+#include "ResourceObjects/HTMLResource.h"
+
+void WordIndex::Update(const QList<HTMLResource *> &html_resources)
+{
+    // The word characters of the dictionary change where words are split
+    QString word_chars = SpellCheck::instance()->getWordChars();
+
+    if (word_chars != m_WordChars) {
+        Clear();
+        m_WordChars = word_chars;
+    }
+
+    QSet<QString> current_identifiers;
+    QList<HTMLResource *> stale_resources;
+    foreach(HTMLResource * html_resource, html_resources) {
+        const QString &identifier = html_resource->GetIdentifier();
+        current_identifiers.insert(identifier);
+
+        if (!m_Files.contains(identifier) ||
+            m_Files.value(identifier).text_version != html_resource->GetTextVersion()) {
+            stale_resources.append(html_resource);
+        }
+    }
+
+    foreach(QString identifier, m_Files.keys()) {
+        if (!current_identifiers.contains(identifier)) {
+            RemoveFile(identifier);
+        }
+    }
+
+    if (stale_resources.isEmpty()) {
+        return;
+    }
+
+    QList<FileWords> indexed = QtConcurrent::blockingMapped(stale_resources, IndexFile);
+    foreach(FileWords file_words, indexed) {
+        const QString &identifier = file_words.resource->GetIdentifier();
+        RemoveFile(identifier);
+        AddFile(identifier, file_words);
+    }
+}
+
+
+QHash<QString, int> WordIndex::GetWordCounts() const
+{
+    return m_WordCounts;
+}
+
+
+QList<HTMLResource *> WordIndex::GetFilesContaining(const QString &word) const
+{
+    QList<HTMLResource *> resources;
+    foreach(QString identifier, m_WordFiles.value(word)) {
+        resources.append(m_Files.value(identifier).resource);
+    }
+    return resources;
+}
+
+
+QList<int> WordIndex::GetOffsets(HTMLResource *html_resource, const QString &word) const
+{
+    return m_Files.value(html_resource->GetIdentifier()).offsets.value(word);
+}
+
+
+WordIndex::FileWords WordIndex::IndexFile(HTMLResource *html_resource)
+{
+    FileWords file_words;
+    file_words.resource = html_resource;
+    QReadLocker locker(&html_resource->GetLock());
+    // Read the version first so a change made meanwhile
+    // makes the entry look stale rather than current.
+    file_words.text_version = html_resource->GetTextVersion();
+    foreach(HTMLSpellCheck::MisspelledWord word, HTMLSpellCheck::GetWords(html_resource->GetText())) {
+        file_words.offsets[word.text].append(word.offset);
+    }
+    return file_words;
+}
+
+
+void WordIndex::AddFile(const QString &identifier, const FileWords &file_words)
+{
+    m_Files.insert(identifier, file_words);
+    QHashIterator<QString, QList<int>> it(file_words.offsets);
+
+    while (it.hasNext()) {
+        it.next();
+        m_WordFiles[it.key()].insert(identifier);
+        m_WordCounts[it.key()] += it.value().count();
+    }
+}
+
+
+void WordIndex::RemoveFile(const QString &identifier)
+{
+    if (!m_Files.contains(identifier)) {
+        return;
+    }
+
+    FileWords file_words = m_Files.take(identifier);
+    QHashIterator<QString, QList<int>> it(file_words.offsets);
+
+    while (it.hasNext()) {
+        it.next();
+        const QString &word = it.key();
+        QSet<QString> &files = m_WordFiles[word];
+        files.remove(identifier);
+
+        if (files.isEmpty()) {
+            m_WordFiles.remove(word);
+        }
+
+        int &count = m_WordCounts[word];
+        count -= it.value().count();
+
+        if (count <= 0) {
+            m_WordCounts.remove(word);
+        }
+    }
+}
+
+
+void WordIndex::Clear()
+{
+    m_Files.clear();
+    m_WordFiles.clear();
+    m_WordCounts.clear();
+}
@@ -0,0 +1,107 @@
+/************************************************************************
+**
+**  Copyright (C) 2015  Sigil Developers
+**
+**  This file is part of Sigil.
+**
+**  Sigil is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  Sigil is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with Sigil.  If not, see <http://www.gnu.org/licenses/>.
+**
+*************************************************************************/
+
+#pragma once
+#ifndef WORDINDEX_H
+#define WORDINDEX_H
+
+#include <QtCore/QHash>
+#include <QtCore/QList>
+#include <QtCore/QSet>
+#include <QtCore/QString>
+
+class HTMLResource;
+
+/**
+ * An inverted index of the words in the book's HTML files,
+ * using the same tokenizing as the spellchecker.
+ *
+ * The index is brought up to date with Update(). Only files whose
+ * text changed since they were last indexed are tokenized again,
+ * in parallel. The queries then cost time proportional to the
+ * number of matches rather than to the size of the book.
+ *
+ * Must be used from the GUI thread.
+ */
+class WordIndex
+{
+
+public:
+    /**
+     * Indexes the files that are new or changed and
+     * drops the files that are no longer in the list.
+     */
+    void Update(const QList<HTMLResource *> &html_resources);
+
+    /**
+     * Returns every word with the number of times it is used.
+     */
+    QHash<QString, int> GetWordCounts() const;
+
+    /**
+     * Returns the files that contain the word, in no particular order.
+     */
+    QList<HTMLResource *> GetFilesContaining(const QString &word) const;
+
+    /**
+     * Returns the offsets of the word in the text of the file, in order.
+     */
+    QList<int> GetOffsets(HTMLResource *html_resource, const QString &word) const;
+
+private:
+    struct FileWords {
+        HTMLResource *resource;
+
+        // The text version the offsets were taken from
+        int text_version;
+
+        // The offsets of each word in the file
+        QHash<QString, QList<int>> offsets;
+    };
+
+    static FileWords IndexFile(HTMLResource *html_resource);
+
+    void AddFile(const QString &identifier, const FileWords &file_words);
+
+    void RemoveFile(const QString &identifier);
+
+    void Clear();
+
+    /**
+     * The indexed files by resource identifier.
+     */
+    QHash<QString, FileWords> m_Files;
+
+    /**
+     * For each word, the identifiers of the files using it.
+     */
+    QHash<QString, QSet<QString>> m_WordFiles;
+
+    QHash<QString, int> m_WordCounts;
+
+    /**
+     * The dictionary word characters the index was built with.
+     * They decide where words are split.
+     */
+    QString m_WordChars;
+};
+
+#endif // WORDINDEX_H
@@ -49,6 +49,7 @@
 #include "BookManipulation/XercesCppUse.h"
 #include "BookManipulation/XhtmlDoc.h"
 #include "Misc/Utility.h"
+#include "Misc/XMLEntities.h"
 #include "sigil_constants.h"
 #include "sigil_exception.h"
 
@@ -65,6 +66,7 @@ const QStringList VIDEO_TAGS = QStringList() << "video";
 const QStringList AUDIO_TAGS = QStringList() << "audio";
 
 static const QStringList INVALID_ID_TAGS = QStringList() << "base" << "head" << "meta" << "param" << "script" << "style" << "title";
+static const QStringList INVISIBLE_TEXT_TAGS = QStringList() << "head" << "script" << "style";
 static const QStringList SKIP_ID_TAGS = QStringList() << "html" << "#document" << "body";
 const QStringList ID_TAGS = QStringList() << BLOCK_LEVEL_TAGS <<
                             "dd" << "dt" << "li" << "tbody" << "td" << "tfoot" <<
@@ -592,6 +594,132 @@ QString XhtmlDoc::GetTextInHtml(const QString &source)
 }
 
 
+QString XhtmlDoc::GetVisibleTextInHtml(const QString &source)
+{
+    // Make sure the entity tables are built before we
+    // (possibly) get called from several threads at once.
+    XMLEntities *entities = XMLEntities::instance();
+    QString text;
+    text.reserve(source.length() / 2);
+    const int length = source.length();
+    const QChar *data = source.constData();
+    // The name of the invisible element we are inside of, if any.
+    QString skip_until;
+    int i = 0;
+
+    while (i < length) {
+        const QChar c = data[ i ];
+
+        if (c == '<') {
+            if (source.midRef(i, 4) == "<!--") {
+                int end = source.indexOf("-->", i + 4);
+                i = end == -1 ? length : end + 3;
+                continue;
+            }
+
+            if (source.midRef(i, 9) == "<![CDATA[") {
+                int end = source.indexOf("]]>", i + 9);
+                int content_end = end == -1 ? length : end;
+
+                if (skip_until.isEmpty()) {
+                    text.append(source.midRef(i + 9, content_end - i - 9));
+                }
+
+                i = end == -1 ? length : end + 3;
+                continue;
+            }
+
+            // Find the end of the tag, ignoring any '>' in quoted attribute values.
+            int tag_end = i + 1;
+            QChar quote;
+
+            while (tag_end < length) {
+                const QChar t = data[ tag_end ];
+
+                if (!quote.isNull()) {
+                    if (t == quote) {
+                        quote = QChar();
+                    }
+                } else if (t == '"' || t == '\'') {
+                    quote = t;
+                } else if (t == '>') {
+                    break;
+                }
+
+                ++tag_end;
+            }
+
+            bool is_end_tag = i + 1 < length && data[ i + 1 ] == '/';
+            bool is_empty_tag = tag_end > i && data[ tag_end - 1 ] == '/';
+            int name_start = is_end_tag ? i + 2 : i + 1;
+            int name_end = name_start;
+
+            while (name_end < tag_end && !data[ name_end ].isSpace() && data[ name_end ] != '/') {
+                ++name_end;
+            }
+
+            QString name = source.mid(name_start, name_end - name_start).toLower();
+            int colon = name.indexOf(':');
+
+            if (colon != -1) {
+                name = name.mid(colon + 1);
+            }
+
+            if (skip_until.isEmpty()) {
+                if (!is_end_tag && !is_empty_tag && INVISIBLE_TEXT_TAGS.contains(name)) {
+                    skip_until = name;
+                }
+            } else if (is_end_tag && name == skip_until) {
+                skip_until.clear();
+            }
+
+            i = tag_end + 1;
+            continue;
+        }
+
+        if (!skip_until.isEmpty()) {
+            ++i;
+            continue;
+        }
+
+        if (c == '&') {
+            int semicolon = source.indexOf(';', i + 1);
+
+            // Entity names are short; anything longer is a stray ampersand.
+            if (semicolon != -1 && semicolon - i <= 32) {
+                QString entity = source.mid(i, semicolon - i + 1);
+
+                if (entity.startsWith("&#")) {
+                    bool ok;
+                    uint code = entity.startsWith("&#x", Qt::CaseInsensitive) ?
+                                entity.mid(3, entity.length() - 4).toUInt(&ok, 16) :
+                                entity.mid(2, entity.length() - 3).toUInt(&ok, 10);
+
+                    if (ok && code > 0) {
+                        text.append(QString::fromUcs4(&code, 1));
+                        i = semicolon + 1;
+                        continue;
+                    }
+                } else {
+                    ushort code = entities->GetEntityCode(entity);
+
+                    if (code != 0) {
+                        text.append(QChar(code));
+                        i = semicolon + 1;
+                        continue;
+                    }
+                }
+            }
+        }
+
+        text.append(c);
+        ++i;
+    }
+
+    return text;
+}
+
+
 // Resolves HTML entities in the provided string.
 // For instance:
 //    Bonnie &amp; Clyde
@@ -144,6 +144,13 @@ public:
     //   Hello Qt this is great
     static QString GetTextInHtml(const QString &source);
 
+    // Returns the text a reader would see when the provided XHTML
+    // source is displayed. Unlike GetTextInHtml this does not need
+    // a QWebPage, so it is fast and safe to call from worker threads.
+    // The head section, script and style elements, comments and
+    // processing instructions are skipped and entities are resolved.
+    static QString GetVisibleTextInHtml(const QString &source);
+
     // Resolves HTML entities in the provided string.
     // For instance:
     //    Bonnie &amp; Clyde
@@ -19,14 +19,14 @@
 **
 *************************************************************************/
 
+#include <QtCore/QHash>
 #include <QtCore/QStringList>
 #include <QtGui/QStandardItem>
+#include <QtWidgets/QMessageBox>
 #include <QKeyEvent>
 
 #include "BookManipulation/Book.h"
 #include "BookManipulation/FolderKeeper.h"
-#include "BookManipulation/XercesCppUse.h"
-#include "BookManipulation/XhtmlDoc.h"
 #include "Dialogs/HeadingSelector.h"
 #include "Misc/SettingsStore.h"
 #include "Misc/Utility.h"
@@ -243,20 +243,53 @@ void HeadingSelector::UpdateHeadingElements()
     // if required, setting ids etc.
     int next_toc_id = 1;
     UpdateOneHeadingElement(m_TableOfContents.invisibleRootItem(), used_ids, next_toc_id);
-    // Now iterate through the headings one final time, to save the underlying resources
-    // that we have changed.
-    QStringList ids;
-    foreach(Headings::Heading heading, m_Headings) {
-        ids = UpdateOneFile(heading, ids);
-    }
-    // Finally check to see whether we did actually make a change to the book.
-    foreach(Headings::Heading heading, m_Headings) {
+    // Now gather the changed headings by file, and save each changed file once
+    // by rewriting just the tags of its changed headings.
+    QHash<HTMLResource *, QList<Headings::Heading>> changed_headings;
+    foreach(Headings::Heading heading, Headings::GetFlattenedHeadings(m_Headings)) {
         if (heading.is_changed) {
-            m_book_changed = true;
-            break;
+            changed_headings[ heading.resource_file ].append(heading);
+        }
+    }
+    QHashIterator<HTMLResource *, QList<Headings::Heading>> changed(changed_headings);
+    QStringList failed_files;
+
+    while (changed.hasNext()) {
+        changed.next();
+        HTMLResource *resource = changed.key();
+        // The offsets in the headings are only valid for
+        // the text the headings were read from.
+        bool ok = true;
+        foreach(Headings::Heading heading, changed.value()) {
+            if (heading.text_version != resource->GetTextVersion()) {
+                ok = false;
+                break;
+            }
+        }
+        QString new_source;
+
+        if (ok) {
+            new_source = Headings::GetSourceWithHeadingChanges(resource->GetText(), changed.value(), &ok);
+        }
+
+        if (!ok) {
+            failed_files.append(resource->Filename());
+            continue;
         }
+
+        resource->SetText(new_source);
+        // Finally note that we did actually make a change to the book.
+        m_book_changed = true;
     }
+
     QApplication::restoreOverrideCursor();
+
+    if (!failed_files.isEmpty()) {
+        failed_files.sort();
+        QMessageBox::warning(this, tr("Sigil"),
+                             tr("The headings in these files could not be updated because the files changed:\n\n%1")
+                             .arg(failed_files.join("\n")));
+    }
 }
 
 int HeadingSelector::UpdateOneHeadingElement(QStandardItem *item, QStringList used_ids, int next_toc_id)
@@ -266,7 +299,7 @@ int HeadingSelector::UpdateOneHeadingElement(QStandardItem *item, QStringList us
     if (heading != NULL) {
         // Update heading inclusion: if a heading element
         // has one of the SIGIL_NOT_IN_TOC_CLASS classes, then it's not in the TOC
-        const QString &class_attribute = XtoQ(heading->element->getAttribute(QtoX("class")));
+        const QString &class_attribute = heading->classes;
         QString new_class_attribute = QString(class_attribute)
                                       .remove(SIGIL_NOT_IN_TOC_CLASS)
                                       .remove(OLD_SIGIL_NOT_IN_TOC_CLASS)
@@ -279,18 +312,11 @@ int HeadingSelector::UpdateOneHeadingElement(QStandardItem *item, QStringList us
         // Only apply the change if it is different
         if (new_class_attribute != class_attribute) {
             heading->is_changed = true;
-
-            if (!new_class_attribute.isEmpty()) {
-                heading->element->setAttribute(QtoX("class"), QtoX(new_class_attribute));
-            } else {
-                heading->element->removeAttribute(QtoX("class"));
-            }
+            heading->classes = new_class_attribute;
         }
 
         // Now apply the new id as needed.
-        const QString &existing_id_attribute = heading->element->hasAttribute(QtoX("id"))
-                                               ? XtoQ(heading->element->getAttribute(QtoX("id")))
-                                               : QString();
+        const QString existing_id_attribute = heading->id;
         QString new_id_attribute(existing_id_attribute);
 
         if (!heading->include_in_toc || heading->at_file_start) {
@@ -321,12 +347,7 @@ int HeadingSelector::UpdateOneHeadingElement(QStandardItem *item, QStringList us
         // Only apply the change if it is different
         if (new_id_attribute.trimmed() != existing_id_attribute) {
             heading->is_changed = true;
-
-            if (!new_id_attribute.isEmpty()) {
-                heading->element->setAttribute(QtoX("id"), QtoX(new_id_attribute));
-            } else {
-                heading->element->removeAttribute(QtoX("id"));
-            }
+            heading->id = new_id_attribute;
         }
     }
 
@@ -339,25 +360,6 @@ int HeadingSelector::UpdateOneHeadingElement(QStandardItem *item, QStringList us
     return next_toc_id;
 }
 
-QStringList HeadingSelector::UpdateOneFile(Headings::Heading &heading, QStringList ids)
-{
-    // Only save the document if we have changed the heading
-    if (heading.is_changed) {
-        if (!ids.contains(heading.resource_file->GetIdentifier())) {
-            heading.resource_file->SetText(XhtmlDoc::GetDomDocumentAsString(*heading.document.get()));
-            ids << heading.resource_file->GetIdentifier();
-        }
-    }
-
-    if (!heading.children.isEmpty()) {
-        for (int i = 0; i < heading.children.count(); ++i) {
-            ids = UpdateOneFile(heading.children[ i ], ids);
-        }
-    }
-
-    return ids;
-}
-
 void HeadingSelector::UpdateOneHeadingTitle(QStandardItem *item, const QString &title)
 {
     Headings::Heading *heading = GetItemHeading(item);
@@ -368,7 +370,6 @@ void HeadingSelector::UpdateOneHeadingTitle(QStandardItem *item, const QString &
         if (title != heading->title) {
             heading->title = title;
             heading->is_changed = true;
-            heading->element->setAttribute(QtoX("title"), QtoX(title));
         }
     }
 }
@@ -415,11 +416,6 @@ void HeadingSelector::ChangeHeadingLevel(int change_amount)
     heading->level += change_amount;
     // Update whether we have made changes to the document for this heading element
     heading->is_changed = (heading->level != heading->orig_level) || (heading->title != heading->orig_title);
-    // Get new tag name
-    QString tag_name = XtoQ(heading->element->getTagName());
-    QString new_tag_name = "h" + QString::number(heading->level);
-    // Rename in document
-    heading->element = XhtmlDoc::RenameElementInDocument(*heading->document, *heading->element, new_tag_name);
     // Clear all children information then rebuild hierarchy
     QList<Headings::Heading> flat_headings = Headings::GetFlattenedHeadings(m_Headings);
 
@@ -575,8 +571,7 @@ void HeadingSelector::InsertHeadingIntoModel(Headings::Heading &heading, QStanda
     wrap.heading = &heading;
     item_heading->setData(QVariant::fromValue(wrap));
     // Apparently using \n in the string means you don't have to replace < with &lt; or > with &gt;
-    QString html = XhtmlDoc::GetDomNodeAsString(*heading.element).remove("xmlns=\"http://www.w3.org/1999/xhtml\"");
-    item_heading->setToolTip(heading.resource_file->Filename() + ":\n\n" + html);
+    item_heading->setToolTip(heading.resource_file->Filename() + ":\n\n" + heading.element_source);
     QList<QStandardItem *> items;
     items << item_heading << heading_level << heading_included_check;
     parent_item->appendRow(items);
@@ -7,6 +7,7 @@
 #include <QXmlStreamReader>
 #include <QXmlStreamAttributes>
 #include <QMessageBox>
+#include <QtConcurrent/QtConcurrent>
 #include "MainUI/MainWindow.h"
 #include "MainUI/BookBrowser.h"
 #include "Misc/Plugin.h"
@@ -17,6 +18,11 @@
 #include "Tabs/TabManager.h"
 #include "BookManipulation/XhtmlDoc.h"
 #include "Dialogs/PluginRunner.h"
+#include "sigil_exception.h"
+
+using boost::make_tuple;
+using boost::tie;
+using boost::tuple;
 
 const QString ADOBE_FONT_ALGO_ID         = "http://ns.adobe.com/pdf/enc#RC";
 const QString IDPF_FONT_ALGO_ID          = "http://www.idpf.org/2008/embedding";
@@ -166,10 +172,9 @@ void PluginRunner::startPlugin()
     ui.textEdit->setPlainText("");
 
     // prepare for the plugin by flushing all current book changes to disk
+    // Only resources edited since they were last saved need to be written
     m_mainWindow->SaveTabData();
-    m_book->GetFolderKeeper().SuspendWatchingResources();
-    m_book->SaveAllResourcesToDisk();
-    m_book->GetFolderKeeper().ResumeWatchingResources();
+    m_book->SaveDirtyResourcesToDisk();
     ui.startButton->setEnabled(false);
     ui.okButton->setEnabled(false);
     ui.cancelButton->setEnabled(true);
@@ -666,64 +671,69 @@ bool PluginRunner::modifyFiles(const QStringList &files)
         newfiles.append(modifyncx);
     }
 
+    // Move the modified files into the book instead of copying them
+    // and remember which resources have to reload their text.
+    QList<Resource *> text_resources;
+    QStringList text_paths;
     foreach (QString fileinfo, newfiles) {
         QStringList fdata = fileinfo.split(SEP);
         QString href = fdata[ hrefField ];
-        QString id   = fdata[ idField   ];
-        QString mime = fdata[ mimeField ];
         QString inpath = m_outputDir + "/" + href;
         QString outpath = m_bookRoot + "/" + href;
-        QFileInfo fi(outpath);
-        ui.statusLbl->setText(tr("Status: modifying ") + fi.fileName());
-        Utility::ForceCopyFile(inpath, outpath);
+        Utility::ForceMoveFile(inpath, outpath);
         Resource *resource = m_hrefToRes.value(href);
-        if (resource) {
-
-            // AudioResource, VideoResource, FontResource, ImageResource do not appear to be editable
-
-            // For Editable Resources must relaod them from modified file
-            // Order below is important as some resouirce types inherit from other resource types
-
-            if (resource->Type() == Resource::HTMLResourceType) {
-
-                HTMLResource *html_resource = qobject_cast<HTMLResource *> (resource);
-                html_resource->SetText(Utility::ReadUnicodeTextFile(inpath));
-
-            } else if (resource->Type() == Resource::CSSResourceType) {
-
-                CSSResource *css_resource = qobject_cast<CSSResource *> (resource);
-                css_resource->SetText(Utility::ReadUnicodeTextFile(inpath));
-
-            } else if (resource->Type() == Resource::SVGResourceType) {
-
-                SVGResource *svg_resource = qobject_cast<SVGResource *> (resource);
-                svg_resource->SetText(Utility::ReadUnicodeTextFile(inpath));
 
-            } else if (resource->Type() == Resource::MiscTextResourceType) {
-
-                MiscTextResource *misctext_resource = qobject_cast<MiscTextResource *> (resource);
-                misctext_resource->SetText(Utility::ReadUnicodeTextFile(inpath));
+        // AudioResource, VideoResource, FontResource, ImageResource do not appear to be editable
+        if (resource && qobject_cast<TextResource *> (resource)) {
+            text_resources.append(resource);
+            text_paths.append(outpath);
+        }
+    }
 
-            } else if (resource->Type() == Resource::OPFResourceType) {
+    // Read all the modified files in parallel.
+    ui.statusLbl->setText(tr("Status: cleaning up - loading modified files"));
+    QList<tuple<QString, QByteArray, bool> > texts = QtConcurrent::blockingMapped(text_paths, ReadModifiedFile);
 
-                OPFResource *opf_resource = qobject_cast<OPFResource *> (resource);
-                opf_resource->SetText(Utility::ReadUnicodeTextFile(outpath));
+    // For Editable Resources must relaod them from modified file.
+    // The text is set on this thread in list order so the OPF and NCX still go last.
+    for (int i = 0; i < text_resources.count(); ++i) {
+        QString text;
+        QByteArray content_hash;
+        bool read_ok;
+        tie(text, content_hash, read_ok) = texts.at(i);
+        if (!read_ok) {
+            continue;
+        }
+        Resource *resource = text_resources.at(i);
 
-            } else if (resource->Type() == Resource::NCXResourceType) {
+        if (resource->Type() == Resource::HTMLResourceType) {
 
-                NCXResource *ncx_resource = qobject_cast<NCXResource *> (resource);
-                ncx_resource->SetText(Utility::ReadUnicodeTextFile(outpath));
+            HTMLResource *html_resource = qobject_cast<HTMLResource *> (resource);
+            html_resource->SetText(text);
+            html_resource->MarkTextAsOnDisk(content_hash);
 
-            } else if (resource->Type() == Resource::XMLResourceType) {
+        } else {
 
-                XMLResource *xml_resource = qobject_cast<XMLResource *> (resource);
-                xml_resource->SetText(Utility::ReadUnicodeTextFile(inpath));
-            }
+            TextResource *text_resource = qobject_cast<TextResource *> (resource);
+            text_resource->SetText(text);
+            text_resource->MarkTextAsOnDisk(content_hash);
         }
     }
     return true;
 }
 
+
+tuple<QString, QByteArray, bool> PluginRunner::ReadModifiedFile(const QString &path)
+{
+    try {
+        QByteArray content_hash;
+        QString text = Utility::ReadUnicodeTextFile(path, &content_hash);
+        return make_tuple(text, content_hash, true);
+    } catch (CannotOpenFile) {
+        return make_tuple(QString(), QByteArray(), false);
+    }
+}
+
 void PluginRunner::connectSignalsToSlots()
 {
     connect(ui.startButton, SIGNAL(clicked()), this, SLOT(startPlugin()));
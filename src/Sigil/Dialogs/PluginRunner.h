@@ -27,6 +27,9 @@
 #include <QDialog>
 #include <QProgressBar>
 #include <QProcess>
+
+#include <boost/tuple/tuple.hpp>
+
 #include "Misc/TempFolder.h"
 #include "Misc/ValidationResult.h"
 
@@ -90,6 +93,7 @@ private:
     bool deleteFiles(const QStringList &);
     bool addFiles(const QStringList &);
     bool modifyFiles(const QStringList &);
+    static boost::tuple<QString, QByteArray, bool> ReadModifiedFile(const QString &path);
     void connectSignalsToSlots();
 
     QProcess m_process;
@@ -21,6 +21,7 @@
 *************************************************************************/
 
 #include "Dialogs/PreferenceWidgets/CleanSourceWidget.h"
+#include "Misc/SettingsSnapshot.h"
 
 #include <QString>
 #include <QStringList>
@@ -49,9 +50,10 @@ PreferencesWidget::ResultAction CleanSourceWidget::saveSettings()
         new_clean_on_level |= CLEANON_SAVE;
     }
 
-    SettingsStore settings;
-    settings.setCleanLevel(new_clean_level);
-    settings.setCleanOn(new_clean_on_level);
+    SettingsSnapshot::Values values = SettingsSnapshot::instance()->values();
+    values.clean_level = new_clean_level;
+    values.clean_on = new_clean_on_level;
+    SettingsSnapshot::instance()->Commit(values);
     return PreferencesWidget::ResultAction_None;
 }
 
@@ -22,6 +22,7 @@
 #include <QtGui/QDesktopServices>
 #include <QtWidgets/QInputDialog>
 #include "PreserveEntitiesWidget.h"
+#include "Misc/SettingsSnapshot.h"
 #include "Misc/SettingsStore.h"
 #include "Misc/XMLEntities.h"
 
@@ -42,7 +43,6 @@ PreferencesWidget::ResultAction PreserveEntitiesWidget::saveSettings()
     }
 
     // Save preserve entities information
-    SettingsStore settings;
     QList<std::pair<ushort, QString>> codenames;
     for (int i = 0; i < ui.entityList->count(); ++i) {
         QString name = ui.entityList->item(i)->text();
@@ -52,7 +52,9 @@ PreferencesWidget::ResultAction PreserveEntitiesWidget::saveSettings()
             codenames.append(epair);
         }
     }
-    settings.setPreserveEntityCodeNames(codenames);
+    SettingsSnapshot::Values values = SettingsSnapshot::instance()->values();
+    values.preserve_entity_code_names = codenames;
+    SettingsSnapshot::instance()->Commit(values);
 
     return PreferencesWidget::ResultAction_None;
 }
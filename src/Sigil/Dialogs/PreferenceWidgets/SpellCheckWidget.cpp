@@ -30,6 +30,7 @@
 
 #include "SpellCheckWidget.h"
 #include "Misc/Language.h"
+#include "Misc/SettingsSnapshot.h"
 #include "Misc/SettingsStore.h"
 #include "Misc/SpellCheck.h"
 #include "Misc/Utility.h"
@@ -78,14 +79,15 @@ PreferencesWidget::ResultAction SpellCheckWidget::saveSettings()
     }
 
     // Save dictionary information
-    SettingsStore settings;
-    settings.setEnabledUserDictionaries(EnabledDictionaries());
-    settings.setDefaultUserDictionary(ui.defaultUserDictionary->text());
-    settings.setDictionary(ui.dictionaries->itemData(ui.dictionaries->currentIndex()).toString());
-    settings.setSpellCheck(ui.HighlightMisspelled->checkState() == Qt::Checked);
+    SettingsSnapshot::Values values = SettingsSnapshot::instance()->values();
+    values.enabled_user_dictionaries = EnabledDictionaries();
+    values.default_user_dictionary = ui.defaultUserDictionary->text();
+    values.dictionary = ui.dictionaries->itemData(ui.dictionaries->currentIndex()).toString();
+    values.spell_check = ui.HighlightMisspelled->checkState() == Qt::Checked;
+    SettingsSnapshot::instance()->Commit(values);
 
     SpellCheck *sc = SpellCheck::instance();
-    sc->setDictionary(settings.dictionary(), true);
+    sc->setDictionary(values.dictionary, true);
 
     return PreferencesWidget::ResultAction_RefreshSpelling;
 }
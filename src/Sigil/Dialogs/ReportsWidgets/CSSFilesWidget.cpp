@@ -28,6 +28,7 @@
 #include <QtWidgets/QPushButton>
 
 #include "sigil_exception.h"
+#include "BookManipulation/BookReports.h"
 #include "BookManipulation/FolderKeeper.h"
 #include "Dialogs/ReportsWidgets/CSSFilesWidget.h"
 #include "Misc/NumericItem.h"
@@ -74,10 +75,11 @@ void CSSFilesWidget::SetupTable(int sort_column, Qt::SortOrder sort_order)
     ui.fileTree->header()->setSortIndicatorShown(true);
     // Get all a count of all the linked stylesheets
     QHash<QString, int> linked_stylesheets_hash;
+    QHash<QString, BookReports::HTMLFileData> html_file_data = BookReports::GetHTMLFileData(m_Book);
     foreach(HTMLResource * html_resource, m_HTMLResources) {
         QString html_filename = html_resource->Filename();
         // Get the linked stylesheets for this file
-        QStringList linked_stylesheets = m_Book->GetStylesheetsInHTMLFile(html_resource);
+        QStringList linked_stylesheets = html_file_data.value(html_filename).stylesheets;
         foreach(QString stylesheet, linked_stylesheets) {
             if (linked_stylesheets.contains(stylesheet)) {
                 linked_stylesheets_hash[stylesheet]++;
@@ -19,10 +19,6 @@
 **  along with Sigil.  If not, see <http://www.gnu.org/licenses/>.
 **
 *************************************************************************/
-#include <QWebView>
-#include <QWebPage>
-#include "Misc/SleepFunctions.h"
-
 #include <QtCore/QFile>
 #include <QtCore/QHashIterator>
 #include <QtWidgets/QFileDialog>
@@ -47,8 +43,7 @@ CharactersInHTMLFilesWidget::CharactersInHTMLFilesWidget()
     :
     m_ItemModel(new QStandardItemModel),
     m_LastDirSaved(QString()),
-    m_LastFileSaved(QString()),
-    m_PageLoaded(false)
+    m_LastFileSaved(QString())
 {
     ui.setupUi(this);
     connectSignalsSlots();
@@ -72,6 +67,7 @@ void CharactersInHTMLFilesWidget::SetupTable()
     m_ItemModel->clear();
     QStringList header;
     header.append(tr("Character"));
+    header.append(tr("Count"));
     header.append(tr("Decimal"));
     header.append(tr("Hexadecimal"));
     header.append(tr("Entity Name"));
@@ -87,8 +83,9 @@ void CharactersInHTMLFilesWidget::SetupTable()
 
 void CharactersInHTMLFilesWidget::AddTableData()
 {
-    const QList<HTMLResource *> html_resources = m_Book->GetHTMLResources();
-    QList <QChar> characters = GetDisplayedCharacters(html_resources);
+    QHash<QChar, int> character_counts = m_Book->GetCharactersInHTMLFiles();
+    QList<QChar> characters = character_counts.keys();
+    qSort(characters);
     QString all_characters;
     foreach (QChar c, characters) {
         all_characters.append(c);
@@ -102,8 +99,12 @@ void CharactersInHTMLFilesWidget::AddTableData()
         QStandardItem *item = new QStandardItem();
         item->setText(QString(c));
         rowItems << item;
+        // Count
+        NumericItem *count_item = new NumericItem();
+        count_item->setText(QString::number(character_counts.value(c)));
+        rowItems << count_item;
         // Decimal number
-        item = new QStandardItem();
+        item = new NumericItem();
         ushort char_number = c.unicode();
         item->setText(QString::number(char_number));
         rowItems << item;
@@ -130,50 +131,6 @@ void CharactersInHTMLFilesWidget::AddTableData()
     }
 }
 
-void CharactersInHTMLFilesWidget::PageLoaded()
-{
-    m_PageLoaded = true;
-}
-
-QList <QChar> CharactersInHTMLFilesWidget::GetDisplayedCharacters(QList<HTMLResource *> resources)
-{
-    QWebView *view = new QWebView();
-    view->setGeometry(0,0,200,200);
-    connect(view->page(), SIGNAL(loadFinished(bool)), this, SLOT(PageLoaded()));
-    m_PageLoaded = false;
-
-    QString all_characters;
-    foreach (HTMLResource *resource, resources) {
-        QString replaced_html = resource->GetText();
-        replaced_html = replaced_html.replace("<html>", "<html xmlns=\"http://www.w3.org/1999/xhtml\">");
-        // Skip displaying images, etc. to improve performance
-        replaced_html = replaced_html.replace("<(img|video|audio)", "<ignore");
-        replaced_html = replaced_html.replace("</(img|video|audio)", "</ignore");
-        view->setContent(replaced_html.toUtf8(), "application/xhtml+xml", QUrl::fromLocalFile(resource->GetFullPath()));
-
-        while (!m_PageLoaded) {
-            qApp->processEvents();
-            SleepFunctions::msleep(100);
-        }
-        m_PageLoaded = false;
-
-        view->page()->triggerAction(QWebPage::SelectAll);
-        QString text = view->page()->selectedText();
-        all_characters.append(text);
-    }
-
-    QMap <QChar, QChar> character_map;
-    foreach (const QChar c, all_characters) {
-        if (c != '\n') {
-            character_map.insert(c, c);
-        }
-    }
-    QList <QChar> character_list;
-    character_list = character_map.values();
-
-    return character_list;
-}
-
 
 void CharactersInHTMLFilesWidget::FilterEditTextChangedSlot(const QString &text)
 {
@@ -188,7 +145,8 @@ void CharactersInHTMLFilesWidget::FilterEditTextChangedSlot(const QString &text)
             root_item->child(row, 1)->text().toLower().contains(lowercaseText) ||
             root_item->child(row, 2)->text().toLower().contains(lowercaseText) ||
             root_item->child(row, 3)->text().toLower().contains(lowercaseText) ||
-            root_item->child(row, 4)->text().toLower().contains(lowercaseText)) {
+            root_item->child(row, 4)->text().toLower().contains(lowercaseText) ||
+            root_item->child(row, 5)->text().toLower().contains(lowercaseText)) {
             ui.fileTree->setRowHidden(row, parent_index, false);
 
             if (first_visible_row == -1) {
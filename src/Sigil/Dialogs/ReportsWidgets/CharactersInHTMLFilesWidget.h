@@ -58,8 +58,6 @@ private slots:
     void Save();
     void DoubleClick();
 
-    void PageLoaded();
-
 private:
     void ReadSettings();
     void WriteSettings();
@@ -69,8 +67,6 @@ private:
     void SetupTable();
     void AddTableData();
 
-    QList <QChar> GetDisplayedCharacters(QList<HTMLResource *> resources);
-
     QSharedPointer<Book> m_Book;
 
     QStandardItemModel *m_ItemModel;
@@ -78,8 +74,6 @@ private:
     QString m_LastDirSaved;
     QString m_LastFileSaved;
 
-    bool m_PageLoaded;
-
     Ui::CharactersInHTMLFilesWidget ui;
 };
 
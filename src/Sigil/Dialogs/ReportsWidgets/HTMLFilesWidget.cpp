@@ -30,7 +30,6 @@
 #include "sigil_exception.h"
 #include "BookManipulation/FolderKeeper.h"
 #include "Dialogs/ReportsWidgets/HTMLFilesWidget.h"
-#include "Misc/HTMLSpellCheck.h"
 #include "Misc/NumericItem.h"
 #include "Misc/SettingsStore.h"
 #include "Misc/Utility.h"
@@ -57,6 +56,8 @@ void HTMLFilesWidget::CreateReport(QSharedPointer<Book> book)
 {
     m_Book = book;
     m_HTMLResources = m_Book->GetFolderKeeper().GetResourceTypeList<HTMLResource>(false);
+    m_HTMLFileData = BookReports::GetHTMLFileData(m_Book);
+    m_MisspelledWordCounts = BookReports::CountMisspelledWords(m_HTMLFileData);
     SetupTable();
 }
 
@@ -86,14 +87,11 @@ void HTMLFilesWidget::SetupTable(int sort_column, Qt::SortOrder sort_order)
     int total_audio = 0;
     int total_stylesheets = 0;
     int total_wellformed = 0;
-    QHash<QString, QStringList> stylesheet_names_hash = m_Book->GetStylesheetsInHTMLFiles();
-    QHash<QString, QStringList> image_names_hash = m_Book->GetImagesInHTMLFiles();
-    QHash<QString, QStringList> video_names_hash = m_Book->GetVideoInHTMLFiles();
-    QHash<QString, QStringList> audio_names_hash = m_Book->GetAudioInHTMLFiles();
     foreach(HTMLResource *html_resource, m_HTMLResources) {
         QString filepath = "../" + html_resource->GetRelativePathToOEBPS();
         QString path = html_resource->GetFullPath();
         QString filename = html_resource->Filename();
+        const BookReports::HTMLFileData &file_data = m_HTMLFileData[filename];
         QList<QStandardItem *> rowItems;
         // Filename
         QStandardItem *name_item = new QStandardItem();
@@ -108,20 +106,20 @@ void HTMLFilesWidget::SetupTable(int sort_column, Qt::SortOrder sort_order)
         size_item->setText(fsize);
         rowItems << size_item;
         // All words
-        int all_words = HTMLSpellCheck::CountAllWords(html_resource->GetText());
+        int all_words = BookReports::CountAllWords(file_data);
         total_all_words += all_words;
         NumericItem *words_item = new NumericItem();
         words_item->setText(QString::number(all_words));
         rowItems << words_item;
         // Misspelled words
-        int misspelled_words = HTMLSpellCheck::CountMisspelledWords(html_resource->GetText());
+        int misspelled_words = m_MisspelledWordCounts.value(filename);
         total_misspelled_words += misspelled_words;
         NumericItem *misspelled_item = new NumericItem();
         misspelled_item->setText(QString::number(misspelled_words));
         rowItems << misspelled_item;
         // Images
         NumericItem *image_item = new NumericItem();
-        QStringList image_names = image_names_hash[filename];
+        QStringList image_names = file_data.images;
         total_images += image_names.count();
         image_item->setText(QString::number(image_names.count()));
         if (!image_names.isEmpty()) {
@@ -130,7 +128,7 @@ void HTMLFilesWidget::SetupTable(int sort_column, Qt::SortOrder sort_order)
         rowItems << image_item;
         // Video
         NumericItem *video_item = new NumericItem();
-        QStringList video_names = video_names_hash[filename];
+        QStringList video_names = file_data.video;
         total_video += video_names.count();
         video_item->setText(QString::number(video_names.count()));
         if (!video_names.isEmpty()) {
@@ -139,7 +137,7 @@ void HTMLFilesWidget::SetupTable(int sort_column, Qt::SortOrder sort_order)
         rowItems << video_item;
         // Audio
         NumericItem *audio_item = new NumericItem();
-        QStringList audio_names = audio_names_hash[filename];
+        QStringList audio_names = file_data.audio;
         total_audio += audio_names.count();
         audio_item->setText(QString::number(audio_names.count()));
         if (!audio_names.isEmpty()) {
@@ -148,7 +146,7 @@ void HTMLFilesWidget::SetupTable(int sort_column, Qt::SortOrder sort_order)
         rowItems << audio_item;
         // Linked Stylesheets
         NumericItem *stylesheet_item = new NumericItem();
-        QStringList stylesheet_names = stylesheet_names_hash[filename];
+        QStringList stylesheet_names = file_data.stylesheets;
         total_stylesheets += stylesheet_names.count();
         stylesheet_item->setText(QString::number(stylesheet_names.count()));
         if (!stylesheet_names.isEmpty()) {
@@ -157,7 +155,7 @@ void HTMLFilesWidget::SetupTable(int sort_column, Qt::SortOrder sort_order)
         rowItems << stylesheet_item;
         // Well formed
         QStandardItem *wellformed_item = new QStandardItem();
-        wellformed = html_resource->FileIsWellFormed();
+        wellformed = file_data.well_formed;
         if (wellformed) {
             total_wellformed++;
         }
@@ -33,6 +33,7 @@
 
 #include "ResourceObjects/Resource.h"
 #include "BookManipulation/Book.h"
+#include "BookManipulation/BookReports.h"
 #include "Dialogs/ReportsWidgets/ReportsWidget.h"
 
 #include "ui_ReportsHTMLFilesWidget.h"
@@ -79,6 +80,9 @@ private:
 
     QList<HTMLResource *> m_HTMLResources;
 
+    QHash<QString, BookReports::HTMLFileData> m_HTMLFileData;
+    QHash<QString, int> m_MisspelledWordCounts;
+
     QSharedPointer<Book> m_Book;
 
     QStandardItemModel *m_ItemModel;
@@ -29,6 +29,7 @@
 #include "sigil_exception.h"
 #include "BookManipulation/FolderKeeper.h"
 #include "Dialogs/ReportsWidgets/ImageFilesWidget.h"
+#include "Misc/ImageInfoCache.h"
 #include "Misc/NumericItem.h"
 #include "Misc/SettingsStore.h"
 #include "Misc/Utility.h"
@@ -75,6 +76,8 @@ void ImageFilesWidget::CreateReport(QSharedPointer<Book> book)
 void ImageFilesWidget::SetupTable(int sort_column, Qt::SortOrder sort_order)
 {
     m_ItemModel->clear();
+    m_PendingThumbnailItems.clear();
+    m_PendingColorItems.clear();
     QStringList header;
     header.append(tr("Name"));
     header.append(tr("File Size (KB)"));
@@ -100,7 +103,9 @@ void ImageFilesWidget::SetupTable(int sort_column, Qt::SortOrder sort_order)
     foreach(Resource * resource, m_AllImageResources) {
         QString filepath = "../" + resource->GetRelativePathToOEBPS();
         QString path = resource->GetFullPath();
-        QImage image(path);
+        // Only the image header is read here; pixels are decoded in the background.
+        ImageInfoCache::ImageInfo image_info = ImageInfoCache::instance()->GetImageInfo(path);
+        QSize image_size = image_info.size.isValid() ? image_info.size : QSize(0, 0);
         QList<QStandardItem *> rowItems;
         // Filename
         QStandardItem *name_item = new QStandardItem();
@@ -128,31 +133,42 @@ void ImageFilesWidget::SetupTable(int sort_column, Qt::SortOrder sort_order)
         rowItems << link_item;
         // Width
         NumericItem *width_item = new NumericItem();
-        width_item->setText(QString::number(image.width()));
+        width_item->setText(QString::number(image_size.width()));
         rowItems << width_item;
         // Height
         NumericItem *height_item = new NumericItem();
-        height_item->setText(QString::number(image.height()));
+        height_item->setText(QString::number(image_size.height()));
         rowItems << height_item;
         // Pixels
         NumericItem *pixel_item = new NumericItem();
-        pixel_item->setText(QString::number(image.width() * image.height()));
+        pixel_item->setText(QString::number(image_size.width() * image_size.height()));
         rowItems << pixel_item;
         // Color
         QStandardItem *color_item = new QStandardItem();
-        color_item->setText(image.allGray() ? "Grayscale" : "Color");
+        if (image_info.grayscale_known) {
+            color_item->setText(image_info.grayscale ? "Grayscale" : "Color");
+        } else {
+            m_PendingColorItems[path] = color_item;
+        }
         rowItems << color_item;
 
         // Thumbnail
+        QString thumbnail_path;
+        if (m_ThumbnailSize || !image_info.grayscale_known) {
+            // Also generates the color information if needed
+            int thumbnail_size = m_ThumbnailSize ? m_ThumbnailSize : THUMBNAIL_SIZE;
+            thumbnail_path = ImageInfoCache::instance()->GetThumbnailPath(path, thumbnail_size);
+        }
+
         if (m_ThumbnailSize) {
-            QPixmap pixmap(resource->GetFullPath());
+            QStandardItem *icon_item = new QStandardItem();
 
-            if (pixmap.height() > m_ThumbnailSize || pixmap.width() > m_ThumbnailSize) {
-                pixmap = pixmap.scaled(QSize(m_ThumbnailSize, m_ThumbnailSize), Qt::KeepAspectRatio);
+            if (!thumbnail_path.isEmpty()) {
+                icon_item->setIcon(QIcon(QPixmap(thumbnail_path)));
+            } else {
+                m_PendingThumbnailItems[path] = icon_item;
             }
 
-            QStandardItem *icon_item = new QStandardItem();
-            icon_item->setIcon(QIcon(pixmap));
             rowItems << icon_item;
         }
 
@@ -238,6 +254,25 @@ void ImageFilesWidget::DecreaseThumbnailSize()
     WriteSettings();
 }
 
+void ImageFilesWidget::ThumbnailReady(const QString &path, int thumbnail_size)
+{
+    if (m_PendingColorItems.contains(path)) {
+        ImageInfoCache::ImageInfo image_info = ImageInfoCache::instance()->GetImageInfo(path);
+
+        if (image_info.grayscale_known) {
+            m_PendingColorItems.take(path)->setText(image_info.grayscale ? "Grayscale" : "Color");
+        }
+    }
+
+    if (thumbnail_size == m_ThumbnailSize && m_PendingThumbnailItems.contains(path)) {
+        QString thumbnail_path = ImageInfoCache::instance()->GetThumbnailPath(path, thumbnail_size);
+
+        if (!thumbnail_path.isEmpty()) {
+            m_PendingThumbnailItems.take(path)->setIcon(QIcon(QPixmap(thumbnail_path)));
+        }
+    }
+}
+
 void ImageFilesWidget::FilterEditTextChangedSlot(const QString &text)
 {
     const QString lowercaseText = text.toLower();
@@ -445,6 +480,8 @@ void ImageFilesWidget::connectSignalsSlots()
     connect(ui.fileTree,  SIGNAL(customContextMenuRequested(const QPoint &)),
             this,         SLOT(OpenContextMenu(const QPoint &)));
     connect(m_Delete,     SIGNAL(triggered()), this, SLOT(Delete()));
+    connect(ImageInfoCache::instance(), SIGNAL(ThumbnailReady(const QString &, int)),
+            this,                       SLOT(ThumbnailReady(const QString &, int)));
     connect(ui.buttonBox->button(QDialogButtonBox::Close), SIGNAL(clicked()), this, SIGNAL(CloseDialog()));
     connect(ui.buttonBox->button(QDialogButtonBox::Save), SIGNAL(clicked()), this, SLOT(Save()));
 }
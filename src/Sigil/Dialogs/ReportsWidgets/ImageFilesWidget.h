@@ -67,6 +67,8 @@ private slots:
     void IncreaseThumbnailSize();
     void DecreaseThumbnailSize();
 
+    void ThumbnailReady(const QString &path, int thumbnail_size);
+
     void Delete();
     void DoubleClick();
 
@@ -89,6 +91,10 @@ private:
 
     int m_ThumbnailSize;
 
+    // Items waiting for a thumbnail from ImageInfoCache, keyed by image path
+    QHash<QString, QStandardItem *> m_PendingThumbnailItems;
+    QHash<QString, QStandardItem *> m_PendingColorItems;
+
     QMenu *m_ContextMenu;
 
     QAction *m_Delete;
@@ -28,6 +28,7 @@
 #include <QtWidgets/QPushButton>
 
 #include "sigil_exception.h"
+#include "BookManipulation/BookReports.h"
 #include "BookManipulation/FolderKeeper.h"
 #include "BookManipulation/XhtmlDoc.h"
 #include "Dialogs/ReportsWidgets/LinksWidget.h"
@@ -80,8 +81,13 @@ void LinksWidget::SetupTable(int sort_column, Qt::SortOrder sort_order)
         tr("Report shows all source and target links using the anchor tag \"a\".")
     );
 
-    QHash<QString, QList<XhtmlDoc::XMLElement>> links = m_Book->GetLinkElements();
-    QHash<QString, QStringList> all_ids = m_Book->GetIdsInHTMLFiles();
+    QHash<QString, BookReports::HTMLFileData> html_file_data = BookReports::GetHTMLFileData(m_Book);
+    QHash<QString, QList<XhtmlDoc::XMLElement>> links;
+    QHash<QString, QStringList> all_ids;
+    foreach(BookReports::HTMLFileData file_data, html_file_data) {
+        links[file_data.filename] = file_data.links;
+        all_ids[file_data.filename] = file_data.ids;
+    }
     QStringList html_filenames;
     foreach(Resource *resource, m_HTMLResources) {
         html_filenames.append(resource->Filename());
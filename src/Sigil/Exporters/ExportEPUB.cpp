@@ -85,6 +85,13 @@ ExportEPUB::~ExportEPUB()
 // Writes the book to the path
 // specified in the constructor
 void ExportEPUB::WriteBook()
+{
+    SnapshotBook();
+    WriteSnapshot();
+}
+
+
+void ExportEPUB::SnapshotBook()
 {
     // Obfuscating fonts needs an UUID ident
     if (m_Book->HasObfuscatedFonts()) {
@@ -94,14 +101,21 @@ void ExportEPUB::WriteBook()
     m_Book->GetOPF().AddSigilVersionMeta();
     m_Book->GetOPF().AddModificationDateMeta();
     m_Book->SaveAllResourcesToDisk();
-    TempFolder tempfolder;
-    CreatePublication(tempfolder.GetPath());
+    m_Snapshot.reset(new TempFolder());
+    CreatePublication(m_Snapshot->GetPath());
 
+    // This reads the font resources, so it can't wait for the worker thread
     if (m_Book->HasObfuscatedFonts()) {
-        ObfuscateFonts(tempfolder.GetPath());
+        ObfuscateFonts(m_Snapshot->GetPath());
     }
+}
+
 
-    SaveFolderAsEpubToLocation(tempfolder.GetPath(), m_FullFilePath);
+void ExportEPUB::WriteSnapshot()
+{
+    Q_ASSERT(m_Snapshot);
+    SaveFolderAsEpubToLocation(m_Snapshot->GetPath(), m_FullFilePath);
+    m_Snapshot.reset();
 }
 
 
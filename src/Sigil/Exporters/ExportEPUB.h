@@ -23,9 +23,12 @@
 #ifndef EXPORTEPUB_H
 #define EXPORTEPUB_H
 
+#include <QtCore/QScopedPointer>
+
 #include "BookManipulation/FolderKeeper.h"
 #include "BookManipulation/Book.h"
 #include "Exporters/Exporter.h"
+#include "Misc/TempFolder.h"
 
 class ExportEPUB : public Exporter
 {
@@ -44,6 +47,16 @@ public:
     // specified in the constructor
     virtual void WriteBook();
 
+    // Saves the book's resources and copies them to a
+    // temporary folder; must be called on the GUI thread,
+    // the book can be edited again once this returns
+    void SnapshotBook();
+
+    // Compresses the snapshot taken by SnapshotBook()
+    // into the EPUB; only touches the snapshot folder,
+    // so it can run on a worker thread
+    void WriteSnapshot();
+
 private:
 
     // Creates the publication from the Book
@@ -75,6 +88,9 @@ private:
     // The book being exported
     QSharedPointer<Book> m_Book;
 
+    // The copy of the book folder being compressed
+    QScopedPointer<TempFolder> m_Snapshot;
+
 };
 
 #endif // EXPORTEPUB_H
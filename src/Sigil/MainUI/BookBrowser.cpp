@@ -21,12 +21,14 @@
 
 #include <QtCore/QFileInfo>
 #include <QtCore/QSignalMapper>
+#include <QtGui/QCursor>
 #include <QtWidgets/QFileDialog>
 #include <QtWidgets/QMenu>
 #include <QtWidgets/QMessageBox>
 #include <QtWidgets/QTreeView>
 #include <QtWidgets/QProgressDialog>
 #include <QtWidgets/QScrollBar>
+#include <QtWidgets/QToolTip>
 
 #include "BookManipulation/Book.h"
 #include "BookManipulation/FolderKeeper.h"
@@ -259,6 +261,23 @@ void BookBrowser::EmitResourceActivated(const QModelIndex &index)
 }
 
 
+void BookBrowser::RefreshToolTip(const QModelIndex &index)
+{
+    if (!QToolTip::isVisible()) {
+        return;
+    }
+
+    QPoint position = m_TreeView.viewport()->mapFromGlobal(QCursor::pos());
+
+    if (m_TreeView.indexAt(position) != index) {
+        return;
+    }
+
+    QToolTip::showText(QCursor::pos(), index.data(Qt::ToolTipRole).toString(),
+                       m_TreeView.viewport(), m_TreeView.visualRect(index));
+}
+
+
 void BookBrowser::OpenContextMenu(const QPoint &point)
 {
     if (!SuccessfullySetupContextMenu(point)) {
@@ -1668,6 +1687,8 @@ void BookBrowser::ConnectSignalsToSlots()
             this,        SLOT(OpenContextMenu(const QPoint &)));
     connect(&m_OPFModel, SIGNAL(ResourceRenamed()),
             this,        SLOT(SelectRenamedResource()));
+    connect(&m_OPFModel, SIGNAL(ToolTipChanged(const QModelIndex &)),
+            this,        SLOT(RefreshToolTip(const QModelIndex &)));
     connect(m_SelectAll,               SIGNAL(triggered()), this, SLOT(SelectAll()));
     connect(m_CopyHTML,                SIGNAL(triggered()), this, SLOT(CopyHTML()));
     connect(m_CopyCSS,                 SIGNAL(triggered()), this, SLOT(CopyCSS()));
@@ -234,6 +234,13 @@ private slots:
      */
     void EmitResourceActivated(const QModelIndex &index);
 
+    /**
+     * Replaces the tooltip shown for the item with its current one.
+     *
+     * @param index The model index of the item whose tooltip changed.
+     */
+    void RefreshToolTip(const QModelIndex &index);
+
     /**
      * Opens the context menu at the requested point.
      *
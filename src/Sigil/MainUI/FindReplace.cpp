@@ -179,6 +179,7 @@ void FindReplace::ShowMessage(const QString &message)
     }
 
     ui.message->setText(new_message);
+    ui.message->setToolTip(QString());
     m_timer.start(SHOW_FIND_RESULTS_MESSAGE_DELAY_MS);
     emit ShowMessageRequest(new_message);
 }
@@ -765,6 +766,68 @@ int FindReplace::ReplaceInAllFiles()
 }
 
 
+int FindReplace::ReplaceSearchesInAllFiles(const QList<SearchEditorModel::searchEntry *> &search_entries, QStringList &search_counts)
+{
+    m_MainWindow.GetCurrentContentTab().SaveTabContent();
+    clearMessage();
+    SetCodeViewIfNeeded(true);
+    QStringList names;
+    QStringList search_regexes;
+    QStringList replacements;
+    // LoadSearch() puts each search in the fields GetSearchRegex() reads
+    foreach(SearchEditorModel::searchEntry * search_entry, search_entries) {
+        LoadSearch(search_entry);
+
+        if (!IsValidFindText()) {
+            continue;
+        }
+
+        names.append(search_entry->name.isEmpty() ? search_entry->find : search_entry->name);
+        search_regexes.append(GetSearchRegex());
+        replacements.append(ui.cbReplace->lineEdit()->text());
+    }
+
+    if (search_regexes.isEmpty()) {
+        return 0;
+    }
+
+    // When not wrapping the current file is replaced separately
+    // since only the text before or after the cursor is replaced
+    QList<Resource *> html_files = GetHTMLFiles();
+
+    if (!m_OptionWrap) {
+        html_files.removeOne(GetCurrentResource());
+    }
+
+    QList<int> counts = SearchOperations::ReplaceSearchesInFiles(search_regexes, replacements, html_files, SearchOperations::CodeViewSearch);
+
+    if (!m_OptionWrap) {
+        Searchable *searchable = GetAvailableSearchable();
+
+        if (searchable) {
+            for (int i = 0; i < search_regexes.count(); ++i) {
+                counts[i] += searchable->ReplaceAll(search_regexes.at(i), replacements.at(i), GetSearchableDirection(), m_OptionWrap);
+            }
+        }
+    }
+
+    int count = 0;
+
+    for (int i = 0; i < counts.count(); ++i) {
+        count += counts.at(i);
+        search_counts.append(QString("%1: %2").arg(names.at(i).left(50)).arg(counts.at(i)));
+    }
+
+    if (count > 0) {
+        // Signal that the contents have changed and update the view
+        m_MainWindow.GetCurrentBook()->SetModified(true);
+        m_MainWindow.GetCurrentContentTab().ContentChangedExternally();
+    }
+
+    return count;
+}
+
+
 bool FindReplace::FindInAllFiles(Searchable::Direction direction)
 {
     Searchable *searchable = 0;
@@ -826,35 +889,33 @@ HTMLResource *FindReplace::GetNextContainingHTMLResource(Searchable::Direction d
         return NULL;
     }
 
+    int count = resources.count();
+    int start = 0;
+
     if (!starting_html_resource || (GetLookWhere() == FindReplace::LookWhere_SelectedHTMLFiles && !IsCurrentFileInHTMLSelection())) {
         if (direction == Searchable::Direction_Up) {
-            starting_html_resource = qobject_cast<HTMLResource *>(resources.first());
+            start = 0;
         } else {
-            starting_html_resource = qobject_cast<HTMLResource *>(resources.last());
+            start = count - 1;
         }
+    } else {
+        start = qMax(resources.indexOf(starting_html_resource), 0);
     }
 
-    HTMLResource *next_html_resource = starting_html_resource;
-    bool passed_starting_html_resource = false;
+    QBitArray contains_match = GetFilesContainingMatch(resources);
+    int step = direction == Searchable::Direction_Up ? -1 : 1;
 
-    while (!passed_starting_html_resource || (next_html_resource != starting_html_resource)) {
-        next_html_resource = GetNextHTMLResource(next_html_resource, direction);
+    // Visit every other file in reading order, wrapping around to
+    // the starting file last.
+    for (int i = 1; i <= count; ++i) {
+        int next = ((start + step * i) % count + count) % count;
 
-        if (next_html_resource == starting_html_resource) {
-            if (!m_OptionWrap) {
-                return NULL;
-            }
-            passed_starting_html_resource = true ;
+        if (next == start && !m_OptionWrap) {
+            return NULL;
         }
 
-        if (next_html_resource) {
-            if (ResourceContainsCurrentRegex(next_html_resource)) {
-                return next_html_resource;
-            }
-
-            // else continue
-        } else {
-            return NULL;
+        if (contains_match.testBit(next)) {
+            return qobject_cast<HTMLResource *>(resources.at(next));
         }
     }
 
@@ -862,36 +923,54 @@ HTMLResource *FindReplace::GetNextContainingHTMLResource(Searchable::Direction d
 }
 
 
-HTMLResource *FindReplace::GetNextHTMLResource(HTMLResource *current_resource, Searchable::Direction direction)
+QBitArray FindReplace::GetFilesContainingMatch(const QList<Resource *> &resources)
 {
-    QList <Resource *> resources = GetHTMLFiles();
-    int max_reading_order       = resources.count() - 1;
-    int current_reading_order   = 0;
-    int next_reading_order      = 0;
-    // Find the current resource in the selected/all html entries
-    int i = 0;
+    // For now, this must hold
+    Q_ASSERT(GetLookWhere() == FindReplace::LookWhere_AllHTMLFiles || GetLookWhere() == FindReplace::LookWhere_SelectedHTMLFiles);
+    const QString search_regex = GetSearchRegex();
+
+    if (search_regex != m_FileMatchesRegex) {
+        m_FileMatches.clear();
+    }
+
+    // Spelling results also change with the dictionary and ignored words
+    // so they are never kept.
+    m_FileMatchesRegex = m_SpellCheck ? QString() : search_regex;
+    QList<Resource *> stale_resources;
+    QList<int> stale_versions;
     foreach(Resource * resource, resources) {
-        if (resource->Filename() == current_resource->Filename()) {
-            current_reading_order = i;
-            break;
+        TextResource *text_resource = qobject_cast<TextResource *>(resource);
+        int version = text_resource ? text_resource->GetTextVersion() : 0;
+
+        if (m_SpellCheck || !m_FileMatches.contains(resource->GetIdentifier()) ||
+            m_FileMatches.value(resource->GetIdentifier()).text_version != version) {
+            stale_resources.append(resource);
+            stale_versions.append(version);
         }
+    }
+
+    if (!stale_resources.isEmpty()) {
+        QList<bool> contains = SearchOperations::FilesContainingMatch(search_regex, stale_resources, m_SpellCheck);
 
-        i++;
+        for (int i = 0; i < stale_resources.count(); ++i) {
+            FileMatch file_match;
+            file_match.text_version = stale_versions.at(i);
+            file_match.contains = contains.at(i);
+            m_FileMatches.insert(stale_resources.at(i)->GetIdentifier(), file_match);
+        }
     }
 
-    // We wrap back (if needed)
-    if (direction == Searchable::Direction_Up) {
-        next_reading_order = current_reading_order - 1 >= 0 ? current_reading_order - 1 : max_reading_order ;
-    } else {
-        next_reading_order = current_reading_order + 1 <= max_reading_order ? current_reading_order + 1 : 0;
+    QBitArray contains_match(resources.count());
+
+    for (int i = 0; i < resources.count(); ++i) {
+        contains_match.setBit(i, m_FileMatches.value(resources.at(i)->GetIdentifier()).contains);
     }
 
-    if (next_reading_order > max_reading_order || next_reading_order < 0) {
-        return NULL;
-    } else {
-        HTMLResource &html_resource = *qobject_cast<HTMLResource *>(resources[ next_reading_order ]);
-        return &html_resource;
+    if (m_SpellCheck) {
+        m_FileMatches.clear();
     }
+
+    return contains_match;
 }
 
 
@@ -1267,10 +1346,19 @@ void FindReplace::ReplaceAllSearch(QList<SearchEditorModel::searchEntry *> searc
     SetKeyModifiers();
     m_IsSearchGroupRunning = true;
     int count = 0;
-    foreach(SearchEditorModel::searchEntry * search_entry, search_entries) {
-        LoadSearch(search_entry);
-        count += ReplaceAll();
+    QStringList search_counts;
+
+    if (!m_LookWhereCurrentFile && !m_SpellCheck && !IsMarkedText() &&
+        (GetLookWhere() == FindReplace::LookWhere_AllHTMLFiles ||
+         GetLookWhere() == FindReplace::LookWhere_SelectedHTMLFiles)) {
+        count = ReplaceSearchesInAllFiles(search_entries, search_counts);
+    } else {
+        foreach(SearchEditorModel::searchEntry * search_entry, search_entries) {
+            LoadSearch(search_entry);
+            count += ReplaceAll();
+        }
     }
+
     m_IsSearchGroupRunning = false;
 
     if (count == 0) {
@@ -1280,6 +1368,8 @@ void FindReplace::ReplaceAllSearch(QList<SearchEditorModel::searchEntry *> searc
         ShowMessage(message);
     }
 
+    // The count of each search is shown in the tooltip of the total
+    ui.message->setToolTip(search_counts.join("\n"));
     ResetKeyModifiers();
 }
 
@@ -25,6 +25,8 @@
 #ifndef FINDREPLACE_H
 #define FINDREPLACE_H
 
+#include <QtCore/QBitArray>
+#include <QtCore/QHash>
 #include <QtCore/QTimer>
 
 #include "ui_FindReplace.h"
@@ -205,11 +207,24 @@ private:
 
     int ReplaceInAllFiles();
 
+    /**
+     * Replaces every given saved search across the HTML files
+     * in one batch instead of one whole book pass per search.
+     *
+     * @param search_counts Receives the number of replacements made by each search.
+     * @return The total number of replacements made.
+     */
+    int ReplaceSearchesInAllFiles(const QList<SearchEditorModel::searchEntry *> &search_entries, QStringList &search_counts);
+
     bool FindInAllFiles(Searchable::Direction direction);
 
     HTMLResource *GetNextContainingHTMLResource(Searchable::Direction direction);
 
-    HTMLResource *GetNextHTMLResource(HTMLResource *current_resource, Searchable::Direction direction);
+    /**
+     * Returns which of the files contain a match for the current search.
+     * Results are kept per file until the search or the file changes.
+     */
+    QBitArray GetFilesContainingMatch(const QList<Resource *> &resources);
 
     Resource *GetCurrentResource();
 
@@ -217,9 +232,6 @@ private:
     void SetLookWhere(int look_where);
     void SetSearchDirection(int search_direction);
 
-    template<class T>
-    bool ResourceContainsCurrentRegex(T *resource);
-
     /**
      * Returns a list of all the strings
      * currently stored in the find combo box.
@@ -306,20 +318,17 @@ private:
     QString m_LastFindText;
 
     bool m_IsSearchGroupRunning;
-};
 
+    struct FileMatch {
+        int text_version;
+        bool contains;
+    };
+
+    // Whether each file contains m_FileMatchesRegex,
+    // keyed by resource identifier.
+    QHash<QString, FileMatch> m_FileMatches;
+    QString m_FileMatchesRegex;
+};
 
-template<class T>
-bool FindReplace::ResourceContainsCurrentRegex(T *resource)
-{
-    // For now, this must hold
-    Q_ASSERT(GetLookWhere() == FindReplace::LookWhere_AllHTMLFiles || GetLookWhere() == FindReplace::LookWhere_SelectedHTMLFiles);
-    Resource *generic_resource = resource;
-    return SearchOperations::CountInFiles(
-               GetSearchRegex(),
-               QList<Resource *>() << generic_resource,
-               SearchOperations::CodeViewSearch,
-               m_SpellCheck) > 0;
-}
 
 #endif // FINDREPLACE_H
@@ -21,15 +21,18 @@
 **
 *************************************************************************/
 
+#include <QtCore/QDir>
 #include <QtCore/QFileInfo>
 #include <QtCore/QSignalMapper>
 #include <QtCore/QThread>
 #include <QtCore/QTimer>
+#include <QtConcurrent/QtConcurrent>
 #include <QtGui/QDesktopServices>
 #include <QtGui/QImage>
 #include <QtWidgets/QFileDialog>
 #include <QtWidgets/QInputDialog>
 #include <QtWidgets/QMessageBox>
+#include <QtWidgets/QProgressBar>
 #include <QtWidgets/QProgressDialog>
 #include <QtWidgets/QToolBar>
 #include <QtWebKit/QWebSettings>
@@ -41,7 +44,9 @@
 #include <QStringList>
 #include "BookManipulation/CleanSource.h"
 #include "BookManipulation/Index.h"
+#include "BookManipulation/ResourceReachability.h"
 #include "BookManipulation/FolderKeeper.h"
+#include "BookManipulation/XhtmlDoc.h"
 #include "Dialogs/About.h"
 #include "Dialogs/ClipEditor.h"
 #include "Dialogs/ClipboardHistorySelector.h"
@@ -59,7 +64,6 @@
 #include "Dialogs/SelectId.h"
 #include "Dialogs/SelectIndexTitle.h"
 #include "Exporters/ExportEPUB.h"
-#include "Exporters/ExporterFactory.h"
 #include "Importers/ImporterFactory.h"
 #include "Importers/ImportHTML.h"
 #include "MainUI/BookBrowser.h"
@@ -73,6 +77,8 @@
 #include "Misc/KeyboardShortcutManager.h"
 #include "Misc/Plugin.h"
 #include "Misc/PluginDB.h"
+#include "Misc/RecoveryJournal.h"
+#include "Misc/SettingsSnapshot.h"
 #include "Misc/SettingsStore.h"
 #include "Misc/SleepFunctions.h"
 #include "Misc/SpellCheck.h"
@@ -82,6 +88,7 @@
 #include "ResourceObjects/HTMLResource.h"
 #include "ResourceObjects/NCXResource.h"
 #include "ResourceObjects/OPFResource.h"
+#include "ResourceObjects/TextResource.h"
 #include "sigil_constants.h"
 #include "sigil_exception.h"
 #include "SourceUpdates/LinkUpdates.h"
@@ -100,12 +107,16 @@ static const int ZOOM_SLIDER_MIN            = 0;
 static const int ZOOM_SLIDER_MAX            = 1000;
 static const int ZOOM_SLIDER_MIDDLE         = 500;
 static const int ZOOM_SLIDER_WIDTH          = 140;
+static const int SAVE_PROGRESS_WIDTH        = 100;
 static const QString DONATE_WIKI            = "http://code.google.com/p/sigil/wiki/Donate";
 static const QString SIGIL_DEV_BLOG         = "http://sigildev.blogspot.com/";
 static const QString USER_GUIDE_URL         = "http://web.sigil.googlecode.com/git/files/OEBPS/Text/introduction.html";
 static const QString FAQ_URL                = "http://web.sigil.googlecode.com/git/files/OEBPS/Text/faq.html";
 static const QString TUTORIALS_URL          = "http://web.sigil.googlecode.com/git/files/OEBPS/Text/tutorials.html";
 
+// Set once the first window has looked for crash recovery journals
+static bool s_RecoveryOffered = false;
+
 static const QString BOOK_BROWSER_NAME            = "bookbrowser";
 static const QString FIND_REPLACE_NAME            = "findreplace";
 static const QString VALIDATION_RESULTS_VIEW_NAME = "validationresultsname";
@@ -174,7 +185,14 @@ MainWindow::MainWindow(const QString &openfilepath, bool is_internal, QWidget *p
     m_menuPluginsOutput(NULL),
     m_menuPluginsEdit(NULL),
     m_menuPluginsValidation(NULL),
-    m_SaveCSS(false)
+    m_SaveCSS(false),
+    m_PreviewReloadRequired(false),
+    m_BackgroundExporter(NULL),
+    m_BackgroundSaveWatcher(*new QFutureWatcher<QString>(this)),
+    m_BackgroundSaveUpdatesFilename(false),
+    m_BackgroundSaveNotWellFormed(false),
+    m_SaveProgress(NULL),
+    m_RecoveryJournal(*new RecoveryJournal(this))
 {
     ui.setupUi(this);
 
@@ -195,6 +213,12 @@ MainWindow::MainWindow(const QString &openfilepath, bool is_internal, QWidget *p
     ChangeSignalsWhenTabChanges(NULL, &m_TabManager.GetCurrentContentTab());
     LoadInitialFile(openfilepath, is_internal);
     loadPluginsMenu();
+
+    // Only the first window looks for journals left behind by a crash
+    if (!s_RecoveryOffered) {
+        s_RecoveryOffered = true;
+        QTimer::singleShot(0, this, SLOT(OfferRecovery()));
+    }
 }
 
 MainWindow::~MainWindow()
@@ -209,6 +233,9 @@ MainWindow::~MainWindow()
         m_ViewImage->close();
         m_ViewImage = NULL;
     }
+
+    m_BackgroundSaveWatcher.waitForFinished();
+    delete m_BackgroundExporter;
 }
 
 
@@ -700,6 +727,9 @@ void MainWindow::OpenRecentFile()
 
 bool MainWindow::Save()
 {
+    // The path of a pending Save As is only set once it is written
+    WaitForBackgroundSave();
+
     if (m_CurrentFilePath.isEmpty()) {
         return SaveAs();
     } else {
@@ -724,6 +754,7 @@ bool MainWindow::SaveAs()
     }
     QString save_path       = "";
     QString default_filter  = "";
+    WaitForBackgroundSave();
 
     if (m_CurrentFilePath.isEmpty()) {
         m_CurrentFilePath = (m_CurrentFileName.isEmpty())?DEFAULT_FILENAME:m_CurrentFileName;
@@ -1336,52 +1367,7 @@ void MainWindow::DeleteUnusedMedia()
         return;
     }
 
-    QList<Resource *> resources;
-    QHash<QString, QStringList> html_files_hash = m_Book->GetHTMLFilesUsingMedia();
-
-    // Get file urls from HTML inline styles
-    QStringList style_urls = m_Book->GetStyleUrlsInHTMLFiles();
-
-    // Get files urls from CSS files
-    QList<Resource *> css_resources = m_BookBrowser->AllCSSResources();
-    foreach(Resource *resource, css_resources) {
-        CSSResource *css_resource = dynamic_cast<CSSResource *>(resource);
-        CSSInfo css_info(css_resource->GetText(), true);
-
-        style_urls.append(css_info.getAllPropertyValues(""));
-    }
-    // Get file urls from HTML CSS files
-    QList<Resource *> html_resources = GetAllHTMLResources();
-    foreach(Resource *resource, html_resources) {
-        HTMLResource *html_resource = dynamic_cast<HTMLResource *>(resource);
-        CSSInfo css_info(html_resource->GetText(), false);
-
-        style_urls.append(css_info.getAllPropertyValues(""));
-    }
-
-    style_urls.removeDuplicates();
-
-    QStringList style_url_files;
-    QRegularExpression url_file_search("url\\s*\\(\\s*['\"]([^'\"]*).*");
-    foreach (QString url, style_urls) {
-        QRegularExpressionMatch match = url_file_search.match(url);
-        if (match.hasMatch()) {
-            style_url_files.append(match.captured(1));
-        }
-    }
-
-    foreach(Resource * resource, m_BookBrowser->AllMediaResources()) {
-        QString filepath = "../" + resource->GetRelativePathToOEBPS();
-
-        // Include the file in the list to delete if it was not referenced
-        if (html_files_hash[filepath].count() == 0 && !style_url_files.contains(filepath)) {
-            // If used as cover image, consider it referenced.
-            ImageResource *image_resource = qobject_cast<ImageResource *>(resource);
-            if (!image_resource || !m_Book->GetOPF().IsCoverImage(*image_resource)) {
-                resources.append(resource);
-            }
-        }
-    }
+    QList<Resource *> resources = ResourceReachability::FindUnusedResources(m_Book, false).media;
 
     if (resources.count() > 0) {
         RemoveResources(resources);
@@ -1399,17 +1385,14 @@ void MainWindow::DeleteUnusedStyles()
         return;
     }
 
-    QList<BookReports::StyleData *> html_class_usage = BookReports::GetHTMLClassUsage(m_Book, true);
-    QList<BookReports::StyleData *> css_selector_usage = BookReports::GetCSSSelectorUsage(m_Book, html_class_usage);
-    QList<BookReports::StyleData *> css_selectors_to_delete;
-    foreach(BookReports::StyleData * selector, css_selector_usage) {
-        if (selector->html_filename.isEmpty()) {
-            css_selectors_to_delete.append(selector);
-        }
-    }
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    QList<BookReports::StyleData *> css_selectors_to_delete =
+        ResourceReachability::FindUnusedResources(m_Book).selectors;
+    QApplication::restoreOverrideCursor();
 
     if (css_selectors_to_delete.count() > 0) {
         DeleteReportsStyles(css_selectors_to_delete);
+        qDeleteAll(css_selectors_to_delete);
     } else {
         QMessageBox::information(this, tr("Sigil"), tr("There are no unused stylesheet classes to delete."));
     }
@@ -1969,6 +1952,7 @@ void MainWindow::FindWord(QString word)
     }
 
     // Search for the word.
+    const WordIndex &word_index = m_Book->GetWordIndex();
     bool done_current = false;
     foreach (Resource *resource, html_resources) {
         HTMLResource *html_resource = qobject_cast<HTMLResource *>(resource);
@@ -1987,9 +1971,13 @@ void MainWindow::FindWord(QString word)
             }
             done_current = true;
         }
-        QString text = html_resource->GetText();
-
-        int found_pos = HTMLSpellCheck::WordPosition(text, word, start_pos);
+        int found_pos = -1;
+        foreach(int offset, word_index.GetOffsets(html_resource, word)) {
+            if (offset >= start_pos) {
+                found_pos = offset;
+                break;
+            }
+        }
         if (found_pos >= 0) {
             if (resource->Filename() != current_html_filename) {
                 OpenResourceAndWaitUntilLoaded(*resource, -1, found_pos);
@@ -2010,16 +1998,7 @@ void MainWindow::UpdateWord(QString old_word, QString new_word)
     SaveTabData();
     SetViewState(MainWindow::ViewState_CodeView);
 
-    QList<HTMLResource *> html_resources;
-    QList<Resource *> resources = GetAllHTMLResources();
-    foreach(Resource * resource, resources) {
-        HTMLResource *html_resource = qobject_cast<HTMLResource *>(resource);
-        if (html_resource) {
-            html_resources.append(html_resource);
-        }
-    }
-
-    WordUpdates::UpdateWordInAllFiles(html_resources, old_word, new_word);
+    WordUpdates::UpdateWordInAllFiles(m_Book->GetWordIndex(), old_word, new_word);
     m_Book->SetModified();
     m_SpellcheckEditor->Refresh();
     ShowMessageOnStatusBar(tr("Word updated."));
@@ -2428,9 +2407,6 @@ void MainWindow::PreferencesDialog()
         m_TabManager.ReopenTabs(m_ViewState);
     } else if (preferences.isRefreshSpellingHighlightingRequired()) {
         RefreshSpellingHighlighting();
-        // Make sure menu state is set
-        SettingsStore settings;
-        ui.actionAutoSpellCheck->setChecked(settings.spellCheck());
     }
 
     if (m_SelectCharacter->isVisible()) {
@@ -2451,9 +2427,6 @@ void MainWindow::ManagePluginsDialog()
         m_TabManager.ReopenTabs(m_ViewState);
     } else if (preferences.isRefreshSpellingHighlightingRequired()) {
         RefreshSpellingHighlighting();
-        // Make sure menu state is set
-        SettingsStore settings;
-        ui.actionAutoSpellCheck->setChecked(settings.spellCheck());
     }
 
     if (m_SelectCharacter->isVisible()) {
@@ -2956,6 +2929,21 @@ void MainWindow::UpdatePreviewCSSRequest()
     UpdatePreviewRequest();
 }
 
+void MainWindow::UpdatePreviewReloadRequest()
+{
+    m_PreviewReloadRequired = true;
+    UpdatePreviewRequest();
+}
+
+void MainWindow::UpdatePreviewStylesheetRequest(const QString &path)
+{
+    if (!m_PreviewChangedStylesheets.contains(path)) {
+        m_PreviewChangedStylesheets.append(path);
+    }
+
+    UpdatePreviewRequest();
+}
+
 void MainWindow::UpdatePreview()
 {
     m_PreviewTimer.stop();
@@ -2971,6 +2959,11 @@ void MainWindow::UpdatePreview()
         if (m_SaveCSS) {
             m_SaveCSS = false;
             tab.SaveTabContent();
+            QString changed_stylesheet = tab.GetLoadedResource().GetFullPath();
+
+            if (!m_PreviewChangedStylesheets.contains(changed_stylesheet)) {
+                m_PreviewChangedStylesheets.append(changed_stylesheet);
+            }
         }
 
         html_resource = qobject_cast<HTMLResource *>(&tab.GetLoadedResource());
@@ -3003,7 +2996,25 @@ void MainWindow::UpdatePreview()
             m_PreviousHTMLText = text;
             m_PreviousHTMLLocation = location;
 
-            m_PreviewWindow->UpdatePage(html_resource->GetFullPath(), text, location);
+            // Stylesheets the page doesn't link can't change how it looks,
+            // so they don't force the page to be reloaded.
+            QStringList changed_stylesheets;
+            const QDir html_folder = QFileInfo(html_resource->GetFullPath()).dir();
+            foreach(QString href, XhtmlDoc::GetLinkedStylesheets(text)) {
+                QString path = QDir::cleanPath(html_folder.absoluteFilePath(Utility::URLDecodePath(href)));
+
+                if (m_PreviewChangedStylesheets.contains(path) && !changed_stylesheets.contains(path)) {
+                    changed_stylesheets.append(path);
+                }
+            }
+
+            // Changes to linked files are kept for the next update
+            // if this one was skipped because Preview is hidden.
+            if (m_PreviewWindow->UpdatePage(html_resource->GetFullPath(), text, location,
+                                            changed_stylesheets, m_PreviewReloadRequired)) {
+                m_PreviewChangedStylesheets.clear();
+                m_PreviewReloadRequired = false;
+            }
         }
     }
 }
@@ -3074,11 +3085,18 @@ void MainWindow::SetDefaultViewState()
 
 void MainWindow::SetAutoSpellCheck(bool new_state)
 {
-    SettingsStore settings;
-    settings.setSpellCheck(new_state);
+    SettingsSnapshot::Values values = SettingsSnapshot::instance()->values();
+    values.spell_check = new_state;
+    SettingsSnapshot::instance()->Commit(values);
     emit SettingsChanged();
 }
 
+void MainWindow::SnapshotSettingsChanged()
+{
+    // Keeps the menu in step with the Preferences dialog
+    ui.actionAutoSpellCheck->setChecked(SettingsSnapshot::instance()->spellCheck());
+}
+
 void MainWindow::ClearIgnoredWords()
 {
     QApplication::setOverrideCursor(Qt::WaitCursor);
@@ -3101,6 +3119,13 @@ void MainWindow::RefreshSpellingHighlighting()
     }
 }
 
+void MainWindow::UpdateSpellCheckActions()
+{
+    bool loaded = !SpellCheck::instance()->isLoading();
+    ui.actionSpellcheckEditor->setEnabled(loaded);
+    ui.actionSpellcheck->setEnabled(loaded);
+}
+
 void MainWindow::UpdateZoomLabel(float new_zoom_factor)
 {
     m_lbZoomLabel->setText(QString("%1% ").arg(qRound(new_zoom_factor * 100)));
@@ -3300,21 +3325,26 @@ bool MainWindow::MaybeSaveDialogSaysProceed()
                                              );
 
         if (button_pressed == QMessageBox::Save) {
-            return Save();
+            if (!Save()) {
+                return false;
+            }
         } else if (button_pressed == QMessageBox::Cancel) {
             return false;
         }
     }
 
-    return true;
+    // A save still being written has to reach the disk first
+    return WaitForBackgroundSave();
 }
 
 
 void MainWindow::SetNewBook(QSharedPointer<Book> new_book)
 {
+    WaitForBackgroundSave();
     m_TabManager.CloseOtherTabs();
     m_TabManager.CloseAllTabs(true);
     m_Book = new_book;
+    m_RecoveryJournal.SetBook(m_Book, QString());
     m_BookBrowser->SetBook(m_Book);
     m_TableOfContents->SetBook(m_Book);
     m_ValidationResultsView->SetBook(m_Book);
@@ -3409,6 +3439,7 @@ bool MainWindow::LoadFile(const QString &fullfilepath, bool is_internal)
                 // Clear the last inserted file
                 m_LastInsertedFile = "";
                 UpdateUiWithCurrentFile(fullfilepath);
+                m_RecoveryJournal.SetBookPath(fullfilepath);
             } else {
                 UpdateUiWithCurrentFile("");
                 m_Book->SetModified();
@@ -3454,6 +3485,20 @@ void MainWindow::SetValidationResults(const QList<ValidationResult> &results)
 }
 
 
+// Compresses a book snapshot into the EPUB on a worker thread;
+// returns the error, if any, since exceptions can't cross threads
+static QString WriteBookSnapshot(ExportEPUB *exporter)
+{
+    try {
+        exporter->WriteSnapshot();
+    } catch (const ExceptionBase &exception) {
+        return Utility::GetExceptionInfo(exception);
+    }
+
+    return QString();
+}
+
+
 bool MainWindow::SaveFile(const QString &fullfilepath, bool update_current_filename)
 {
     SettingsStore ss;
@@ -3464,8 +3509,6 @@ bool MainWindow::SaveFile(const QString &fullfilepath, bool update_current_filen
         SaveTabData();
         QString extension = QFileInfo(fullfilepath).suffix().toLower();
 
-        // TODO: Move to ExporterFactory and throw exception
-        // when the user tries to save an unsupported type
         if (!SUPPORTED_SAVE_TYPE.contains(extension)) {
             ShowMessageOnStatusBar();
             Utility::DisplayStdErrorDialog(
@@ -3510,7 +3553,18 @@ bool MainWindow::SaveFile(const QString &fullfilepath, bool update_current_filen
             }
         }
 
-        ExporterFactory().GetExporter(fullfilepath, m_Book).WriteBook();
+        WaitForBackgroundSave();
+        // Only the copy of the book is made here; compressing
+        // it into the EPUB happens on a worker thread
+        QScopedPointer<ExportEPUB> exporter(new ExportEPUB(fullfilepath, m_Book));
+        exporter->SnapshotBook();
+        m_BackgroundExporter = exporter.take();
+        m_BackgroundSavePath = fullfilepath;
+        m_BackgroundSaveUpdatesFilename = update_current_filename;
+        m_BackgroundSaveNotWellFormed = not_well_formed;
+        m_BackgroundSaveTextVersions = m_RecoveryJournal.GetTextVersions();
+        m_BackgroundSaveWatcher.setFuture(QtConcurrent::run(WriteBookSnapshot, m_BackgroundExporter));
+        m_SaveProgress->show();
 
         // Return the focus back to the current tab
         ContentTab &tab = GetCurrentContentTab();
@@ -3519,16 +3573,12 @@ bool MainWindow::SaveFile(const QString &fullfilepath, bool update_current_filen
             tab.setFocus();
         }
 
+        // Edits made from now on mark the book as modified again.
+        // The new path is only used once the EPUB has been written.
         if (update_current_filename) {
             m_Book->SetModified(false);
-            UpdateUiWithCurrentFile(fullfilepath);
         }
 
-        if (not_well_formed) {
-            ShowMessageOnStatusBar(tr("EPUB saved, but not all HTML files are well formed."));
-        } else {
-            ShowMessageOnStatusBar(tr("EPUB saved."));
-        }
         QApplication::restoreOverrideCursor();
     } catch (const ExceptionBase &exception) {
         ShowMessageOnStatusBar();
@@ -3541,6 +3591,135 @@ bool MainWindow::SaveFile(const QString &fullfilepath, bool update_current_filen
 }
 
 
+bool MainWindow::WaitForBackgroundSave()
+{
+    if (!m_BackgroundExporter) {
+        return true;
+    }
+
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    m_BackgroundSaveWatcher.waitForFinished();
+    QApplication::restoreOverrideCursor();
+    bool saved = m_BackgroundSaveWatcher.result().isEmpty();
+    BackgroundSaveFinished();
+    return saved;
+}
+
+
+void MainWindow::BackgroundSaveFinished()
+{
+    // Already handled by WaitForBackgroundSave()
+    if (!m_BackgroundExporter) {
+        return;
+    }
+
+    QString error = m_BackgroundSaveWatcher.result();
+    delete m_BackgroundExporter;
+    m_BackgroundExporter = NULL;
+    m_SaveProgress->hide();
+
+    if (!error.isEmpty()) {
+        ShowMessageOnStatusBar();
+
+        // The edits never made it into the file
+        if (m_BackgroundSaveUpdatesFilename) {
+            m_Book->SetModified(true);
+
+            // As with a failed Save As, forget the path it started with
+            if (m_CurrentFilePath != m_BackgroundSavePath) {
+                m_CurrentFilePath.clear();
+            }
+        }
+
+        Utility::DisplayExceptionErrorDialog(tr("Cannot save file %1: %2").arg(m_BackgroundSavePath).arg(error));
+        return;
+    }
+
+    if (m_BackgroundSaveUpdatesFilename) {
+        UpdateUiWithCurrentFile(m_BackgroundSavePath);
+        m_RecoveryJournal.SetBookPath(m_BackgroundSavePath);
+        m_RecoveryJournal.BookSaved(m_BackgroundSaveTextVersions);
+    }
+
+    if (m_BackgroundSaveNotWellFormed) {
+        ShowMessageOnStatusBar(tr("EPUB saved, but not all HTML files are well formed."));
+    } else {
+        ShowMessageOnStatusBar(tr("EPUB saved."));
+    }
+}
+
+
+void MainWindow::OfferRecovery()
+{
+    foreach(QString journal, RecoveryJournal::GetOrphanedJournals()) {
+        QString book_path = RecoveryJournal::GetJournalBookPath(journal);
+        QString book_name = book_path.isEmpty() ? tr("an unsaved book") : QDir::toNativeSeparators(book_path);
+        QMessageBox::StandardButton button_pressed;
+        button_pressed = QMessageBox::question(this,
+                                               tr("Sigil"),
+                                               tr("Sigil did not shut down properly while editing %1.\n"
+                                                  "Do you want to recover the unsaved changes?").arg(book_name),
+                                               QMessageBox::Yes | QMessageBox::No
+                                              );
+
+        if (button_pressed == QMessageBox::Yes) {
+            MainWindow *window = this;
+
+            // Don't replace a book the user is already working on
+            if (!m_CurrentFilePath.isEmpty() || isWindowModified()) {
+                window = new MainWindow();
+                window->show();
+            }
+
+            // A journal that could not be restored is offered again next time
+            if (!window->RestoreFromJournal(journal, book_path)) {
+                if (window != this) {
+                    window->close();
+                }
+
+                continue;
+            }
+        }
+
+        RecoveryJournal::RemoveJournal(journal);
+    }
+}
+
+
+bool MainWindow::RestoreFromJournal(const QString &journal, const QString &book_path)
+{
+    // If the EPUB is gone the edits are applied to a new book
+    if (!book_path.isEmpty() && QFile::exists(book_path) && !LoadFile(book_path)) {
+        return false;
+    }
+
+    QHash<QString, QString> texts = RecoveryJournal::ReadJournal(journal);
+    int restored = 0;
+    foreach(Resource * resource, m_Book->GetFolderKeeper().GetResourceList()) {
+        TextResource *text_resource = dynamic_cast<TextResource *>(resource);
+
+        if (text_resource && texts.contains(resource->GetRelativePath())) {
+            text_resource->InitialLoad();
+            text_resource->SetText(texts.take(resource->GetRelativePath()));
+            restored++;
+        }
+    }
+    m_Book->SetModified(true);
+    m_BookBrowser->Refresh();
+    ResourcesAddedOrDeleted();
+
+    if (!texts.isEmpty()) {
+        QStringList missing = texts.keys();
+        missing.sort();
+        Utility::DisplayStdErrorDialog(tr("Some files could not be recovered because they "
+                                          "are not part of the saved book."), missing.join("\n"));
+    }
+
+    ShowMessageOnStatusBar(tr("Recovered changes to %n file(s).", "", restored));
+    return true;
+}
+
+
 void MainWindow::ZoomByStep(bool zoom_in)
 {
     ContentTab &tab = m_TabManager.GetCurrentContentTab();
@@ -3915,6 +4094,12 @@ void MainWindow::ExtendUI()
     zoom_out->setDefaultAction(ui.actionZoomOut);
     QToolButton *zoom_in = new QToolButton(statusBar());
     zoom_in->setDefaultAction(ui.actionZoomIn);
+    // Shown while a save is being written in the background
+    m_SaveProgress = new QProgressBar(statusBar());
+    m_SaveProgress->setRange(0, 0);
+    m_SaveProgress->setFixedWidth(SAVE_PROGRESS_WIDTH);
+    m_SaveProgress->hide();
+    statusBar()->addPermanentWidget(m_SaveProgress);
     m_lbZoomLabel = new QLabel(QString("100% "), statusBar());
     statusBar()->addPermanentWidget(m_lbZoomLabel);
     statusBar()->addPermanentWidget(zoom_out);
@@ -4308,6 +4493,7 @@ void MainWindow::LoadInitialFile(const QString &openfilepath, bool is_internal)
 void MainWindow::ConnectSignalsToSlots()
 {
     connect(m_PreviewWindow, SIGNAL(Shown()), this, SLOT(UpdatePreview()));
+    connect(&m_BackgroundSaveWatcher, SIGNAL(finished()), this, SLOT(BackgroundSaveFinished()));
     connect(m_PreviewWindow, SIGNAL(GoToPreviewLocationRequest()), this, SLOT(GoToPreviewLocation()));
     connect(m_PreviewWindow, SIGNAL(ZoomFactorChanged(float)),     this, SLOT(UpdateZoomLabel(float)));
     connect(m_PreviewWindow, SIGNAL(ZoomFactorChanged(float)),     this, SLOT(UpdateZoomSlider(float)));
@@ -4374,8 +4560,14 @@ void MainWindow::ConnectSignalsToSlots()
     connect(ui.actionValidateStylesheetsWithW3C,  SIGNAL(triggered()), this, SLOT(ValidateStylesheetsWithW3C()));
     connect(ui.actionSpellcheckEditor,   SIGNAL(triggered()), this, SLOT(SpellcheckEditorDialog()));
     connect(ui.actionAutoSpellCheck, SIGNAL(triggered(bool)), this, SLOT(SetAutoSpellCheck(bool)));
+    connect(SettingsSnapshot::instance(), SIGNAL(SettingsChanged()), this, SLOT(SnapshotSettingsChanged()));
     connect(ui.actionSpellcheck,    SIGNAL(triggered()), m_FindReplace, SLOT(FindMisspelledWord()));
     connect(ui.actionClearIgnoredWords, SIGNAL(triggered()), this, SLOT(ClearIgnoredWords()));
+    SpellCheck *sc = SpellCheck::instance();
+    connect(sc, SIGNAL(dictionaryLoading()), this, SLOT(UpdateSpellCheckActions()));
+    connect(sc, SIGNAL(dictionaryLoaded()), this, SLOT(UpdateSpellCheckActions()));
+    connect(sc, SIGNAL(dictionaryLoaded()), this, SLOT(RefreshSpellingHighlighting()));
+    UpdateSpellCheckActions();
     connect(ui.actionGenerateTOC,   SIGNAL(triggered()), this, SLOT(GenerateToc()));
     connect(ui.actionEditTOC,       SIGNAL(triggered()), this, SLOT(EditTOCDialog()));
     connect(ui.actionCreateHTMLTOC, SIGNAL(triggered()), this, SLOT(CreateHTMLTOC()));
@@ -4610,6 +4802,8 @@ void MainWindow::MakeTabConnections(ContentTab *tab)
 
         connect(tab,   SIGNAL(UpdatePreview()), this, SLOT(UpdatePreviewRequest()));
         connect(tab,   SIGNAL(UpdatePreviewImmediately()), this, SLOT(UpdatePreview()));
+        connect(tab,   SIGNAL(ReloadPreview()), this, SLOT(UpdatePreviewReloadRequest()));
+        connect(tab,   SIGNAL(PreviewStylesheetChanged(const QString &)), this, SLOT(UpdatePreviewStylesheetRequest(const QString &)));
         connect(tab,   SIGNAL(InspectElement()), this, SLOT(InspectHTML()));
     }
 
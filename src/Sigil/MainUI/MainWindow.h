@@ -25,6 +25,7 @@
 #ifndef SIGIL_H
 #define SIGIL_H
 
+#include <QtCore/QFutureWatcher>
 #include <QtCore/QSharedPointer>
 #include <QtWidgets/QMainWindow>
 
@@ -52,6 +53,7 @@ const int STATUSBAR_MSG_DISPLAY_TIME = 7000;
 
 class QComboBox;
 class QLabel;
+class QProgressBar;
 class QSignalMapper;
 class QSlider;
 class QTimer;
@@ -68,6 +70,8 @@ class ClipsWindow;
 class SelectCharacter;
 class ViewImage;
 class FlowTab;
+class ExportEPUB;
+class RecoveryJournal;
 
 
 /**
@@ -256,6 +260,16 @@ private slots:
 
     void AddCover();
 
+    /**
+     * Reports the outcome of a save written on a worker thread.
+     */
+    void BackgroundSaveFinished();
+
+    /**
+     * Offers to restore the journals left behind by a crashed session.
+     */
+    void OfferRecovery();
+
     /**
      * Implements New action functionality.
      */
@@ -505,6 +519,8 @@ private slots:
 
     void UpdatePreviewRequest();
     void UpdatePreviewCSSRequest();
+    void UpdatePreviewReloadRequest();
+    void UpdatePreviewStylesheetRequest(const QString &path);
     void UpdatePreview();
     void InspectHTML();
 
@@ -573,10 +589,20 @@ private slots:
 
     void SetAutoSpellCheck(bool new_state);
 
+    /**
+     * Updates the actions that show settings kept in the SettingsSnapshot.
+     */
+    void SnapshotSettingsChanged();
+
     void ClearIgnoredWords();
 
     void RefreshSpellingHighlighting();
 
+    /**
+     * Disables the spell check actions while a dictionary is loading.
+     */
+    void UpdateSpellCheckActions();
+
     void MergeResources(QList <Resource *> resources);
 
     void LinkStylesheetsToResources(QList <Resource *> resources);
@@ -694,6 +720,21 @@ private:
      */
     bool SaveFile(const QString &fullfilepath, bool update_current_filename = true);
 
+    /**
+     * Blocks until the save being written in the background, if any, is done.
+     *
+     * @return \c false if that save failed.
+     */
+    bool WaitForBackgroundSave();
+
+    /**
+     * Loads the book a recovery journal belongs to
+     * and applies the edits stored in the journal.
+     *
+     * @return \c false if the book could not be loaded.
+     */
+    bool RestoreFromJournal(const QString &journal, const QString &book_path);
+
     /**
      * Performs zoom operations in the views using the default
      * zoom step. Setting zoom_in to \c true zooms the views *in*,
@@ -1006,6 +1047,27 @@ private:
     QAction *m_actionManagePlugins;
     bool m_SaveCSS;
 
+    // Set when the next preview update has to reload the page
+    // even though its text may not have changed
+    bool m_PreviewReloadRequired;
+
+    // Stylesheets changed since Preview last updated its page
+    QStringList m_PreviewChangedStylesheets;
+
+    /**
+     * The save currently being compressed on a worker thread,
+     * and what to do once it is done.
+     */
+    ExportEPUB *m_BackgroundExporter;
+    QFutureWatcher<QString> &m_BackgroundSaveWatcher;
+    QString m_BackgroundSavePath;
+    bool m_BackgroundSaveUpdatesFilename;
+    bool m_BackgroundSaveNotWellFormed;
+    QHash<QString, int> m_BackgroundSaveTextVersions;
+    QProgressBar *m_SaveProgress;
+
+    RecoveryJournal &m_RecoveryJournal;
+
     /**
      * Holds all the widgets Qt Designer created for us.
      */
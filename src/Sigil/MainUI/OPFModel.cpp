@@ -21,6 +21,9 @@
 
 #include <limits>
 
+#include <QtCore/QSet>
+#include <QtCore/QTimer>
+#include <QtCore/QUrl>
 #include <QtWidgets/QApplication>
 #include <QtWidgets/QFileIconProvider>
 #include <QMessageBox>
@@ -29,6 +32,7 @@
 #include "BookManipulation/FolderKeeper.h"
 #include "MainUI/OPFModel.h"
 #include "MainUI/OPFModelItem.h"
+#include "Misc/ImageInfoCache.h"
 #include "Misc/Utility.h"
 #include "ResourceObjects/Resource.h"
 #include "ResourceObjects/HTMLResource.h"
@@ -38,6 +42,8 @@
 #include "sigil_exception.h"
 #include "SourceUpdates/UniversalUpdates.h"
 
+static const int THUMBNAIL_SIZE = 100;
+
 static const QList<QChar> FORBIDDEN_FILENAME_CHARS = QList<QChar>() << '<' << '>' << ':'
         << '"' << '/' << '\\'
         << '|' << '?' << '*';
@@ -46,6 +52,8 @@ OPFModel::OPFModel(QObject *parent)
     :
     QStandardItemModel(parent),
     m_RefreshInProgress(false),
+    m_UpdateScheduled(false),
+    m_OPFTextVersion(-1),
     m_Book(NULL),
     m_TextFolderItem(*new QStandardItem("Text")),
     m_StylesFolderItem(*new QStandardItem("Styles")),
@@ -59,6 +67,8 @@ OPFModel::OPFModel(QObject *parent)
             this, SLOT(RowsRemovedHandler(const QModelIndex &, int, int)));
     connect(this, SIGNAL(itemChanged(QStandardItem *)),
             this, SLOT(ItemChangedHandler(QStandardItem *)));
+    connect(ImageInfoCache::instance(), SIGNAL(ThumbnailReady(const QString &, int)),
+            this,                       SLOT(ThumbnailReady(const QString &, int)));
     QList<QStandardItem *> items;
     items.append(&m_TextFolderItem);
     items.append(&m_StylesFolderItem);
@@ -83,15 +93,21 @@ OPFModel::OPFModel(QObject *parent)
 
 void OPFModel::SetBook(QSharedPointer<Book> book)
 {
+    if (m_Book) {
+        disconnect(&m_Book->GetFolderKeeper(), 0, this, 0);
+        disconnect(&m_Book->GetOPF(), 0, this, 0);
+    }
+
     m_Book = book;
     connect(this, SIGNAL(BookContentModified()), m_Book.data(), SLOT(SetModified()));
-    Refresh();
-}
-
-
-void OPFModel::Refresh()
-{
+    // These can be emitted from worker threads and while the OPF is locked,
+    // so they have to be queued.
+    connect(&m_Book->GetFolderKeeper(), SIGNAL(ResourcesChanged()),
+            this, SLOT(ScheduleUpdate()), Qt::QueuedConnection);
+    connect(&m_Book->GetOPF(), SIGNAL(StructureChanged()),
+            this, SLOT(ScheduleUpdate()), Qt::QueuedConnection);
     m_RefreshInProgress = true;
+    m_OPFTextVersion = -1;
     InitializeModel();
     SortFilesByFilenames();
     SortHTMLFilesByReadingOrder();
@@ -99,6 +115,31 @@ void OPFModel::Refresh()
 }
 
 
+void OPFModel::Refresh()
+{
+    UpdateModel();
+}
+
+
+void OPFModel::ScheduleUpdate()
+{
+    if (!m_UpdateScheduled) {
+        m_UpdateScheduled = true;
+        QTimer::singleShot(0, this, SLOT(ApplyScheduledUpdate()));
+    }
+}
+
+
+void OPFModel::ApplyScheduledUpdate()
+{
+    m_UpdateScheduled = false;
+
+    if (m_Book) {
+        UpdateModel();
+    }
+}
+
+
 void OPFModel::SortHTML(QList <QModelIndex> index_list)
 {
     m_RefreshInProgress = true;
@@ -268,6 +309,50 @@ void OPFModel::sort(int column, Qt::SortOrder order)
 }
 
 
+QVariant OPFModel::data(const QModelIndex &index, int role) const
+{
+    QVariant value = QStandardItemModel::data(index, role);
+
+    if (role != Qt::ToolTipRole) {
+        return value;
+    }
+
+    QString image_path = QStandardItemModel::data(index, IMAGE_PATH_ROLE).toString();
+
+    if (image_path.isEmpty()) {
+        return value;
+    }
+
+    QString thumbnail_path = ImageInfoCache::instance()->GetThumbnailPath(image_path, THUMBNAIL_SIZE);
+
+    if (thumbnail_path.isEmpty()) {
+        return value;
+    }
+
+    return QString("<img src=\"%1\"><br>%2")
+           .arg(QUrl::fromLocalFile(thumbnail_path).toString())
+           .arg(value.toString().toHtmlEscaped());
+}
+
+
+void OPFModel::ThumbnailReady(const QString &path, int thumbnail_size)
+{
+    if (thumbnail_size != THUMBNAIL_SIZE) {
+        return;
+    }
+
+    for (int row = 0; row < m_ImagesFolderItem.rowCount(); ++row) {
+        QStandardItem *item = m_ImagesFolderItem.child(row);
+
+        if (item->data(IMAGE_PATH_ROLE).toString() == path) {
+            QModelIndex index = item->index();
+            emit dataChanged(index, index);
+            emit ToolTipChanged(index);
+        }
+    }
+}
+
+
 Qt::DropActions OPFModel::supportedDropActions() const
 {
     return Qt::MoveAction;
@@ -297,6 +382,12 @@ void OPFModel::RowsRemovedHandler(const QModelIndex &parent, int start, int end)
 void OPFModel::ItemChangedHandler(QStandardItem *item)
 {
     Q_ASSERT(item);
+
+    // Updates of the model are not renames by the user
+    if (m_RefreshInProgress) {
+        return;
+    }
+
     const QString &identifier = item->data().toString();
 
     if (!identifier.isEmpty()) {
@@ -329,9 +420,9 @@ bool OPFModel:: RenameResourceList(QList<Resource *> resources, QList<QString> n
 {
     QApplication::setOverrideCursor(Qt::WaitCursor);
     QStringList not_renamed;
-    QHash<QString, QString> update;
+    QList<Resource *> resources_to_rename;
+    QStringList filenames_to_use;
     foreach(Resource * resource, resources) {
-        const QString &old_fullpath = resource->GetFullPath();
         QString old_filename = resource->Filename();
         QString extension = old_filename.right(old_filename.length() - old_filename.lastIndexOf('.'));
 
@@ -347,19 +438,28 @@ bool OPFModel:: RenameResourceList(QList<Resource *> resources, QList<QString> n
             continue;
         }
 
-        if (!FilenameIsValid(old_filename, new_filename_with_extension)) {
+        // The files are only renamed after all the names are checked,
+        // so the names must also be unique within this rename.
+        if (filenames_to_use.contains(new_filename_with_extension) ||
+            !FilenameIsValid(old_filename, new_filename_with_extension)) {
             not_renamed.append(resource->Filename());
             continue;
         }
 
-        bool rename_success = resource->RenameTo(new_filename_with_extension);
-
-        if (!rename_success) {
+        resources_to_rename.append(resource);
+        filenames_to_use.append(new_filename_with_extension);
+    }
+    // Rename all the files first, so the OPF is only updated once
+    QHash<Resource *, QString> old_full_paths =
+        m_Book->GetFolderKeeper().RenameResources(resources_to_rename, filenames_to_use);
+    QHash<QString, QString> update;
+    foreach(Resource * resource, resources_to_rename) {
+        if (!old_full_paths.contains(resource)) {
             not_renamed.append(resource->Filename());
             continue;
         }
 
-        update[ old_fullpath ] = "../" + resource->GetRelativePathToOEBPS();
+        update[ old_full_paths.value(resource) ] = "../" + resource->GetRelativePathToOEBPS();
     }
 
     if (update.count() > 0) {
@@ -381,60 +481,173 @@ void OPFModel::InitializeModel()
 {
     Q_ASSERT(m_Book);
     ClearModel();
-    QList<Resource *> resources = m_Book->GetFolderKeeper().GetResourceList();
-    QHash <Resource *, int> reading_order_all = m_Book->GetOPF().GetReadingOrderAll(resources);
-    QHash <QString, QString> semantic_type_all = m_Book->GetOPF().GetGuideSemanticNameForPaths();
+    ReadOPFInformation();
+    foreach(Resource * resource, m_Book->GetFolderKeeper().GetResourceList()) {
+        GetFolderItem(*resource)->appendRow(CreateItem(*resource));
+    }
+}
 
-    foreach(Resource * resource, resources) {
-        AlphanumericItem *item = new AlphanumericItem(resource->Icon(), resource->Filename());
-        item->setDropEnabled(false);
-        item->setData(resource->GetIdentifier());
-        QString tooltip = resource->Filename();
-        QString path = resource->GetRelativePathToOEBPS();
 
-        if (semantic_type_all.contains(path)) {
-            tooltip += " (" + semantic_type_all[path] + ")";
-        }
-        item->setToolTip(tooltip);
+void OPFModel::UpdateModel()
+{
+    Q_ASSERT(m_Book);
+    m_RefreshInProgress = true;
+    QHash<QString, Resource *> resources;
+    foreach(Resource * resource, m_Book->GetFolderKeeper().GetResourceList()) {
+        resources[ resource->GetIdentifier() ] = resource;
+    }
+    bool opf_changed = ReadOPFInformation();
+    // Remove the items of the files that are gone
+    // and find the items of those that are still here.
+    QHash<QString, QStandardItem *> items;
+    QList<QStandardItem *> parents;
+    parents << invisibleRootItem() << &m_TextFolderItem << &m_StylesFolderItem << &m_ImagesFolderItem
+            << &m_FontsFolderItem << &m_MiscFolderItem << &m_AudioFolderItem << &m_VideoFolderItem;
+    foreach(QStandardItem * parent, parents) {
+        for (int i = parent->rowCount() - 1; i >= 0; --i) {
+            QStandardItem *item = parent->child(i);
+            const QString &identifier = item->data().toString();
 
-        if (resource->Type() == Resource::HTMLResourceType) {
-            int reading_order = -1;
-            if (reading_order_all.contains(resource)) {
-                reading_order = reading_order_all[resource];
+            // The folder items have no identifier
+            if (identifier.isEmpty()) {
+                continue;
+            }
+
+            if (resources.contains(identifier)) {
+                items[ identifier ] = item;
             } else {
-                reading_order = NO_READING_ORDER;
+                parent->removeRow(i);
+            }
+        }
+    }
+    QSet<QStandardItem *> folders_to_sort;
+    bool reading_order_changed = false;
+    foreach(Resource * resource, resources.values()) {
+        QStandardItem *item = items.value(resource->GetIdentifier());
+
+        if (!item) {
+            QStandardItem *folder = GetFolderItem(*resource);
+            folder->appendRow(CreateItem(*resource));
+            folders_to_sort.insert(folder);
+        } else if (opf_changed || item->text() != resource->Filename()) {
+            QString old_text = item->text();
+            int old_reading_order = item->data(READING_ORDER_ROLE).toInt();
+            SetItemData(*item, *resource);
+
+            if (item->text() != old_text) {
+                folders_to_sort.insert(item->parent() ? item->parent() : invisibleRootItem());
             }
 
-            item->setData(reading_order, READING_ORDER_ROLE);
-            // Remove the extension for alphanumeric sorting
-            QString name = resource->Filename().left(resource->Filename().lastIndexOf('.'));
-            item->setData(name, ALPHANUMERIC_ORDER_ROLE);
-            m_TextFolderItem.appendRow(item);
-        } else if (resource->Type() == Resource::CSSResourceType) {
-            item->setDragEnabled(false);
-            m_StylesFolderItem.appendRow(item);
-        } else if (resource->Type() == Resource::ImageResourceType ||
-                   resource->Type() == Resource::SVGResourceType
-                  ) {
-            m_ImagesFolderItem.appendRow(item);
-        } else if (resource->Type() == Resource::FontResourceType) {
-            item->setDragEnabled(false);
-            m_FontsFolderItem.appendRow(item);
-        } else if (resource->Type() == Resource::AudioResourceType) {
-            item->setDragEnabled(false);
-            m_AudioFolderItem.appendRow(item);
-        } else if (resource->Type() == Resource::VideoResourceType) {
-            item->setDragEnabled(false);
-            m_VideoFolderItem.appendRow(item);
-        } else if (resource->Type() == Resource::OPFResourceType ||
-                   resource->Type() == Resource::NCXResourceType) {
-            item->setEditable(false);
-            item->setDragEnabled(false);
-            appendRow(item);
-        } else {
-            m_MiscFolderItem.appendRow(item);
+            if (item->data(READING_ORDER_ROLE).toInt() != old_reading_order) {
+                reading_order_changed = true;
+            }
         }
     }
+
+    // The Text folder is kept in reading order, the others by filename
+    if (folders_to_sort.remove(&m_TextFolderItem) || reading_order_changed) {
+        SortHTMLFilesByReadingOrder();
+    }
+
+    foreach(QStandardItem * folder, folders_to_sort) {
+        folder->sortChildren(0);
+    }
+    m_RefreshInProgress = false;
+}
+
+
+bool OPFModel::ReadOPFInformation()
+{
+    OPFResource &opf = m_Book->GetOPF();
+    int text_version = opf.GetTextVersion();
+
+    if (text_version == m_OPFTextVersion) {
+        return false;
+    }
+
+    QList<Resource *> html_resources;
+    foreach(HTMLResource * html_resource, m_Book->GetFolderKeeper().GetResourceTypeList<HTMLResource>(false)) {
+        html_resources.append(html_resource);
+    }
+    QHash<Resource *, int> reading_orders = opf.GetReadingOrderAll(html_resources);
+    m_ReadingOrders.clear();
+    foreach(Resource * resource, html_resources) {
+        m_ReadingOrders[ resource->GetIdentifier() ] = reading_orders.value(resource, NO_READING_ORDER);
+    }
+    m_SemanticTypes = opf.GetGuideSemanticNameForPaths();
+    m_OPFTextVersion = text_version;
+    return true;
+}
+
+
+QStandardItem *OPFModel::GetFolderItem(const Resource &resource)
+{
+    Resource::ResourceType type = resource.Type();
+
+    if (type == Resource::HTMLResourceType) {
+        return &m_TextFolderItem;
+    } else if (type == Resource::CSSResourceType) {
+        return &m_StylesFolderItem;
+    } else if (type == Resource::ImageResourceType || type == Resource::SVGResourceType) {
+        return &m_ImagesFolderItem;
+    } else if (type == Resource::FontResourceType) {
+        return &m_FontsFolderItem;
+    } else if (type == Resource::AudioResourceType) {
+        return &m_AudioFolderItem;
+    } else if (type == Resource::VideoResourceType) {
+        return &m_VideoFolderItem;
+    } else if (type == Resource::OPFResourceType || type == Resource::NCXResourceType) {
+        return invisibleRootItem();
+    }
+
+    return &m_MiscFolderItem;
+}
+
+
+AlphanumericItem *OPFModel::CreateItem(Resource &resource)
+{
+    AlphanumericItem *item = new AlphanumericItem(resource.Icon(), resource.Filename());
+    item->setDropEnabled(false);
+    item->setData(resource.GetIdentifier());
+    Resource::ResourceType type = resource.Type();
+
+    if (type == Resource::CSSResourceType ||
+        type == Resource::FontResourceType ||
+        type == Resource::AudioResourceType ||
+        type == Resource::VideoResourceType) {
+        item->setDragEnabled(false);
+    } else if (type == Resource::OPFResourceType ||
+               type == Resource::NCXResourceType) {
+        item->setEditable(false);
+        item->setDragEnabled(false);
+    }
+
+    SetItemData(*item, resource);
+    return item;
+}
+
+
+void OPFModel::SetItemData(QStandardItem &item, Resource &resource)
+{
+    item.setText(resource.Filename());
+    QString tooltip = resource.Filename();
+    QString path = resource.GetRelativePathToOEBPS();
+
+    if (m_SemanticTypes.contains(path)) {
+        tooltip += " (" + m_SemanticTypes[path] + ")";
+    }
+
+    item.setToolTip(tooltip);
+
+    if (resource.Type() == Resource::HTMLResourceType) {
+        item.setData(m_ReadingOrders.value(resource.GetIdentifier(), NO_READING_ORDER), READING_ORDER_ROLE);
+        // Remove the extension for alphanumeric sorting
+        QString name = resource.Filename().left(resource.Filename().lastIndexOf('.'));
+        item.setData(name, ALPHANUMERIC_ORDER_ROLE);
+    } else if (resource.Type() == Resource::ImageResourceType ||
+               resource.Type() == Resource::SVGResourceType) {
+        item.setData(resource.GetFullPath(), IMAGE_PATH_ROLE);
+    }
 }
 
 
@@ -455,6 +668,15 @@ void OPFModel::UpdateHTMLReadingOrders()
     }
 
     m_Book->GetOPF().UpdateSpineOrder(reading_order_htmls);
+    // The model already shows the new reading order, so there is
+    // no need to read it back from the OPF.
+    m_OPFTextVersion = m_Book->GetOPF().GetTextVersion();
+    m_ReadingOrders.clear();
+
+    for (int i = 0; i < m_TextFolderItem.rowCount(); ++i) {
+        m_ReadingOrders[ m_TextFolderItem.child(i)->data().toString() ] = i;
+    }
+
     m_Book->SetModified();
 }
 
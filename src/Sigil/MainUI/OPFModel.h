@@ -23,6 +23,7 @@
 #ifndef OPFMODEL_H
 #define OPFMODEL_H
 
+#include <QtCore/QHash>
 #include <QtCore/QSharedPointer>
 #include <QtGui/QStandardItemModel>
 
@@ -59,15 +60,18 @@ public:
     OPFModel(QObject *parent = 0);
 
     /**
-     * Sets the model's book.
+     * Sets the model's book and builds the model from scratch.
+     * From then on the model follows the changes to the book.
      *
      * @param book The book whose model we will be building.
      */
     void SetBook(QSharedPointer<Book> book);
 
     /**
-     * Forces the recreation of the model
-     * from the information in the stored book.
+     * Brings the model up to date with the stored book right away.
+     * Only the differences are applied: items are added, removed and
+     * renamed in place and the HTML files are reordered, so the
+     * selection and scroll position of the views are kept.
      */
     void Refresh();
 
@@ -150,6 +154,13 @@ public:
      */
     virtual Qt::DropActions supportedDropActions() const;
 
+    /**
+     * Image tooltips show a thumbnail. The thumbnail is only
+     * requested when the tooltip is first shown, and is generated
+     * in the background, so until it is ready only the name is shown.
+     */
+    virtual QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const;
+
     /**
      * Renames the selected resource
      *
@@ -170,8 +181,27 @@ signals:
      */
     void ResourceRenamed();
 
+    /**
+     * Emitted when the thumbnail for an image's tooltip becomes available.
+     *
+     * @param index The index of the image's item.
+     */
+    void ToolTipChanged(const QModelIndex &index);
+
 private slots:
 
+    /**
+     * Notes that the book's files or OPF have changed.
+     * All the changes made before control returns to the
+     * event loop are applied together in one update.
+     */
+    void ScheduleUpdate();
+
+    /**
+     * Applies the update requested by ScheduleUpdate().
+     */
+    void ApplyScheduledUpdate();
+
     /**
      * Handler for removed rows. Used for updating HTMLResource
      * reading orders when the user reorders them in a View.
@@ -190,6 +220,15 @@ private slots:
      */
     void ItemChangedHandler(QStandardItem *item);
 
+    /**
+     * Updates the tooltips of the items showing the image,
+     * which were requested before the thumbnail existed.
+     *
+     * @param path The full path of the image.
+     * @param thumbnail_size The size of the thumbnail that is ready.
+     */
+    void ThumbnailReady(const QString &path, int thumbnail_size);
+
 
 private:
 
@@ -199,6 +238,36 @@ private:
      */
     void InitializeModel();
 
+    /**
+     * Applies the differences between the model
+     * and the stored book to the model.
+     */
+    void UpdateModel();
+
+    /**
+     * Reads the reading orders and guide semantics from the OPF,
+     * if it has changed since they were last read.
+     *
+     * @return \c true if the OPF had to be read.
+     */
+    bool ReadOPFInformation();
+
+    /**
+     * Returns the item the resource's item belongs under.
+     */
+    QStandardItem *GetFolderItem(const Resource &resource);
+
+    /**
+     * Creates the item for the resource.
+     */
+    AlphanumericItem *CreateItem(Resource &resource);
+
+    /**
+     * Sets the name, tooltip and ordering information
+     * of the resource's item.
+     */
+    void SetItemData(QStandardItem &item, Resource &resource);
+
     /**
      * Updates the reading orders of the HTMLResources
      * with their order in the model.
@@ -248,6 +317,26 @@ private:
      */
     bool m_RefreshInProgress;
 
+    /**
+     * \c true while an update is waiting for the event loop.
+     */
+    bool m_UpdateScheduled;
+
+    /**
+     * The text version of the OPF the information below was read from.
+     */
+    int m_OPFTextVersion;
+
+    /**
+     * The reading orders of the HTML files by identifier.
+     */
+    QHash<QString, int> m_ReadingOrders;
+
+    /**
+     * The guide semantic names by path relative to the OEBPS folder.
+     */
+    QHash<QString, QString> m_SemanticTypes;
+
     /**
      * The book whose model we are representing.
      */
@@ -171,23 +171,35 @@ void PreviewWindow::SetupView()
     QApplication::restoreOverrideCursor();
 }
 
-void PreviewWindow::UpdatePage(QString filename, QString text, QList<ViewEditor::ElementIndex> location)
+bool PreviewWindow::UpdatePage(QString filename, QString text, QList<ViewEditor::ElementIndex> location,
+                               const QStringList &changed_stylesheets, bool reload)
 {
     if (!m_Preview->isVisible()) {
-        return;
+        return false;
     }
 
-    m_Preview->CustomSetDocument(filename, text);
+    // Edits to the body and to linked stylesheets are applied
+    // to the page in place instead of reloading the whole document.
+    bool updated = !reload && m_Preview->PatchDocument(filename, text);
+
+    foreach(QString changed_stylesheet, changed_stylesheets) {
+        updated = updated && m_Preview->ReloadStylesheet(changed_stylesheet);
+    }
 
-    // Wait until the preview is loaded before moving cursor.
-    while (!m_Preview->IsLoadingFinished()) {
-        qApp->processEvents();
-        SleepFunctions::msleep(100);
+    if (!updated) {
+        m_Preview->CustomSetDocument(filename, text);
+
+        // Wait until the preview is loaded before moving cursor.
+        while (!m_Preview->IsLoadingFinished()) {
+            qApp->processEvents();
+            SleepFunctions::msleep(100);
+        }
     }
 
     m_Preview->StoreCaretLocationUpdate(location);
     m_Preview->ExecuteCaretUpdate();
     m_Preview->InspectElement();
+    return true;
 }
 
 QList<ViewEditor::ElementIndex> PreviewWindow::GetCaretLocation()
@@ -49,7 +49,15 @@ public:
     float GetZoomFactor();
 
 public slots:
-    void UpdatePage(QString filename, QString text, QList<ViewEditor::ElementIndex> location);
+    /**
+     * Shows the text, patching the displayed page when only its body
+     * changed. The stylesheets in changed_stylesheets are swapped into
+     * the page. Set reload when a file the page links to changed, so
+     * the page is reloaded even if the text is the same.
+     * Returns false if the page was not updated because Preview is hidden.
+     */
+    bool UpdatePage(QString filename, QString text, QList<ViewEditor::ElementIndex> location,
+                    const QStringList &changed_stylesheets = QStringList(), bool reload = false);
     void SetZoomFactor(float factor);
     void SplitterMoved(int pos, int index);
 
@@ -31,13 +31,15 @@
 #include "sigil_exception.h"
 
 const int MAX_WORD_LENGTH  = 90;
+static const QRegularExpression LANG_ATTRIBUTE("\\s(?:xml:)?lang\\s*=\\s*[\"']([^\"']*)[\"']");
 
 QList<HTMLSpellCheck::MisspelledWord> HTMLSpellCheck::GetMisspelledWords(const QString &orig_text,
         int start_offset,
         int end_offset,
         const QString &search_regex,
         bool first_only,
-        bool include_all_words)
+        bool include_all_words,
+        bool wait_for_dictionaries)
 {
     SpellCheck *sc = SpellCheck::instance();
     QString wordChars = sc->getWordChars();
@@ -45,6 +47,8 @@ QList<HTMLSpellCheck::MisspelledWord> HTMLSpellCheck::GetMisspelledWords(const Q
     bool in_invalid_word = false;
     bool in_entity = false;
     int word_start = 0;
+    int tag_start = 0;
+    QList<LanguageElement> language_elements;
     QRegularExpression search(search_regex);
     QList<HTMLSpellCheck::MisspelledWord> misspellings;
     // Make sure text has beginning/end boundary markers for easier parsing
@@ -79,7 +83,9 @@ QList<HTMLSpellCheck::MisspelledWord> HTMLSpellCheck::GetMisspelledWords(const Q
                     QString word = Utility::Substring(word_start, i, text);
 
                     if (!word.isEmpty() && word_start > start_offset && word_start <= end_offset) {
-                        if (include_all_words || !sc->spell(word)) {
+                        const QString language = language_elements.isEmpty() ? QString() : language_elements.last().language;
+
+                        if (include_all_words || !sc->spell(word, language, wait_for_dictionaries)) {
                             int cap_start = -1;
 
                             if (!search_regex.isEmpty()) {
@@ -93,6 +99,7 @@ QList<HTMLSpellCheck::MisspelledWord> HTMLSpellCheck::GetMisspelledWords(const Q
                                 // Make sure we account for the extra boundary added at the beginning
                                 misspelled_word.offset = word_start - 1;
                                 misspelled_word.length = i - word_start ;
+                                misspelled_word.language = language;
                                 misspellings.append(misspelled_word);
 
                                 if (first_only) {
@@ -126,10 +133,12 @@ QList<HTMLSpellCheck::MisspelledWord> HTMLSpellCheck::GetMisspelledWords(const Q
 
         if (c == QChar('<')) {
             in_tag = true;
+            tag_start = i;
             word_start = -1;
         }
 
         if (in_tag && c == QChar('>')) {
+            UpdateLanguage(Utility::Substring(tag_start, i + 1, text), language_elements);
             word_start = i + 1;
             in_tag = false;
         }
@@ -138,6 +147,58 @@ QList<HTMLSpellCheck::MisspelledWord> HTMLSpellCheck::GetMisspelledWords(const Q
     return misspellings;
 }
 
+void HTMLSpellCheck::UpdateLanguage(const QString &tag, QList<LanguageElement> &elements)
+{
+    // Skip comments, doctypes and processing instructions
+    if (tag.length() < 3 || tag.at(1) == QChar('!') || tag.at(1) == QChar('?')) {
+        return;
+    }
+
+    bool end_tag = tag.at(1) == QChar('/');
+    int name_start = end_tag ? 2 : 1;
+    int name_end = name_start;
+
+    while (name_end < tag.length() && !tag.at(name_end).isSpace() && tag.at(name_end) != QChar('/') && tag.at(name_end) != QChar('>')) {
+        name_end++;
+    }
+
+    QString name = tag.mid(name_start, name_end - name_start);
+
+    if (end_tag) {
+        if (!elements.isEmpty() && elements.last().name == name) {
+            if (elements.last().nesting > 0) {
+                elements.last().nesting--;
+            } else {
+                elements.removeLast();
+            }
+        }
+
+        return;
+    }
+
+    if (tag.endsWith("/>")) {
+        return;
+    }
+
+    if (tag.contains("lang")) {
+        QRegularExpressionMatch match = LANG_ATTRIBUTE.match(tag);
+
+        if (match.hasMatch()) {
+            LanguageElement element;
+            element.name = name;
+            element.nesting = 0;
+            element.language = match.captured(1);
+            elements.append(element);
+            return;
+        }
+    }
+
+    // Only elements of the same name can close the element setting the language
+    if (!elements.isEmpty() && elements.last().name == name) {
+        elements.last().nesting++;
+    }
+}
+
 bool HTMLSpellCheck::IsBoundary(QChar prev_c, QChar c, QChar next_c, const QString & wordChars)
 {
     if (c.isLetter()) {
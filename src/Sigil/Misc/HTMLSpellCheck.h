@@ -34,14 +34,22 @@ public:
         QString text;
         int offset;
         int length;
+        // The lang attribute in effect for the word, empty if none
+        QString language;
     };
 
+    /**
+     * Words in a lang attribute's language are checked once its dictionary
+     * has loaded. If wait_for_dictionaries is false they are treated as
+     * correctly spelled until then, which keeps the highlighter responsive.
+     */
     static QList<MisspelledWord> GetMisspelledWords(const QString &text,
             int start_offset,
             int end_offset,
             const QString &search_regex,
             bool first_only = false,
-            bool include_all_words = false);
+            bool include_all_words = false,
+            bool wait_for_dictionaries = true);
 
     static QList<MisspelledWord> GetMisspelledWords(const QString &text);
 
@@ -74,6 +82,19 @@ public:
 
 private:
 
+    // An open element that set the language of its content
+    struct LanguageElement {
+        QString name;
+        // Elements of the same name opened inside it
+        int nesting;
+        QString language;
+    };
+
+    /**
+     * Updates the open language elements for the tag.
+     */
+    static void UpdateLanguage(const QString &tag, QList<LanguageElement> &elements);
+
     static bool IsBoundary(QChar prev_c, QChar c, QChar next_c, const QString & wordChars);
 
 };
@@ -0,0 +1,260 @@
+/************************************************************************
+**
+**  Copyright (C) 2015  Sigil Developers
+**
+**  This file is part of Sigil.
+**
+**  Sigil is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  Sigil is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with Sigil.  If not, see <http://www.gnu.org/licenses/>.
+**
+*************************************************************************/
+
+#include <QtCore/QCryptographicHash>
+#include <QtCore/QDateTime>
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QSaveFile>
+#include <QtCore/QStandardPaths>
+#include <QtCore/QStringBuilder>
+#include <QtConcurrent/QtConcurrent>
+#include <QtGui/QImage>
+#include <QtGui/QImageReader>
+
+#include "Misc/ImageInfoCache.h"
+
+static const QString GRAYSCALE_KEY = "SigilGrayscale";
+// Large images are decoded at this size at most. The colors are judged
+// from this sample rather than from the thumbnail, so a few colored
+// pixels are less likely to be blended away.
+static const int GRAYSCALE_SAMPLE_SIZE = 512;
+// Thumbnails not read for this long are removed at startup
+static const int UNUSED_THUMBNAIL_DAYS = 30;
+
+ImageInfoCache *ImageInfoCache::m_instance = 0;
+
+ImageInfoCache *ImageInfoCache::instance()
+{
+    if (m_instance == 0) {
+        m_instance = new ImageInfoCache();
+    }
+
+    return m_instance;
+}
+
+ImageInfoCache::ImageInfoCache()
+{
+    QDir().mkpath(ThumbnailDirectory());
+    QtConcurrent::run(RemoveStaleThumbnails);
+}
+
+ImageInfoCache::ImageInfo ImageInfoCache::GetImageInfo(const QString &path)
+{
+    ImageInfo info;
+    QImageReader reader(path);
+    info.size = reader.size();
+
+    // The color information is only known once the pixels have been looked at,
+    // which happens when the thumbnail is generated.
+    QString content_key = KnownContentKey(path);
+
+    if (!content_key.isEmpty()) {
+        QString info_path = CachedThumbnailPath(content_key, 0);
+
+        if (QFile::exists(info_path)) {
+            QImageReader info_reader(info_path);
+            QString grayscale = info_reader.text(GRAYSCALE_KEY);
+
+            if (!grayscale.isEmpty()) {
+                info.grayscale_known = true;
+                info.grayscale = grayscale == "1";
+            }
+        }
+    }
+
+    return info;
+}
+
+QString ImageInfoCache::GetThumbnailPath(const QString &path, int thumbnail_size)
+{
+    // Hashing the image is left to the worker thread,
+    // which also finds thumbnails made in earlier sessions.
+    QString content_key = KnownContentKey(path);
+
+    if (!content_key.isEmpty()) {
+        QString thumbnail_path = CachedThumbnailPath(content_key, thumbnail_size);
+
+        if (QFile::exists(thumbnail_path)) {
+            return thumbnail_path;
+        }
+    }
+
+    QString key = path % "|" % QString::number(thumbnail_size);
+    {
+        QMutexLocker locker(&m_PendingMutex);
+
+        if (m_Pending.contains(key)) {
+            return QString();
+        }
+
+        m_Pending.insert(key);
+    }
+    QtConcurrent::run(this, &ImageInfoCache::GenerateThumbnail, path, thumbnail_size);
+    return QString();
+}
+
+QString ImageInfoCache::ThumbnailDirectory()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/thumbnails";
+}
+
+QString ImageInfoCache::FileStamp(const QString &path)
+{
+    QFileInfo fi(path);
+    return fi.absoluteFilePath() % "|" %
+           QString::number(fi.lastModified().toMSecsSinceEpoch()) % "|" %
+           QString::number(fi.size());
+}
+
+QString ImageInfoCache::KnownContentKey(const QString &path)
+{
+    QString stamp = FileStamp(path);
+    QMutexLocker locker(&m_ContentKeysMutex);
+    return m_ContentKeys.value(stamp);
+}
+
+QString ImageInfoCache::ContentKey(const QString &path)
+{
+    QString stamp = FileStamp(path);
+    {
+        QMutexLocker locker(&m_ContentKeysMutex);
+
+        if (m_ContentKeys.contains(stamp)) {
+            return m_ContentKeys.value(stamp);
+        }
+    }
+    QFile file(path);
+
+    if (!file.open(QIODevice::ReadOnly)) {
+        return QString();
+    }
+
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+
+    while (!file.atEnd()) {
+        hash.addData(file.read(64 * 1024));
+    }
+
+    QString content_key = QString::fromLatin1(hash.result().toHex());
+    QMutexLocker locker(&m_ContentKeysMutex);
+    m_ContentKeys.insert(stamp, content_key);
+    return content_key;
+}
+
+QString ImageInfoCache::CachedThumbnailPath(const QString &content_key, int thumbnail_size)
+{
+    // A size of 0 is the file that only records the color information
+    // and is generated along with every thumbnail.
+    return ThumbnailDirectory() % "/" % content_key % "_" % QString::number(thumbnail_size) % ".png";
+}
+
+void ImageInfoCache::GenerateThumbnail(const QString &path, int thumbnail_size)
+{
+    QString content_key = ContentKey(path);
+    bool ready = false;
+
+    if (!content_key.isEmpty()) {
+        QString thumbnail_path = CachedThumbnailPath(content_key, thumbnail_size);
+        QString info_path = CachedThumbnailPath(content_key, 0);
+        ready = QFile::exists(thumbnail_path) && QFile::exists(info_path);
+
+        if (!ready) {
+            ready = WriteThumbnail(path, thumbnail_path, info_path, thumbnail_size);
+        }
+    }
+
+    {
+        QMutexLocker locker(&m_PendingMutex);
+        m_Pending.remove(path % "|" % QString::number(thumbnail_size));
+    }
+
+    if (ready) {
+        emit ThumbnailReady(path, thumbnail_size);
+    }
+}
+
+bool ImageInfoCache::WriteThumbnail(const QString &path,
+                                    const QString &thumbnail_path,
+                                    const QString &info_path,
+                                    int thumbnail_size)
+{
+    QImageReader reader(path);
+    QSize size = reader.size();
+    int sample_size = qMax(thumbnail_size, GRAYSCALE_SAMPLE_SIZE);
+
+    // Decoding straight to a smaller size is much faster for large images
+    if (size.isValid() && (size.width() > sample_size || size.height() > sample_size)) {
+        reader.setScaledSize(size.scaled(sample_size, sample_size, Qt::KeepAspectRatio));
+    }
+
+    QImage image = reader.read();
+
+    if (image.isNull()) {
+        return false;
+    }
+
+    QString grayscale = image.allGray() ? "1" : "0";
+    QImage thumbnail = image;
+
+    if (image.width() > thumbnail_size || image.height() > thumbnail_size) {
+        thumbnail = image.scaled(thumbnail_size, thumbnail_size, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+    }
+
+    thumbnail.setText(GRAYSCALE_KEY, grayscale);
+
+    if (!SaveImage(thumbnail, thumbnail_path)) {
+        return false;
+    }
+
+    if (!QFile::exists(info_path)) {
+        QImage info(1, 1, QImage::Format_Mono);
+        info.fill(0);
+        info.setText(GRAYSCALE_KEY, grayscale);
+        SaveImage(info, info_path);
+    }
+
+    return true;
+}
+
+bool ImageInfoCache::SaveImage(const QImage &image, const QString &path)
+{
+    // Readers never see a partly written file
+    QSaveFile file(path);
+    return file.open(QIODevice::WriteOnly) && image.save(&file, "PNG") && file.commit();
+}
+
+void ImageInfoCache::RemoveStaleThumbnails()
+{
+    QDir folder(ThumbnailDirectory());
+    QDateTime cutoff = QDateTime::currentDateTime().addDays(-UNUSED_THUMBNAIL_DAYS);
+    foreach(QFileInfo file, folder.entryInfoList(QStringList() << "*.png", QDir::Files | QDir::NoDotAndDotDot)) {
+        // The content key can't be traced back to an image, so thumbnails
+        // are kept for as long as they are being read. Some file systems
+        // don't record reads, which only makes thumbnails get remade sooner.
+        QDateTime last_used = qMax(file.lastRead(), file.lastModified());
+
+        if (last_used < cutoff) {
+            folder.remove(file.fileName());
+        }
+    }
+}
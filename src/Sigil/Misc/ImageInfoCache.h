@@ -0,0 +1,135 @@
+/************************************************************************
+**
+**  Copyright (C) 2015  Sigil Developers
+**
+**  This file is part of Sigil.
+**
+**  Sigil is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  Sigil is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with Sigil.  If not, see <http://www.gnu.org/licenses/>.
+**
+*************************************************************************/
+
+#pragma once
+#ifndef IMAGEINFOCACHE_H
+#define IMAGEINFOCACHE_H
+
+#include <QtCore/QHash>
+#include <QtCore/QMutex>
+#include <QtCore/QObject>
+#include <QtCore/QSet>
+#include <QtCore/QSize>
+#include <QtCore/QString>
+
+class QImage;
+
+/**
+ * Singleton.
+ *
+ * Provides image dimensions and thumbnails without decoding
+ * full images on the GUI thread.
+ *
+ * Dimensions are read from the image header only. Thumbnails are
+ * made on a background thread and stored in a persistent cache
+ * on disk, keyed by a hash of the image's content so they are found
+ * again when the book is reopened from another temp folder. Thumbnails
+ * that have not been used for a while are removed at startup.
+ * ThumbnailReady() is emitted when a requested thumbnail becomes available.
+ */
+class ImageInfoCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct ImageInfo {
+        // The dimensions of the image, invalid if the header can't be read
+        QSize size;
+
+        // Only known once a thumbnail has been generated
+        bool grayscale_known;
+        bool grayscale;
+
+        ImageInfo() : grayscale_known(false), grayscale(false) {}
+    };
+
+    static ImageInfoCache *instance();
+
+    /**
+     * Returns the header information for the image.
+     * Never decodes the pixel data.
+     */
+    ImageInfo GetImageInfo(const QString &path);
+
+    /**
+     * Returns the path to the cached thumbnail of the image
+     * no larger than thumbnail_size in either dimension.
+     * If there is no up to date cached thumbnail an empty string
+     * is returned and the thumbnail is generated in the background.
+     */
+    QString GetThumbnailPath(const QString &path, int thumbnail_size);
+
+    /**
+     * The folder the thumbnails are stored in.
+     */
+    static QString ThumbnailDirectory();
+
+signals:
+    /**
+     * Emitted from a worker thread once a requested thumbnail is on disk.
+     */
+    void ThumbnailReady(const QString &path, int thumbnail_size);
+
+private:
+    ImageInfoCache();
+
+    /**
+     * Returns the content key of the image if it has already been
+     * computed for the file as it is now, or an empty string.
+     */
+    QString KnownContentKey(const QString &path);
+
+    /**
+     * Returns the content key of the image, reading the whole
+     * file to compute it if needed. Meant for worker threads.
+     */
+    QString ContentKey(const QString &path);
+
+    static QString FileStamp(const QString &path);
+
+    static QString CachedThumbnailPath(const QString &content_key, int thumbnail_size);
+
+    void GenerateThumbnail(const QString &path, int thumbnail_size);
+
+    static bool WriteThumbnail(const QString &path,
+                               const QString &thumbnail_path,
+                               const QString &info_path,
+                               int thumbnail_size);
+
+    static bool SaveImage(const QImage &image, const QString &path);
+
+    /**
+     * Removes the thumbnails that have not been used recently.
+     */
+    static void RemoveStaleThumbnails();
+
+    // Images currently being thumbnailed, keyed by path and size
+    QSet<QString> m_Pending;
+    QMutex m_PendingMutex;
+
+    // Content keys keyed by the file stamp of the image they were computed for
+    QHash<QString, QString> m_ContentKeys;
+    QMutex m_ContentKeysMutex;
+
+    static ImageInfoCache *m_instance;
+};
+
+#endif // IMAGEINFOCACHE_H
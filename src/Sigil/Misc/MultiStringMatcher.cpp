@@ -0,0 +1,118 @@
+/************************************************************************
+**
+**  Copyright (C) 2015  Sigil Developers
+**
+**  This file is part of Sigil.
+**
+**  Sigil is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  Sigil is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with Sigil.  If not, see <http://www.gnu.org/licenses/>.
+**
+*************************************************************************/
+
+#include <QtCore/QQueue>
+
+#include "Misc/MultiStringMatcher.h"
+
+MultiStringMatcher::MultiStringMatcher(const QStringList &needles)
+    :
+    m_CharClass(0x10000, 0),
+    m_NumClasses(1)
+{
+    foreach(QString needle, needles) {
+        foreach(QChar c, needle) {
+            if (m_CharClass[c.unicode()] == 0) {
+                m_CharClass[c.unicode()] = m_NumClasses++;
+            }
+        }
+    }
+
+    // Build the trie, -1 meaning no edge yet
+    m_Transitions.fill(-1, m_NumClasses);
+    m_Accepting.append(false);
+    foreach(QString needle, needles) {
+        if (needle.isEmpty()) {
+            continue;
+        }
+
+        int state = 0;
+        foreach(QChar c, needle) {
+            int edge = state * m_NumClasses + m_CharClass[c.unicode()];
+
+            if (m_Transitions[edge] == -1) {
+                m_Transitions[edge] = m_Accepting.count();
+                m_Transitions.insert(m_Transitions.end(), m_NumClasses, -1);
+                m_Accepting.append(false);
+            }
+
+            state = m_Transitions[edge];
+        }
+        m_Accepting[state] = true;
+    }
+
+    // Turn the trie into a full state machine by following
+    // the failure links breadth first.
+    QVector<int> failure(m_Accepting.count(), 0);
+    QQueue<int> queue;
+
+    for (int cls = 0; cls < m_NumClasses; ++cls) {
+        int &next = m_Transitions[cls];
+
+        if (next == -1) {
+            next = 0;
+        } else {
+            queue.enqueue(next);
+        }
+    }
+
+    while (!queue.isEmpty()) {
+        int state = queue.dequeue();
+        m_Accepting[state] = m_Accepting[state] || m_Accepting[failure[state]];
+
+        for (int cls = 0; cls < m_NumClasses; ++cls) {
+            int &next = m_Transitions[state * m_NumClasses + cls];
+            int fallback = m_Transitions[failure[state] * m_NumClasses + cls];
+
+            if (next == -1) {
+                next = fallback;
+            } else {
+                failure[next] = fallback;
+                queue.enqueue(next);
+            }
+        }
+    }
+}
+
+
+bool MultiStringMatcher::ContainsAny(const QString &text) const
+{
+    if (m_Accepting.count() == 1) {
+        return false;
+    }
+
+    const ushort *char_class = m_CharClass.constData();
+    const int *transitions = m_Transitions.constData();
+    const bool *accepting = m_Accepting.constData();
+    const ushort *data = text.utf16();
+    int length = text.length();
+    int state = 0;
+
+    for (int i = 0; i < length; ++i) {
+        state = transitions[state * m_NumClasses + char_class[data[i]]];
+
+        if (accepting[state]) {
+            return true;
+        }
+    }
+
+    return false;
+}
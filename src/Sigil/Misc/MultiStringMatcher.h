@@ -0,0 +1,74 @@
+/************************************************************************
+**
+**  Copyright (C) 2015  Sigil Developers
+**
+**  This file is part of Sigil.
+**
+**  Sigil is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  Sigil is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with Sigil.  If not, see <http://www.gnu.org/licenses/>.
+**
+*************************************************************************/
+
+#pragma once
+#ifndef MULTISTRINGMATCHER_H
+#define MULTISTRINGMATCHER_H
+
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+#include <QtCore/QVector>
+
+/**
+ * Finds whether any of a set of strings occurs in a text
+ * in a single pass over the text (Aho-Corasick).
+ *
+ * The matcher is immutable once built so one instance
+ * can be shared by several threads.
+ */
+class MultiStringMatcher
+{
+
+public:
+    /**
+     * Builds the matcher. Empty strings are ignored.
+     *
+     * @param needles The strings to look for. Matching is case sensitive.
+     */
+    MultiStringMatcher(const QStringList &needles);
+
+    /**
+     * Returns \c true if any of the needles occurs in the text.
+     */
+    bool ContainsAny(const QString &text) const;
+
+private:
+    /**
+     * Maps every UTF-16 code unit to its column in m_Transitions.
+     * Code units that appear in no needle share column 0.
+     */
+    QVector<ushort> m_CharClass;
+
+    int m_NumClasses;
+
+    /**
+     * The state machine, m_NumClasses entries per state.
+     * State 0 is the start state.
+     */
+    QVector<int> m_Transitions;
+
+    /**
+     * Whether reaching the state means a needle has been found.
+     */
+    QVector<bool> m_Accepting;
+};
+
+#endif // MULTISTRINGMATCHER_H
@@ -0,0 +1,287 @@
+/************************************************************************
+**
+**  Copyright (C) 2015  Sigil Developers
+**
+**  This file is part of Sigil.
+**
+**  Sigil is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  Sigil is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with Sigil.  If not, see <http://www.gnu.org/licenses/>.
+**
+*************************************************************************/
+
+#include <QtCore/QCryptographicHash>
+#include <QtCore/QDir>
+#include <QtCore/QLockFile>
+#include <QtCore/QReadLocker>
+#include <QtCore/QStandardPaths>
+#include <QtCore/QUuid>
+#include <QtConcurrent/QtConcurrent>
+
+#include "BookManipulation/Book.h"
+#include "Misc/RecoveryJournal.h"
+#include "Misc/Utility.h"
+#include "ResourceObjects/TextResource.h"
+#include "sigil_exception.h"
+
+static const QString LOCK_FILE_SUFFIX = ".lock";
+static const QString MANIFEST_FILE_NAME = "manifest.txt";
+static const int UPDATE_INTERVAL_MSECS = 60 * 1000;
+
+RecoveryJournal::RecoveryJournal(QObject *parent)
+    :
+    QObject(parent),
+    m_Folder(JournalsFolder() + "/" + QUuid::createUuid().toString().remove('{').remove('}')),
+    m_Lock(new QLockFile(LockPath(m_Folder)))
+{
+    // The lock sits next to the folder and is taken before the folder
+    // exists, so other instances never see the journal unlocked
+    if (QDir().mkpath(JournalsFolder()) && m_Lock->tryLock(0)) {
+        QDir().mkpath(m_Folder);
+    }
+
+    connect(&m_Timer, SIGNAL(timeout()), this, SLOT(Update()));
+    m_Timer.start(UPDATE_INTERVAL_MSECS);
+}
+
+
+RecoveryJournal::~RecoveryJournal()
+{
+    m_Writing.waitForFinished();
+    RemoveJournal(m_Folder);
+    delete m_Lock;
+}
+
+
+void RecoveryJournal::SetBook(QSharedPointer<Book> book, const QString &book_path)
+{
+    m_Book = book;
+    m_BookPath = book_path;
+    m_JournaledVersions = GetTextVersions();
+    ClearEntries();
+}
+
+
+void RecoveryJournal::SetBookPath(const QString &book_path)
+{
+    m_BookPath = book_path;
+}
+
+
+QHash<QString, int> RecoveryJournal::GetTextVersions() const
+{
+    QHash<QString, int> versions;
+
+    if (!m_Book) {
+        return versions;
+    }
+
+    foreach(Resource * resource, m_Book->GetFolderKeeper().GetResourceList()) {
+        TextResource *text_resource = dynamic_cast<TextResource *>(resource);
+
+        if (text_resource && text_resource->IsLoaded()) {
+            versions[resource->GetIdentifier()] = text_resource->GetTextVersion();
+        }
+    }
+    return versions;
+}
+
+
+void RecoveryJournal::BookSaved(const QHash<QString, int> &text_versions)
+{
+    m_JournaledVersions = text_versions;
+    ClearEntries();
+}
+
+
+void RecoveryJournal::Update()
+{
+    // A slow disk should not make the journal fall further behind
+    if (!m_Book || !m_Book->IsModified() || m_Writing.isRunning()) {
+        return;
+    }
+
+    QHash<QString, QString> texts;
+    foreach(Resource * resource, m_Book->GetFolderKeeper().GetResourceList()) {
+        TextResource *text_resource = dynamic_cast<TextResource *>(resource);
+
+        if (!text_resource || !text_resource->IsLoaded()) {
+            continue;
+        }
+
+        const QString &identifier = resource->GetIdentifier();
+        int version = text_resource->GetTextVersion();
+
+        if (m_JournaledVersions.contains(identifier) && m_JournaledVersions.value(identifier) == version) {
+            continue;
+        }
+
+        // The text is copied here; the worker thread never touches the resource
+        QReadLocker locker(&resource->GetLock());
+        texts[resource->GetRelativePath()] = text_resource->GetText();
+        m_JournaledVersions[identifier] = version;
+    }
+
+    if (!texts.isEmpty()) {
+        m_Writing = QtConcurrent::run(WriteEntries, m_Folder, m_BookPath, texts);
+    }
+}
+
+
+QStringList RecoveryJournal::GetOrphanedJournals()
+{
+    QStringList journals;
+    QDir folder(JournalsFolder());
+    foreach(QString name, folder.entryList(QDir::Dirs | QDir::NoDotAndDotDot)) {
+        QString journal = folder.absoluteFilePath(name);
+        QLockFile lock(LockPath(journal));
+        // Only a lock whose process has gone away counts as stale,
+        // no matter how long a running session has held it
+        lock.setStaleLockTime(0);
+
+        if (!lock.tryLock(0)) {
+            continue;
+        }
+
+        if (QFile::exists(ManifestPath(journal))) {
+            journals.append(journal);
+        } else {
+            QDir(journal).removeRecursively();
+        }
+
+        lock.unlock();
+    }
+    // Locks left behind by a session that never got to create its folder
+    foreach(QString name, folder.entryList(QStringList("*" + LOCK_FILE_SUFFIX), QDir::Files)) {
+        QString journal = folder.absoluteFilePath(name);
+        journal.chop(LOCK_FILE_SUFFIX.length());
+        QLockFile lock(LockPath(journal));
+        lock.setStaleLockTime(0);
+
+        if (!QDir(journal).exists() && lock.tryLock(0)) {
+            lock.unlock();
+        }
+    }
+    return journals;
+}
+
+
+QString RecoveryJournal::GetJournalBookPath(const QString &journal)
+{
+    try {
+        return Utility::ReadUnicodeTextFile(ManifestPath(journal)).section('\n', 0, 0);
+    } catch (CannotOpenFile) {
+        return QString();
+    }
+}
+
+
+QHash<QString, QString> RecoveryJournal::ReadJournal(const QString &journal)
+{
+    QHash<QString, QString> texts;
+
+    try {
+        QStringList lines = Utility::ReadUnicodeTextFile(ManifestPath(journal)).split('\n');
+        // The first line is the book path
+        lines.removeFirst();
+        foreach(QString line, lines) {
+            QString entry = line.section('\t', 0, 0);
+            QString relative_path = line.section('\t', 1);
+
+            if (!entry.isEmpty() && !relative_path.isEmpty()) {
+                texts[relative_path] = Utility::ReadUnicodeTextFile(journal + "/" + entry);
+            }
+        }
+    } catch (CannotOpenFile) {
+        // Whatever could be read is still worth restoring
+    }
+
+    return texts;
+}
+
+
+void RecoveryJournal::RemoveJournal(const QString &journal)
+{
+    QDir(journal).removeRecursively();
+    QFile::remove(LockPath(journal));
+}
+
+
+QString RecoveryJournal::JournalsFolder()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::DataLocation) + "/recovery";
+}
+
+
+QString RecoveryJournal::ManifestPath(const QString &journal)
+{
+    return journal + "/" + MANIFEST_FILE_NAME;
+}
+
+
+QString RecoveryJournal::LockPath(const QString &journal)
+{
+    return journal + LOCK_FILE_SUFFIX;
+}
+
+
+void RecoveryJournal::WriteEntries(const QString &journal,
+                                   const QString &book_path,
+                                   const QHash<QString, QString> &texts)
+{
+    try {
+        // Entries written by earlier updates stay listed
+        QHash<QString, QString> entries;
+
+        if (QFile::exists(ManifestPath(journal))) {
+            QStringList lines = Utility::ReadUnicodeTextFile(ManifestPath(journal)).split('\n');
+            lines.removeFirst();
+            foreach(QString line, lines) {
+                if (line.contains('\t')) {
+                    entries[line.section('\t', 1)] = line.section('\t', 0, 0);
+                }
+            }
+        }
+
+        QHashIterator<QString, QString> it(texts);
+
+        while (it.hasNext()) {
+            it.next();
+            QString entry = QCryptographicHash::hash(it.key().toUtf8(), QCryptographicHash::Md5).toHex() + ".txt";
+            Utility::WriteUnicodeTextFile(it.value(), journal + "/" + entry);
+            entries[it.key()] = entry;
+        }
+
+        // The manifest goes last so it never lists an entry that isn't complete
+        QStringList lines(book_path);
+        QHashIterator<QString, QString> entry_it(entries);
+
+        while (entry_it.hasNext()) {
+            entry_it.next();
+            lines.append(entry_it.value() + "\t" + entry_it.key());
+        }
+
+        Utility::WriteUnicodeTextFile(lines.join("\n"), ManifestPath(journal));
+    } catch (ExceptionBase &) {
+        // The journal is best effort; saving is what keeps the book safe
+    }
+}
+
+
+void RecoveryJournal::ClearEntries()
+{
+    m_Writing.waitForFinished();
+    QDir folder(m_Folder);
+    foreach(QString name, folder.entryList(QDir::Files | QDir::NoDotAndDotDot)) {
+        folder.remove(name);
+    }
+}
@@ -0,0 +1,156 @@
+/************************************************************************
+**
+**  Copyright (C) 2015  Sigil Developers
+**
+**  This file is part of Sigil.
+**
+**  Sigil is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  Sigil is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with Sigil.  If not, see <http://www.gnu.org/licenses/>.
+**
+*************************************************************************/
+
+#pragma once
+#ifndef RECOVERYJOURNAL_H
+#define RECOVERYJOURNAL_H
+
+#include <QtCore/QFuture>
+#include <QtCore/QHash>
+#include <QtCore/QObject>
+#include <QtCore/QSharedPointer>
+#include <QtCore/QStringList>
+#include <QtCore/QTimer>
+
+class Book;
+class QLockFile;
+
+/**
+ * Keeps a crash recovery journal for the book open in a main window.
+ *
+ * At regular intervals the text of every text resource that changed since
+ * the book was last saved is copied (under the resource's read lock) and
+ * written to a recovery folder on a worker thread. Only the changed resources
+ * are written each time. Together with the EPUB the book was loaded from,
+ * the journal is enough to restore the edits after a crash.
+ *
+ * The journal is removed when the window closes normally. A journal left
+ * behind by a process that is no longer running is offered for recovery
+ * on the next launch.
+ */
+class RecoveryJournal : public QObject
+{
+    Q_OBJECT
+
+public:
+    RecoveryJournal(QObject *parent = 0);
+
+    /**
+     * Waits for any pending write and removes the journal.
+     */
+    ~RecoveryJournal();
+
+    /**
+     * Starts journaling a new book. Nothing is journaled
+     * until the book is modified.
+     *
+     * @param book The book to journal.
+     * @param book_path The EPUB the book was loaded from, if any.
+     */
+    void SetBook(QSharedPointer<Book> book, const QString &book_path);
+
+    /**
+     * Sets the EPUB the book now gets restored from.
+     */
+    void SetBookPath(const QString &book_path);
+
+    /**
+     * Returns the text version of every loaded text resource,
+     * keyed by resource identifier.
+     */
+    QHash<QString, int> GetTextVersions() const;
+
+    /**
+     * Called once the book has been saved. Drops the journal,
+     * since the saved EPUB now holds the text of the given versions.
+     */
+    void BookSaved(const QHash<QString, int> &text_versions);
+
+    /**
+     * Returns the journals left behind by sessions that did not shut down.
+     */
+    static QStringList GetOrphanedJournals();
+
+    /**
+     * Returns the EPUB path stored in a journal; empty for a book never saved.
+     */
+    static QString GetJournalBookPath(const QString &journal);
+
+    /**
+     * Returns the text stored in a journal, keyed by the
+     * resource path relative to the book's main folder.
+     */
+    static QHash<QString, QString> ReadJournal(const QString &journal);
+
+    /**
+     * Deletes a journal folder from disk.
+     */
+    static void RemoveJournal(const QString &journal);
+
+public slots:
+
+    /**
+     * Writes the resources changed since the last update to the journal.
+     * Returns right away; the writing happens on a worker thread.
+     */
+    void Update();
+
+private:
+    static QString JournalsFolder();
+
+    static QString ManifestPath(const QString &journal);
+
+    /**
+     * The lock file of a journal is kept beside its folder,
+     * so it can be taken before the folder is created.
+     */
+    static QString LockPath(const QString &journal);
+
+    static void WriteEntries(const QString &journal,
+                             const QString &book_path,
+                             const QHash<QString, QString> &texts);
+
+    void ClearEntries();
+
+
+    ///////////////////////////////
+    // PRIVATE MEMBER VARIABLES
+    ///////////////////////////////
+
+    QString m_Folder;
+
+    // Held while this journal is in use so other
+    // instances don't take it for an orphaned one
+    QLockFile *m_Lock;
+
+    QSharedPointer<Book> m_Book;
+
+    QString m_BookPath;
+
+    // The text versions already in the journal or in the saved EPUB
+    QHash<QString, int> m_JournaledVersions;
+
+    QFuture<void> m_Writing;
+
+    QTimer m_Timer;
+};
+
+#endif // RECOVERYJOURNAL_H
@@ -24,6 +24,7 @@
 #include <signal.h>
 
 #include <QtCore/QtCore>
+#include <QtConcurrent/QtConcurrent>
 #include <QtWidgets/QApplication>
 #include <QtWidgets/QProgressDialog>
 
@@ -31,10 +32,10 @@
 #include "BookManipulation/XercesCppUse.h"
 #include "BookManipulation/XhtmlDoc.h"
 #include "Misc/SearchOperations.h"
-#include "Misc/SettingsStore.h"
 #include "Misc/Utility.h"
 #include "PCRE/PCRECache.h"
 #include "Misc/HTMLSpellCheck.h"
+#include "Misc/SpellCheck.h"
 #include "ResourceObjects/HTMLResource.h"
 #include "ResourceObjects/TextResource.h"
 #include "ViewEditors/Searchable.h"
@@ -84,6 +85,134 @@ int SearchOperations::ReplaceInAllFIles(const QString &search_regex,
 }
 
 
+QList<int> SearchOperations::ReplaceSearchesInFiles(const QStringList &search_regexes,
+        const QStringList &replacements,
+        QList<Resource *> resources,
+        SearchType search_type)
+{
+    QList<int> counts;
+
+    for (int i = 0; i < search_regexes.count(); ++i) {
+        counts.append(0);
+    }
+
+    // Only Code View replacements in HTML files are supported, as in ReplaceInFile()
+    if (search_type != SearchOperations::CodeViewSearch) {
+        return counts;
+    }
+
+    QList<HTMLResource *> html_resources;
+    QStringList texts;
+    foreach(Resource * resource, resources) {
+        HTMLResource *html_resource = qobject_cast<HTMLResource *>(resource);
+
+        if (html_resource) {
+            QReadLocker locker(&html_resource->GetLock());
+            html_resources.append(html_resource);
+            texts.append(html_resource->GetText());
+        }
+    }
+    QProgressDialog progress(QObject::tr("Replacing search term..."), 0, 0, texts.count(), Utility::GetMainWindow());
+    progress.setWindowModality(Qt::WindowModal);
+    progress.setMinimumDuration(PROGRESS_BAR_MINIMUM_DURATION);
+    progress.setValue(0);
+    // Compiled here rather than taken from the PCRECache so
+    // a long list of searches can't evict the ones in use
+    QList<SPCRE *> searches;
+    foreach(QString search_regex, search_regexes) {
+        searches.append(new SPCRE(search_regex));
+    }
+    // Only the replacing runs on worker threads, on copies of the text.
+    // The resources themselves are only touched here on the GUI thread.
+    QFutureWatcher<tuple<QString, QList<int>>> watcher;
+    QEventLoop loop;
+    QObject::connect(&watcher, SIGNAL(progressValueChanged(int)), &progress, SLOT(setValue(int)));
+    QObject::connect(&watcher, SIGNAL(finished()), &loop, SLOT(quit()));
+    watcher.setFuture(QtConcurrent::mapped(texts, boost::bind(ReplaceSearchesInText, _1, searches, replacements)));
+    loop.exec();
+    qDeleteAll(searches);
+
+    for (int i = 0; i < html_resources.count(); ++i) {
+        QString new_text;
+        QList<int> text_counts;
+        tie(new_text, text_counts) = watcher.resultAt(i);
+        bool changed = false;
+
+        for (int j = 0; j < text_counts.count(); ++j) {
+            counts[j] += text_counts.at(j);
+            changed = changed || text_counts.at(j) > 0;
+        }
+
+        if (changed) {
+            HTMLResource *html_resource = html_resources.at(i);
+            QWriteLocker locker(&html_resource->GetLock());
+            html_resource->SetText(new_text);
+        }
+    }
+
+    return counts;
+}
+
+
+tuple<QString, QList<int>> SearchOperations::ReplaceSearchesInText(const QString &text,
+        const QList<SPCRE *> &searches,
+        const QStringList &replacements)
+{
+    QString new_text = text;
+    QList<int> counts;
+
+    for (int i = 0; i < searches.count(); ++i) {
+        QString replaced_text;
+        int count = searches.at(i)->replaceMatches(new_text, searches.at(i)->getEveryMatchInfo(new_text), replacements.at(i), replaced_text);
+        counts.append(count);
+
+        if (count > 0) {
+            new_text = replaced_text;
+        }
+    }
+
+    return make_tuple(new_text, counts);
+}
+
+
+QList<bool> SearchOperations::FilesContainingMatch(const QString &search_regex,
+        QList<Resource *> resources,
+        bool check_spelling)
+{
+    if (check_spelling) {
+        // Spelling is checked on worker threads
+        SpellCheck::instance()->waitForDictionary();
+    }
+
+    // The PCRE cache is not thread safe
+    SPCRE spcre(search_regex);
+    return QtConcurrent::blockingMapped<QList<bool> >(resources, boost::bind(FileContainsMatch, _1, &spcre, search_regex, check_spelling));
+}
+
+
+bool SearchOperations::FileContainsMatch(Resource *resource,
+        SPCRE *spcre,
+        const QString &search_regex,
+        bool check_spelling)
+{
+    HTMLResource *html_resource = qobject_cast<HTMLResource *>(resource);
+
+    if (!html_resource) {
+        return false;
+    }
+
+    QReadLocker locker(&html_resource->GetLock());
+    const QString &text = html_resource->GetText();
+
+    if (check_spelling) {
+        return !HTMLSpellCheck::GetMisspelledWords(text, 0, text.count(), search_regex, true).isEmpty();
+    }
+
+    // Same matches as CountInFile, which keeps empty matches
+    return !spcre->getEveryMatchInfo(text).isEmpty();
+}
+
+
 int SearchOperations::CountInFile(const QString &search_regex,
                                   Resource *resource,
                                   SearchType search_type,
@@ -162,8 +291,6 @@ int SearchOperations::ReplaceHTMLInFile(const QString &search_regex,
                                         HTMLResource *html_resource,
                                         SearchType search_type)
 {
-    SettingsStore ss;
-
     if (search_type == SearchOperations::CodeViewSearch) {
         int count;
         QString new_text;
@@ -191,21 +318,10 @@ tuple<QString, int> SearchOperations::PerformGlobalReplace(const QString &text,
         const QString &search_regex,
         const QString &replacement)
 {
-    QString new_text = text;
-    int count = 0;
+    QString new_text;
     SPCRE *spcre = PCRECache::instance()->getObject(search_regex);
     QList<SPCRE::MatchInfo> match_info = spcre->getEveryMatchInfo(text);
-
-    for (int i =  match_info.count() - 1; i >= 0; i--) {
-        QString match_segement = Utility::Substring(match_info.at(i).offset.first, match_info.at(i).offset.second, new_text);
-        QString replacement_text;
-
-        if (spcre->replaceText(match_segement, match_info.at(i).capture_groups_offsets, replacement, replacement_text)) {
-            new_text.replace(match_info.at(i).offset.first, match_info.at(i).offset.second - match_info.at(i).offset.first, replacement_text);
-            count++;
-        }
-    }
-
+    int count = spcre->replaceMatches(text, match_info, replacement, new_text);
     return make_tuple(new_text, count);
 }
 
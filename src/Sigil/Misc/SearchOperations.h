@@ -25,7 +25,10 @@
 
 #include <boost/tuple/tuple.hpp>
 
+#include <QtCore/QStringList>
+
 class Resource;
+class SPCRE;
 class TextResource;
 class HTMLResource;
 
@@ -58,8 +61,43 @@ public:
                                  QList<Resource *> resources,
                                  SearchType search_type);
 
+    /**
+     * Runs a list of searches one after another over every file.
+     * Each file is read once, all the searches are applied to its text
+     * in order, and it is written back once. The replacing is done on
+     * copies of the texts in parallel; the files are updated afterwards
+     * on the calling thread, which must be the GUI thread. The result is
+     * the same as running each search over all the files before starting
+     * the next one.
+     *
+     * @param search_regexes The regexes to match with, in order.
+     * @param replacements The replacement for each regex.
+     * @return The number of replacements made by each search.
+     */
+    static QList<int> ReplaceSearchesInFiles(const QStringList &search_regexes,
+                                             const QStringList &replacements,
+                                             QList<Resource *> resources,
+                                             SearchType search_type);
+
+    /**
+     * Returns whether each file contains a match.
+     * The files are checked in parallel and each check
+     * stops at the first match.
+     *
+     * @param search_regex The regex to match with.
+     * @return For each of the resources, true if it contains a match.
+     */
+    static QList<bool> FilesContainingMatch(const QString &search_regex,
+                                            QList<Resource *> resources,
+                                            bool check_spelling = false);
+
 private:
 
+    static bool FileContainsMatch(Resource *resource,
+                                  SPCRE *spcre,
+                                  const QString &search_regex,
+                                  bool check_spelling);
+
     static int CountInFile(const QString &search_regex,
                            Resource *resource,
                            SearchType search_type,
@@ -75,6 +113,10 @@ private:
     static int CountInTextFile(const QString &search_regex,
                                TextResource *text_resource);
 
+    static tuple<QString, QList<int>> ReplaceSearchesInText(const QString &text,
+            const QList<SPCRE *> &searches,
+            const QStringList &replacements);
+
     static int ReplaceInFile(const QString &search_regex,
                              const QString &replacement,
                              Resource *resource,
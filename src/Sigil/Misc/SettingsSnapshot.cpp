@@ -0,0 +1,210 @@
+/************************************************************************
+**
+**  Copyright (C) 2015  Sigil Developers
+**
+**  This file is part of Sigil.
+**
+**  Sigil is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  Sigil is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with Sigil.  If not, see <http://www.gnu.org/licenses/>.
+**
+*************************************************************************/
+
+#include "Misc/SettingsSnapshot.h"
+
+SettingsSnapshot *SettingsSnapshot::m_instance = 0;
+
+SettingsSnapshot *SettingsSnapshot::instance()
+{
+    if (m_instance == 0) {
+        m_instance = new SettingsSnapshot();
+    }
+
+    return m_instance;
+}
+
+
+SettingsSnapshot::SettingsSnapshot()
+    :
+    m_Committing(false)
+{
+    Reload();
+}
+
+
+SettingsSnapshot::Values SettingsSnapshot::values() const
+{
+    return *Current();
+}
+
+
+SettingsStore::CleanLevel SettingsSnapshot::cleanLevel() const
+{
+    return Current()->clean_level;
+}
+
+
+int SettingsSnapshot::cleanOn() const
+{
+    return Current()->clean_on;
+}
+
+
+bool SettingsSnapshot::spellCheck() const
+{
+    return Current()->spell_check;
+}
+
+
+QString SettingsSnapshot::dictionary() const
+{
+    return Current()->dictionary;
+}
+
+
+QString SettingsSnapshot::defaultUserDictionary() const
+{
+    return Current()->default_user_dictionary;
+}
+
+
+QStringList SettingsSnapshot::enabledUserDictionaries() const
+{
+    return Current()->enabled_user_dictionaries;
+}
+
+
+QList<std::pair <ushort, QString>> SettingsSnapshot::preserveEntityCodeNames() const
+{
+    return Current()->preserve_entity_code_names;
+}
+
+
+float SettingsSnapshot::zoomImage() const
+{
+    return Current()->zoom_image;
+}
+
+
+float SettingsSnapshot::zoomText() const
+{
+    return Current()->zoom_text;
+}
+
+
+float SettingsSnapshot::zoomWeb() const
+{
+    return Current()->zoom_web;
+}
+
+
+float SettingsSnapshot::zoomPreview() const
+{
+    return Current()->zoom_preview;
+}
+
+
+void SettingsSnapshot::Commit(const Values &values)
+{
+    QSharedPointer<const Values> current = Current();
+    m_Committing = true;
+    {
+        SettingsStore settings;
+
+        if (values.clean_level != current->clean_level) {
+            settings.setCleanLevel(values.clean_level);
+        }
+
+        if (values.clean_on != current->clean_on) {
+            settings.setCleanOn(values.clean_on);
+        }
+
+        if (values.spell_check != current->spell_check) {
+            settings.setSpellCheck(values.spell_check);
+        }
+
+        if (values.dictionary != current->dictionary) {
+            settings.setDictionary(values.dictionary);
+        }
+
+        if (values.default_user_dictionary != current->default_user_dictionary) {
+            settings.setDefaultUserDictionary(values.default_user_dictionary);
+        }
+
+        if (values.enabled_user_dictionaries != current->enabled_user_dictionaries) {
+            settings.setEnabledUserDictionaries(values.enabled_user_dictionaries);
+        }
+
+        if (values.preserve_entity_code_names != current->preserve_entity_code_names) {
+            settings.setPreserveEntityCodeNames(values.preserve_entity_code_names);
+        }
+
+        if (values.zoom_image != current->zoom_image) {
+            settings.setZoomImage(values.zoom_image);
+        }
+
+        if (values.zoom_text != current->zoom_text) {
+            settings.setZoomText(values.zoom_text);
+        }
+
+        if (values.zoom_web != current->zoom_web) {
+            settings.setZoomWeb(values.zoom_web);
+        }
+
+        if (values.zoom_preview != current->zoom_preview) {
+            settings.setZoomPreview(values.zoom_preview);
+        }
+    }
+    m_Committing = false;
+    Replace(values);
+    emit SettingsChanged();
+}
+
+
+void SettingsSnapshot::Reload()
+{
+    if (m_Committing) {
+        return;
+    }
+
+    SettingsStore settings;
+    Values values;
+    values.clean_level = settings.cleanLevel();
+    values.clean_on = settings.cleanOn();
+    values.spell_check = settings.spellCheck();
+    values.dictionary = settings.dictionary();
+    values.default_user_dictionary = settings.defaultUserDictionary();
+    values.enabled_user_dictionaries = settings.enabledUserDictionaries();
+    values.preserve_entity_code_names = settings.preserveEntityCodeNames();
+    values.zoom_image = settings.zoomImage();
+    values.zoom_text = settings.zoomText();
+    values.zoom_web = settings.zoomWeb();
+    values.zoom_preview = settings.zoomPreview();
+    Replace(values);
+}
+
+
+QSharedPointer<const SettingsSnapshot::Values> SettingsSnapshot::Current() const
+{
+    // Readers keep their own reference, so a concurrent
+    // Replace() never changes values under them.
+    QReadLocker locker(&m_Lock);
+    return m_Values;
+}
+
+
+void SettingsSnapshot::Replace(const Values &values)
+{
+    QWriteLocker locker(&m_Lock);
+    m_Values = QSharedPointer<const Values>(new Values(values));
+}
+
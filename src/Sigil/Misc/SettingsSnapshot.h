@@ -0,0 +1,123 @@
+/************************************************************************
+**
+**  Copyright (C) 2015  Sigil Developers
+**
+**  This file is part of Sigil.
+**
+**  Sigil is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  Sigil is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with Sigil.  If not, see <http://www.gnu.org/licenses/>.
+**
+*************************************************************************/
+
+#pragma once
+#ifndef SETTINGSSNAPSHOT_H
+#define SETTINGSSNAPSHOT_H
+
+#include <QtCore/QObject>
+#include <QtCore/QReadWriteLock>
+#include <QtCore/QSharedPointer>
+#include <QtCore/QStringList>
+
+#include "Misc/SettingsStore.h"
+
+/**
+ * Singleton.
+ *
+ * An in-memory copy of the settings that are read on hot paths
+ * (per file while cleaning or replacing, per block while highlighting).
+ * Reading it never touches QSettings, and it can be read from
+ * any thread.
+ *
+ * The snapshot is replaced as a whole: either by Commit(), which
+ * writes the changed values through a SettingsStore first, or by
+ * Reload() after one of its settings was changed through a
+ * SettingsStore directly.
+ *
+ * The first call to instance() must be made on the GUI thread.
+ */
+class SettingsSnapshot : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Values {
+        SettingsStore::CleanLevel clean_level;
+        int clean_on;
+        bool spell_check;
+        QString dictionary;
+        QString default_user_dictionary;
+        QStringList enabled_user_dictionaries;
+        QList<std::pair <ushort, QString>> preserve_entity_code_names;
+        float zoom_image;
+        float zoom_text;
+        float zoom_web;
+        float zoom_preview;
+    };
+
+    static SettingsSnapshot *instance();
+
+    /**
+     * Returns a copy of all the values in the snapshot.
+     */
+    Values values() const;
+
+    SettingsStore::CleanLevel cleanLevel() const;
+    int cleanOn() const;
+    bool spellCheck() const;
+    QString dictionary() const;
+    QString defaultUserDictionary() const;
+    QStringList enabledUserDictionaries() const;
+    QList<std::pair <ushort, QString>> preserveEntityCodeNames() const;
+    float zoomImage() const;
+    float zoomText() const;
+    float zoomWeb() const;
+    float zoomPreview() const;
+
+    /**
+     * Writes the values that differ from the snapshot to the
+     * settings file, makes them current and emits SettingsChanged().
+     * Must be called from the GUI thread.
+     */
+    void Commit(const Values &values);
+
+    /**
+     * Reads the values from the settings file again.
+     * Must be called from the GUI thread.
+     */
+    void Reload();
+
+signals:
+    /**
+     * Emitted after Commit() has replaced the snapshot.
+     */
+    void SettingsChanged();
+
+private:
+    SettingsSnapshot();
+
+    QSharedPointer<const Values> Current() const;
+
+    void Replace(const Values &values);
+
+    QSharedPointer<const Values> m_Values;
+
+    mutable QReadWriteLock m_Lock;
+
+    // Set while Commit() writes the settings file, so the
+    // snapshot isn't reloaded after every single value
+    bool m_Committing;
+
+    static SettingsSnapshot *m_instance;
+};
+
+#endif // SETTINGSSNAPSHOT_H
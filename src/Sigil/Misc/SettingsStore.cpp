@@ -23,10 +23,12 @@
 #include <QtCore/QLocale>
 #include <QtCore/QCoreApplication>
 #include <QtCore/QStandardPaths>
+#include <QtCore/QThread>
 #include <QFile>
 #include <QDir>
 
 #include "Misc/SettingsStore.h"
+#include "Misc/SettingsSnapshot.h"
 #include "Misc/PluginDB.h"
 #include "sigil_constants.h"
 
@@ -86,7 +88,7 @@ static QString KEY_SPECIAL_CHARACTER_FONT_SIZE = SETTINGS_GROUP + "/" + "special
 
 
 SettingsStore::SettingsStore()
-    : QSettings(QStandardPaths::writableLocation(QStandardPaths::DataLocation) + "/sigil.ini", QSettings::IniFormat)
+    : QSettings(defaultFileName(), QSettings::IniFormat)
 {
 }
 
@@ -294,36 +296,42 @@ void SettingsStore::setZoomImage(float zoom)
 {
     clearSettingsGroup();
     setValue(KEY_ZOOM_IMAGE, zoom);
+    updateSnapshot();
 }
 
 void SettingsStore::setZoomText(float zoom)
 {
     clearSettingsGroup();
     setValue(KEY_ZOOM_TEXT, zoom);
+    updateSnapshot();
 }
 
 void SettingsStore::setZoomWeb(float zoom)
 {
     clearSettingsGroup();
     setValue(KEY_ZOOM_WEB, zoom);
+    updateSnapshot();
 }
 
 void SettingsStore::setZoomPreview(float zoom)
 {
     clearSettingsGroup();
     setValue(KEY_ZOOM_PREVIEW, zoom);
+    updateSnapshot();
 }
 
 void SettingsStore::setDictionary(const QString &name)
 {
     clearSettingsGroup();
     setValue(KEY_DICTIONARY_NAME, name);
+    updateSnapshot();
 }
 
 void SettingsStore::setEnabledUserDictionaries(const QStringList names)
 {
     clearSettingsGroup();
     setValue(KEY_ENABLED_USER_DICTIONARIES, names);
+    updateSnapshot();
 }
 
 void SettingsStore::setViewState(int state)
@@ -336,12 +344,14 @@ void SettingsStore::setSpellCheck(bool enabled)
 {
     clearSettingsGroup();
     setValue(KEY_SPELL_CHECK, enabled);
+    updateSnapshot();
 }
 
 void SettingsStore::setDefaultUserDictionary(const QString &name)
 {
     clearSettingsGroup();
     setValue(KEY_DEFAULT_USER_DICTIONARY, name);
+    updateSnapshot();
 }
 
 void SettingsStore::setRenameTemplate(const QString &name)
@@ -354,12 +364,14 @@ void SettingsStore::setCleanLevel(SettingsStore::CleanLevel level)
 {
     clearSettingsGroup();
     setValue(KEY_CLEAN_LEVEL, level);
+    updateSnapshot();
 }
 
 void SettingsStore::setCleanOn(int on)
 {
     clearSettingsGroup();
     setValue(KEY_CLEAN_ON, on);
+    updateSnapshot();
 }
 
 void SettingsStore::setPreserveEntityCodeNames(const QList<std::pair <ushort, QString>> codenames)
@@ -374,6 +386,7 @@ void SettingsStore::setPreserveEntityCodeNames(const QList<std::pair <ushort, QS
     }
     setValue(KEY_PRESERVE_ENTITY_NAMES, names);
     setValue(KEY_PRESERVE_ENTITY_CODES, codes);
+    updateSnapshot();
 }
 
 void SettingsStore::setPluginEnginePaths(const QHash <QString, QString> &enginepaths)
@@ -477,3 +490,18 @@ void SettingsStore::clearSettingsGroup()
         endGroup();
     }
 }
+
+QString SettingsStore::defaultFileName()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::DataLocation) + "/sigil.ini";
+}
+
+void SettingsStore::updateSnapshot()
+{
+    // The snapshot is only replaced on the GUI thread, and only
+    // mirrors the settings file every SettingsStore() opens.
+    if (QThread::currentThread() == QCoreApplication::instance()->thread() &&
+        fileName() == defaultFileName()) {
+        SettingsSnapshot::instance()->Reload();
+    }
+}
@@ -298,6 +298,14 @@ private:
      * this class implements to be set in the wrong place.
      */
     void clearSettingsGroup();
+
+    static QString defaultFileName();
+
+    /**
+     * Refreshes the SettingsSnapshot after one of the
+     * settings it holds has been changed.
+     */
+    void updateSnapshot();
 };
 
 #endif // SETTINGSSTORE_H
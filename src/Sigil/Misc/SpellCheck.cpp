@@ -28,7 +28,9 @@
 #include <QtCore/QIODevice>
 #include <QtCore/QTextCodec>
 #include <QtCore/QTextStream>
+#include <QtCore/QThread>
 #include <QtCore/QUrl>
+#include <QtConcurrent/QtConcurrent>
 #include <QtWidgets/QApplication>
 #include <QtCore/QStandardPaths>
 
@@ -54,10 +56,11 @@ SpellCheck *SpellCheck::instance()
 SpellCheck::SpellCheck() :
     m_hunspell(0),
     m_codec(0),
-    m_wordchars("")
+    m_wordchars(""),
+    m_LoadWatcher(*new QFutureWatcher<LoadedDictionary>(this)),
+    m_loading(false)
 {
-    // There is a considerable lag involved in loading the Spellcheck dictionaries
-    QApplication::setOverrideCursor(Qt::WaitCursor);
+    connect(&m_LoadWatcher, SIGNAL(finished()), this, SLOT(dictionaryLoadFinished()));
     loadDictionaryNames();
     // Create the user dictionary word list directiory if necessary.
     const QString user_directory = userDictionaryDirectory();
@@ -79,11 +82,14 @@ SpellCheck::SpellCheck() :
     // Load the dictionary the user has selected if one was saved.
     SettingsStore settings;
     setDictionary(settings.dictionary());
-    QApplication::restoreOverrideCursor();
 }
 
 SpellCheck::~SpellCheck()
 {
+    waitForDictionary();
+    m_languageLoads.waitForFinished();
+    clearLanguageDictionaries();
+
     if (m_hunspell) {
         delete m_hunspell;
         m_hunspell = 0;
@@ -120,6 +126,9 @@ QString SpellCheck::currentDictionary() const
 
 bool SpellCheck::spell(const QString &word)
 {
+    waitForDictionary();
+    QMutexLocker locker(&m_hunspellMutex);
+
     if (!m_hunspell) {
         return true;
     }
@@ -127,8 +136,145 @@ bool SpellCheck::spell(const QString &word)
     return m_hunspell->spell(m_codec->fromUnicode(Utility::getSpellingSafeText(word)).constData()) != 0;
 }
 
+bool SpellCheck::spell(const QString &word, const QString &language, bool wait)
+{
+    QSharedPointer<LanguageDictionary> dictionary;
+
+    if (!language.isEmpty()) {
+        dictionary = languageDictionary(language);
+    }
+
+    if (!dictionary) {
+        return spell(word);
+    }
+
+    if (wait) {
+        // Runs the load on this thread if no pool thread has picked it up
+        dictionary->load.waitForFinished();
+    }
+
+    QMutexLocker locker(&dictionary->mutex);
+
+    if (!dictionary->ready) {
+        return true;
+    }
+
+    return dictionary->loaded.hunspell->spell(dictionary->loaded.codec->fromUnicode(Utility::getSpellingSafeText(word)).constData()) != 0;
+}
+
+QSharedPointer<SpellCheck::LanguageDictionary> SpellCheck::languageDictionary(const QString &language)
+{
+    QMutexLocker locker(&m_languageDictionariesMutex);
+    QString name = dictionaryForLanguage(language);
+
+    if (name == m_dictionaryName) {
+        return QSharedPointer<LanguageDictionary>();
+    }
+
+    if (!m_languageDictionaries.contains(name)) {
+        QSharedPointer<LanguageDictionary> dictionary(new LanguageDictionary());
+        dictionary->load = QtConcurrent::run(loadLanguageDictionary, this, dictionary,
+                                             m_dictionaries.value(name), name, m_ignoredWords);
+        m_languageDictionaries.insert(name, dictionary);
+        m_languageLoads.addFuture(dictionary->load);
+    }
+
+    return m_languageDictionaries.value(name);
+}
+
+SpellCheck::LanguageDictionary::LanguageDictionary() :
+    ready(false)
+{
+    loaded.hunspell = 0;
+    loaded.codec = 0;
+}
+
+SpellCheck::LanguageDictionary::~LanguageDictionary()
+{
+    delete loaded.hunspell;
+}
+
+void SpellCheck::loadLanguageDictionary(SpellCheck *spellcheck,
+                                        QSharedPointer<LanguageDictionary> dictionary,
+                                        const QString &path,
+                                        const QString &name,
+                                        const QStringList &ignored_words)
+{
+    // Parsed without holding the dictionary's mutex so checking
+    // words against it doesn't wait for the load
+    LoadedDictionary loaded = loadDictionary(QString("%1%2.aff").arg(path).arg(name),
+                                             QString("%1%2.dic").arg(path).arg(name),
+                                             QString("%1hyph_%2.dic").arg(path).arg(name),
+                                             spellcheck->allUserDictionaryWords() + ignored_words);
+    {
+        QMutexLocker locker(&dictionary->mutex);
+        dictionary->loaded = loaded;
+        foreach(QString word, dictionary->pendingWords) {
+            addWord(loaded.hunspell, loaded.codec, word);
+        }
+        dictionary->pendingWords.clear();
+        dictionary->ready = true;
+    }
+    // Words checked while loading were passed, so they need another look
+    QMetaObject::invokeMethod(spellcheck, "languageDictionaryLoadFinished", Qt::QueuedConnection);
+}
+
+void SpellCheck::languageDictionaryLoadFinished()
+{
+    emit dictionaryLoaded();
+}
+
+QString SpellCheck::dictionaryForLanguage(const QString &language)
+{
+    if (m_languageNames.contains(language)) {
+        return m_languageNames.value(language);
+    }
+
+    // Language tags use "-", dictionary names use "_"
+    const QString code = QString(language).replace("-", "_").toLower();
+    const QString primary = code.section("_", 0, 0);
+    QString name = m_dictionaryName;
+
+    // The selected dictionary is used for every variant of its language
+    if (m_dictionaryName.section("_", 0, 0).toLower() != primary) {
+        QStringList names = m_dictionaries.keys();
+        names.sort();
+        QString primary_match;
+        foreach(QString dictionary_name, names) {
+            if (dictionary_name.toLower() == code) {
+                name = dictionary_name;
+                primary_match.clear();
+                break;
+            }
+
+            if (primary_match.isEmpty() && dictionary_name.section("_", 0, 0).toLower() == primary) {
+                primary_match = dictionary_name;
+            }
+        }
+
+        if (!primary_match.isEmpty()) {
+            name = primary_match;
+        }
+    }
+
+    m_languageNames.insert(language, name);
+    return name;
+}
+
+void SpellCheck::clearLanguageDictionaries()
+{
+    // Dictionaries still loading or in use are deleted
+    // when the last reference to them goes away
+    QMutexLocker locker(&m_languageDictionariesMutex);
+    m_languageDictionaries.clear();
+    m_languageNames.clear();
+}
+
 QStringList SpellCheck::suggest(const QString &word)
 {
+    waitForDictionary();
+    QMutexLocker locker(&m_hunspellMutex);
+
     if (!m_hunspell) {
         return QStringList();
     }
@@ -160,31 +306,71 @@ void SpellCheck::ignoreWord(const QString &word)
 
 void SpellCheck::ignoreWordInDictionary(const QString &word)
 {
+    {
+        QMutexLocker locker(&m_languageDictionariesMutex);
+        foreach(QSharedPointer<LanguageDictionary> dictionary, m_languageDictionaries) {
+            QMutexLocker dictionary_locker(&dictionary->mutex);
+
+            if (dictionary->ready) {
+                addWord(dictionary->loaded.hunspell, dictionary->loaded.codec, word);
+            } else {
+                dictionary->pendingWords.append(word);
+            }
+        }
+    }
+
+    // Added once the dictionary is ready
+    if (m_loading) {
+        m_pendingWords.append(word);
+        return;
+    }
+
+    QMutexLocker locker(&m_hunspellMutex);
+
     if (!m_hunspell) {
         return;
     }
 
-    m_hunspell->add(m_codec->fromUnicode(Utility::getSpellingSafeText(word)).constData());
+    addWord(m_hunspell, m_codec, word);
+}
+
+void SpellCheck::addWord(Hunspell *hunspell, QTextCodec *codec, const QString &word)
+{
+    hunspell->add(codec->fromUnicode(Utility::getSpellingSafeText(word)).constData());
 }
 
 void SpellCheck::setDictionary(const QString &name, bool forceReplace)
 {
     // See if we are already using a hunspell object for this language.
-    if (!forceReplace && m_dictionaryName == name && m_hunspell) {
+    if (!forceReplace && m_dictionaryName == name && (m_hunspell || m_loading)) {
         return;
     }
 
+    // A dictionary still loading is replaced by the new one.
+    waitForDictionary();
+    {
+        // Which languages use the current dictionary changes, and a forced
+        // reload has to pick up changed user dictionaries. The name is read
+        // with the same mutex held when looking up language dictionaries.
+        QMutexLocker locker(&m_languageDictionariesMutex);
+        m_languageDictionaries.clear();
+        m_languageNames.clear();
+        // Save the dictionary name for use later.
+        m_dictionaryName = name;
+    }
+    QMutexLocker locker(&m_hunspellMutex);
+
     // Delete the current hunspell object.
     if (m_hunspell) {
         delete m_hunspell;
         m_hunspell = 0;
     }
 
-    // Save the dictionary name for use later.
-    m_dictionaryName = name;
+    locker.unlock();
 
     // If we don't have a dictionary we cannot continue.
     if (name.isEmpty() || !m_dictionaries.contains(name)) {
+        emit dictionaryLoaded();
         return;
     }
 
@@ -192,38 +378,78 @@ void SpellCheck::setDictionary(const QString &name, bool forceReplace)
     QString aff = QString("%1%2.aff").arg(m_dictionaries.value(name)).arg(name);
     QString dic = QString("%1%2.dic").arg(m_dictionaries.value(name)).arg(name);
     QString hyph_dic = QString("%1hyph_%2.dic").arg(m_dictionaries.value(name)).arg(name);
+    // The words in the user dictionaries and the "Ignored" dictionary.
+    QStringList words = allUserDictionaryWords() + m_ignoredWords;
+    // Parsing a large dictionary takes seconds so it is done in the background.
+    m_loading = true;
+    m_pendingWords.clear();
+    m_LoadWatcher.setFuture(QtConcurrent::run(loadDictionary, aff, dic, hyph_dic, words));
+    emit dictionaryLoading();
+}
+
+SpellCheck::LoadedDictionary SpellCheck::loadDictionary(const QString &aff, const QString &dic, const QString &hyph_dic, const QStringList &words)
+{
+    LoadedDictionary loaded;
     // Create a new hunspell object.
-    m_hunspell = new Hunspell(aff.toLocal8Bit().constData(), dic.toLocal8Bit().constData());
+    loaded.hunspell = new Hunspell(aff.toLocal8Bit().constData(), dic.toLocal8Bit().constData());
 
     // Load the hyphenation dictionary if it exists.
     if (QFile::exists(hyph_dic)) {
-        m_hunspell->add_dic(hyph_dic.toLocal8Bit().constData());
+        loaded.hunspell->add_dic(hyph_dic.toLocal8Bit().constData());
     }
 
     // Get the encoding for the text in the dictionary.
-    m_codec = QTextCodec::codecForName(m_hunspell->get_dic_encoding());
+    loaded.codec = QTextCodec::codecForName(loaded.hunspell->get_dic_encoding());
 
-    if (m_codec == 0) {
-        m_codec = QTextCodec::codecForName("UTF-8");
+    if (loaded.codec == 0) {
+        loaded.codec = QTextCodec::codecForName("UTF-8");
     }
 
     // Get the extra wordchars used for tokenization
-    m_wordchars = m_codec->toUnicode(m_hunspell->get_wordchars());
+    loaded.wordchars = loaded.codec->toUnicode(loaded.hunspell->get_wordchars());
+    foreach(QString word, words) {
+        addWord(loaded.hunspell, loaded.codec, word);
+    }
+    return loaded;
+}
 
-    // Load in the words from the user dictionaries.
-    foreach(QString word, allUserDictionaryWords()) {
-        ignoreWordInDictionary(word);
+void SpellCheck::dictionaryLoadFinished()
+{
+    waitForDictionary();
+}
+
+void SpellCheck::waitForDictionary()
+{
+    // Only the thread owning the dictionary installs it.
+    if (!m_loading || QThread::currentThread() != thread()) {
+        return;
     }
 
-    // Reload the words in the "Ignored" dictionary.
-    foreach(QString word, m_ignoredWords) {
+    m_LoadWatcher.waitForFinished();
+    LoadedDictionary loaded = m_LoadWatcher.result();
+    {
+        QMutexLocker locker(&m_hunspellMutex);
+        m_hunspell = loaded.hunspell;
+        m_codec = loaded.codec;
+        m_wordchars = loaded.wordchars;
+        m_loading = false;
+    }
+    foreach(QString word, m_pendingWords) {
         ignoreWordInDictionary(word);
     }
+    m_pendingWords.clear();
+    emit dictionaryLoaded();
+}
+
+bool SpellCheck::isLoading() const
+{
+    return m_loading;
 }
 
 
 QString SpellCheck::getWordChars()
 {
+    waitForDictionary();
     return m_wordchars;
 }
 
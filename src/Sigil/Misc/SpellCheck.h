@@ -23,7 +23,13 @@
 #ifndef SPELLCHECK_H
 #define SPELLCHECK_H
 
+#include <QtCore/QFuture>
+#include <QtCore/QFutureSynchronizer>
+#include <QtCore/QFutureWatcher>
 #include <QtCore/QHash>
+#include <QtCore/QMutex>
+#include <QtCore/QObject>
+#include <QtCore/QSharedPointer>
 #include <QtCore/QString>
 #include <QtCore/QStringList>
 
@@ -33,9 +39,23 @@ class QTextCodec;
 
 /**
  * Singleton.
+ *
+ * Dictionaries are loaded on a background thread. Until a dictionary
+ * is ready every word is treated as correctly spelled, except that
+ * spell(), suggest() and getWordChars() wait for the dictionary when
+ * called from the GUI thread.
+ *
+ * Words in text marked with another language are checked against a
+ * dictionary for that language. It is loaded in the background the
+ * first time it is needed. Checking a word waits for that dictionary,
+ * except for the syntax highlighter, which treats those words as
+ * correctly spelled until it is ready. Each dictionary is guarded by
+ * its own mutex so spelling can be checked from several threads at once.
  */
-class SpellCheck
+class SpellCheck : public QObject
 {
+    Q_OBJECT
+
 public:
     static SpellCheck *instance();
     ~SpellCheck();
@@ -44,6 +64,16 @@ public:
     QStringList dictionaries();
     QString currentDictionary() const;
     bool spell(const QString &word);
+
+    /**
+     * Checks the word against the dictionary for the language,
+     * a lang attribute value such as "de" or "en-GB". The current
+     * dictionary is used for its own language, for an empty language
+     * and for languages without an installed dictionary.
+     * If wait is false a word is treated as correctly spelled while
+     * the language's dictionary is still loading.
+     */
+    bool spell(const QString &word, const QString &language, bool wait = true);
     QStringList suggest(const QString &word);
     void clearIgnoredWords();
     void ignoreWord(const QString &word);
@@ -68,17 +98,101 @@ public:
 
     void loadDictionaryNames();
 
+    /**
+     * True while a dictionary is being loaded in the background.
+     */
+    bool isLoading() const;
+
+    /**
+     * Blocks until the dictionary being loaded is ready.
+     * Must be called from the GUI thread before handing
+     * spell checking work to other threads.
+     */
+    void waitForDictionary();
+
+signals:
+    void dictionaryLoading();
+    void dictionaryLoaded();
+
+private slots:
+    void dictionaryLoadFinished();
+    void languageDictionaryLoadFinished();
+
 private:
     SpellCheck();
 
+    struct LoadedDictionary {
+        Hunspell *hunspell;
+        QTextCodec *codec;
+        QString wordchars;
+    };
+
+    // A dictionary for a language other than the current dictionary's.
+    // Shared with the thread loading it and with the threads checking
+    // words against it, so it can be dropped from the list at any time.
+    struct LanguageDictionary {
+        LanguageDictionary();
+        ~LanguageDictionary();
+
+        LoadedDictionary loaded;
+        // Set once the dictionary has been loaded in the background
+        bool ready;
+        // Words ignored while the dictionary was loading
+        QStringList pendingWords;
+        QMutex mutex;
+        // Set before the dictionary is shared and never changed
+        QFuture<void> load;
+    };
+
+    /**
+     * The name of the dictionary to use for the language.
+     * Must be called with m_languageDictionariesMutex held.
+     */
+    QString dictionaryForLanguage(const QString &language);
+
+    /**
+     * Returns the dictionary for the language, or a null pointer when the
+     * current dictionary is used for it. A dictionary not loaded yet
+     * starts loading in the background and is returned right away.
+     */
+    QSharedPointer<LanguageDictionary> languageDictionary(const QString &language);
+
+    void clearLanguageDictionaries();
+
+    static LoadedDictionary loadDictionary(const QString &aff, const QString &dic, const QString &hyph_dic, const QStringList &words);
+
+    static void loadLanguageDictionary(SpellCheck *spellcheck,
+                                       QSharedPointer<LanguageDictionary> dictionary,
+                                       const QString &path,
+                                       const QString &name,
+                                       const QStringList &ignored_words);
+
+    static void addWord(Hunspell *hunspell, QTextCodec *codec, const QString &word);
+
     Hunspell *m_hunspell;
+    // Hunspell is not thread safe
+    QMutex m_hunspellMutex;
     QTextCodec *m_codec;
     QString m_wordchars;
+    // Written on the GUI thread with m_languageDictionariesMutex held
     QString m_dictionaryName;
     //
     QHash<QString, QString> m_dictionaries;
     QStringList m_ignoredWords;
 
+    QFutureWatcher<LoadedDictionary> &m_LoadWatcher;
+    bool m_loading;
+    // Words ignored while the dictionary was loading
+    QStringList m_pendingWords;
+
+    // Keyed by dictionary name
+    QHash<QString, QSharedPointer<LanguageDictionary>> m_languageDictionaries;
+    // Dictionary names keyed by language
+    QHash<QString, QString> m_languageNames;
+    QMutex m_languageDictionariesMutex;
+    // The language dictionaries being loaded
+    QFutureSynchronizer<void> m_languageLoads;
+
     static SpellCheck *m_instance;
 };
 
@@ -29,15 +29,19 @@
 #endif
 
 #include <stdio.h>
+#include <string.h>
 #include <time.h>
 
 #include <QApplication>
+#include <QtCore/QCryptographicHash>
 #include <QtCore/QDir>
 #include <QtCore/QFile>
 #include <QtCore/QFileInfo>
 #include <QtCore/QProcess>
+#include <QtCore/QSaveFile>
 #include <QtCore/QStringList>
 #include <QtCore/QStringRef>
+#include <QtCore/QTextCodec>
 #include <QtCore/QTextStream>
 #include <QtCore/QtGlobal>
 #include <QtCore/QUrl>
@@ -289,6 +293,21 @@ bool Utility::ForceCopyFile(const QString &fullinpath, const QString &fulloutpat
 }
 
 
+bool Utility::ForceMoveFile(const QString &fullinpath, const QString &fulloutpath)
+{
+    if (!QFileInfo(fullinpath).exists()) {
+        return false;
+    }
+    if (QFileInfo::exists(fulloutpath)) {
+        Utility::SDeleteFile(fulloutpath);
+    }
+    if (QFile::rename(fullinpath, fulloutpath)) {
+        return true;
+    }
+    return QFile::copy(fullinpath, fulloutpath);
+}
+
+
 bool Utility::RenameFile(const QString &oldfilepath, const QString &newfilepath)
 {
     // Make sure the path exists, otherwise very
@@ -373,7 +392,7 @@ bool Utility::IsFileReadable(const QString &fullfilepath)
 // Reads the text file specified with the full file path;
 // text needs to be in UTF-8 or UTF-16; if the file cannot
 // be read, an error dialog is shown and an empty string returned
-QString Utility::ReadUnicodeTextFile(const QString &fullfilepath)
+QString Utility::ReadUnicodeTextFile(const QString &fullfilepath, QByteArray *content_hash)
 {
     // TODO: throw an exception instead of
     // returning an empty string
@@ -387,37 +406,185 @@ QString Utility::ReadUnicodeTextFile(const QString &fullfilepath)
                    );
     }
 
-    QTextStream in(&file);
-    // Input should be UTF-8
-    in.setCodec("UTF-8");
-    // This will automatically switch reading from
-    // UTF-8 to UTF-16 if a BOM is detected
-    in.setAutoDetectUnicode(true);
-    return ConvertLineEndings(in.readAll());
+    qint64 size = file.size();
+
+    if (size == 0) {
+        if (content_hash) {
+            *content_hash = ContentHash("", 0);
+        }
+
+        return QString();
+    }
+
+    // Map the file instead of copying it into a buffer first;
+    // not every file system supports that though.
+    uchar *mapped = file.map(0, size);
+
+    if (mapped) {
+        if (content_hash) {
+            *content_hash = ContentHash(reinterpret_cast<const char *>(mapped), size);
+        }
+
+        QString text = DecodeUnicodeText(reinterpret_cast<const char *>(mapped), size);
+        file.unmap(mapped);
+        return text;
+    }
+
+    QByteArray data = file.readAll();
+
+    if (content_hash) {
+        *content_hash = ContentHash(data.constData(), data.size());
+    }
+
+    return DecodeUnicodeText(data.constData(), data.size());
+}
+
+
+QString Utility::DecodeUnicodeText(const char *data, qint64 length)
+{
+    const uchar *bytes = reinterpret_cast<const uchar *>(data);
+
+    // UTF-16 and UTF-32 files are rare, so they take the slow road
+    if (length >= 2 &&
+        ((bytes[0] == 0xFF && bytes[1] == 0xFE) || (bytes[0] == 0xFE && bytes[1] == 0xFF) ||
+         (length >= 4 && bytes[0] == 0x00 && bytes[1] == 0x00 && bytes[2] == 0xFE && bytes[3] == 0xFF))) {
+        QByteArray raw = QByteArray::fromRawData(data, length);
+        QTextCodec *codec = QTextCodec::codecForUtfText(raw, QTextCodec::codecForName("UTF-8"));
+        return ConvertLineEndings(codec->toUnicode(raw));
+    }
+
+    qint64 i = 0;
+
+    // The UTF-8 byte order mark is dropped like the UTF-8 codec does
+    if (length >= 3 && bytes[0] == 0xEF && bytes[1] == 0xBB && bytes[2] == 0xBF) {
+        i = 3;
+    }
+
+    // UTF-8 never needs more UTF-16 code units than it has bytes
+    QString text;
+    text.resize(length - i);
+    ushort *out = reinterpret_cast<ushort *>(text.data());
+    ushort *const out_start = out;
+    const quint64 HIGH_BITS = Q_UINT64_C(0x8080808080808080);
+    const quint64 ONES = Q_UINT64_C(0x0101010101010101);
+    const quint64 CARRIAGE_RETURNS = Q_UINT64_C(0x0D0D0D0D0D0D0D0D);
+
+    while (i < length) {
+        // Widen eight bytes at a time while they are plain ASCII without
+        // carriage returns; a compiler will turn this into vector code.
+        while (i + 8 <= length) {
+            quint64 block;
+            memcpy(&block, bytes + i, 8);
+            quint64 cr = block ^ CARRIAGE_RETURNS;
+
+            if ((block & HIGH_BITS) || ((cr - ONES) & ~cr & HIGH_BITS)) {
+                break;
+            }
+
+            for (int k = 0; k < 8; ++k) {
+                out[k] = bytes[i + k];
+            }
+
+            out += 8;
+            i += 8;
+        }
+
+        if (i >= length) {
+            break;
+        }
+
+        uchar c = bytes[i];
+
+        if (c < 0x80) {
+            if (c == 0x0D) {
+                *out++ = 0x0A;
+
+                if (i + 1 < length && bytes[i + 1] == 0x0A) {
+                    ++i;
+                }
+            } else {
+                *out++ = c;
+            }
+
+            ++i;
+            continue;
+        }
+
+        // A run of non-ASCII bytes always holds whole sequences
+        // (or broken ones), so it can be decoded on its own.
+        qint64 run_end = i + 1;
+
+        while (run_end < length && bytes[run_end] >= 0x80) {
+            ++run_end;
+        }
+
+        QString decoded = QString::fromUtf8(data + i, run_end - i);
+        memcpy(out, decoded.utf16(), decoded.size() * sizeof(ushort));
+        out += decoded.size();
+        i = run_end;
+    }
+
+    text.truncate(out - out_start);
+    return text;
+}
+
+
+QByteArray Utility::EncodeUnicodeText(const QString &text)
+{
+    // We ALWAYS output in UTF-8
+    QByteArray data = text.toUtf8();
+#if defined(Q_OS_WIN32)
+    // Text mode used to do this conversion one line at a time
+    data.replace("\n", "\r\n");
+#endif
+    return data;
 }
 
 
 // Writes the provided text variable to the specified
-// file; if the file exists, it is truncated
+// file; if the file exists, it is replaced
 void Utility::WriteUnicodeTextFile(const QString &text, const QString &fullfilepath)
 {
-    QFile file(fullfilepath);
+    WriteFileAtomically(EncodeUnicodeText(text), fullfilepath);
+}
+
 
-    if (!file.open(QIODevice::WriteOnly |
-                   QIODevice::Truncate  |
-                   QIODevice::Text
-                  )
-       ) {
+void Utility::WriteFileAtomically(const QByteArray &data, const QString &fullfilepath)
+{
+    QSaveFile file(fullfilepath);
+
+    if (!file.open(QIODevice::WriteOnly)) {
         boost_throw(CannotOpenFile()
-                    << errinfo_file_fullpath(file.fileName().toStdString())
+                    << errinfo_file_fullpath(fullfilepath.toStdString())
                     << errinfo_file_errorstring(file.errorString().toStdString())
                    );
     }
 
-    QTextStream out(&file);
-    // We ALWAYS output in UTF-8
-    out.setCodec("UTF-8");
-    out << text;
+    file.write(data);
+
+    // Nothing replaces the original file unless all of the data was written
+    if (!file.commit()) {
+        boost_throw(CannotWriteFile()
+                    << errinfo_file_fullpath(fullfilepath.toStdString())
+                    << errinfo_file_errorstring(file.errorString().toStdString())
+                   );
+    }
+}
+
+
+QByteArray Utility::ContentHash(const char *data, qint64 length)
+{
+    QCryptographicHash hash(QCryptographicHash::Md5);
+
+    // addData() takes an int length
+    while (length > 0) {
+        int chunk = static_cast<int>(qMin<qint64>(length, 1 << 30));
+        hash.addData(data, chunk);
+        data += chunk;
+        length -= chunk;
+    }
+
+    return hash.result();
 }
 
 
@@ -425,8 +592,32 @@ void Utility::WriteUnicodeTextFile(const QString &text, const QString &fullfilep
 // line endings that are expected throughout the Qt framework
 QString Utility::ConvertLineEndings(const QString &text)
 {
+    int first_cr = text.indexOf(QChar(0x0D));
+
+    if (first_cr == -1) {
+        return text;
+    }
+
+    // A single pass over a copy instead of two replace() calls
     QString newtext(text);
-    return newtext.replace("\x0D\x0A", "\x0A").replace("\x0D", "\x0A");
+    QChar *data = newtext.data();
+    const int length = newtext.length();
+    int out = first_cr;
+
+    for (int i = first_cr; i < length; ++i) {
+        if (data[ i ] == QChar(0x0D)) {
+            data[ out++ ] = QChar(0x0A);
+
+            if (i + 1 < length && data[ i + 1 ] == QChar(0x0A)) {
+                ++i;
+            }
+        } else {
+            data[ out++ ] = data[ i ];
+        }
+    }
+
+    newtext.truncate(out);
+    return newtext;
 }
 
 
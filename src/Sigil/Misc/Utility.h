@@ -84,6 +84,10 @@ public:
 
     static bool ForceCopyFile(const QString &fullinpath, const QString &fulloutpath);
 
+    // Moves the file over the destination, replacing it. Falls back
+    // to copying when the two paths are on different file systems.
+    static bool ForceMoveFile(const QString &fullinpath, const QString &fulloutpath);
+
     static bool RenameFile(const QString &oldfilepath, const QString &newfilepath);
 
     // Returns path to a random filename with the specified extension in
@@ -104,13 +108,29 @@ public:
 
     // Reads the text file specified with the full file path;
     // text needs to be in UTF-8 or UTF-16; if the file cannot
-    // be read, an error dialog is shown and an empty string returned
-    static QString ReadUnicodeTextFile(const QString &fullfilepath);
+    // be read, an error dialog is shown and an empty string returned;
+    // if content_hash is given it receives the ContentHash() of the file bytes
+    static QString ReadUnicodeTextFile(const QString &fullfilepath, QByteArray *content_hash = NULL);
+
+    // Decodes text read from a file. The text is taken to be UTF-8
+    // unless it starts with a UTF-16 or UTF-32 byte order mark.
+    // Line endings are converted to Unix style while decoding.
+    static QString DecodeUnicodeText(const char *data, qint64 length);
+
+    // Encodes the text the way WriteUnicodeTextFile() stores it on disk
+    static QByteArray EncodeUnicodeText(const QString &text);
 
     // Writes the provided text variable to the specified
-    // file; if the file exists, it is truncated
+    // file; if the file exists, it is replaced
     static void WriteUnicodeTextFile(const QString &text, const QString &fullfilepath);
 
+    // Writes the data to a temporary file next to the specified file
+    // and then moves it over the file, so the file is never left half written
+    static void WriteFileAtomically(const QByteArray &data, const QString &fullfilepath);
+
+    // A hash of file content, used to tell whether a file needs writing
+    static QByteArray ContentHash(const char *data, qint64 length);
+
     // Converts Mac and Windows style line endings to Unix style
     // line endings that are expected throughout the Qt framework
     static QString ConvertLineEndings(const QString &text);
@@ -19,36 +19,251 @@
 **
 *************************************************************************/
 
-#include <QRegularExpressionMatch>
-
 #include "Misc/SpellCheck.h"
 #include "Misc/Utility.h"
 #include "Misc/XHTMLHighlighter.h"
 #include "Misc/HTMLSpellCheck.h"
+#include "Misc/SettingsSnapshot.h"
 #include "Misc/SettingsStore.h"
 
-// All of our regular expressions
-static const QString DOCTYPE_BEGIN          = "<!(?!--)";
-static const QString HTML_ELEMENT_BEGIN     = "<(/\\?|/|\\?)?(?!!)";
+// The nodes are found by hand instead of with regular expressions because
+// highlightBlock runs for every line shown or edited. Each scanner below
+// matches exactly what the regular expression in its comment matches.
+
+static QChar CharAt(const QString &text, int index)
+{
+    return index < text.length() ? text.at(index) : QChar();
+}
+
+// "\s" as used by QRegularExpression without Unicode properties
+static bool IsSpace(QChar character)
+{
+    ushort code = character.unicode();
+    return code == ' ' || (code >= '\t' && code <= '\r');
+}
+
+// "[\w:-]" as used by QRegularExpression without Unicode properties
+static bool IsNameChar(QChar character)
+{
+    ushort code = character.unicode();
+    return (code >= 'a' && code <= 'z') ||
+           (code >= 'A' && code <= 'Z') ||
+           (code >= '0' && code <= '9') ||
+           code == '_' || code == ':' || code == '-';
+}
+
+// "<(/\?|/|\?)?(?!!)" anchored at index; returns the match length or 0
+static int HTMLElementBeginLength(const QString &text, int index)
+{
+    if (CharAt(text, index) != '<') {
+        return 0;
+    }
+
+    QChar next  = CharAt(text, index + 1);
+    QChar after = CharAt(text, index + 2);
+
+    if (next == '/' && after == '?' && CharAt(text, index + 3) != '!') {
+        return 3;
+    }
+
+    if ((next == '/' || next == '?') && after != '!') {
+        return 2;
+    }
+
+    return next != '!' ? 1 : 0;
+}
+
+// "\s*[\w:-]+(?=[^\w:-])\s*(?!=)" anchored at index; returns the match length or 0
+static int HTMLElementNameLength(const QString &text, int index)
+{
+    int length = text.length();
+    int i = index;
+
+    while (i < length && IsSpace(text.at(i))) {
+        i++;
+    }
+
+    int name_start = i;
+
+    while (i < length && IsNameChar(text.at(i))) {
+        i++;
+    }
+
+    // The name must be followed by another character
+    if (i == name_start || i == length) {
+        return 0;
+    }
+
+    int name_end = i;
+
+    while (i < length && IsSpace(text.at(i))) {
+        i++;
+    }
+
+    if (i < length && text.at(i) == '=') {
+        // An attribute name, not an element name
+        if (i == name_end) {
+            return 0;
+        }
+
+        // Give back the last space so that no "=" follows the match
+        i--;
+    }
+
+    return i - index;
+}
+
+// "&(?=[^\s;]+;)"
+static int FindEntityBegin(const QString &text, int from, int &length)
+{
+    for (int i = text.indexOf('&', from); i != -1; i = text.indexOf('&', i + 1)) {
+        int j = i + 1;
+
+        while (j < text.length() && text.at(j) != ';' && !IsSpace(text.at(j))) {
+            j++;
+        }
+
+        if (j > i + 1 && j < text.length() && text.at(j) == ';') {
+            length = 1;
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+// "<(/\?|/|\?)?(?!!)"
+static int FindHTMLElementBegin(const QString &text, int from, int &length)
+{
+    for (int i = text.indexOf('<', from); i != -1; i = text.indexOf('<', i + 1)) {
+        length = HTMLElementBeginLength(text, i);
+
+        if (length > 0) {
+            return i;
+        }
+    }
 
-// "(?=[^\\w:-])" emulates a boundary ("\\b") that counts ":" and "-" as word characters
-static const QString HTML_ELEMENT_NAME      = "\\s*[\\w:-]+(?=[^\\w:-])\\s*(?!=)";
-static const QString HTML_ELEMENT_END       = "(\\?|/)?>";
+    return -1;
+}
+
+// "(\?|/)?>"
+static int FindHTMLElementEnd(const QString &text, int from, int &length)
+{
+    for (int i = from; i < text.length(); i++) {
+        QChar character = text.at(i);
 
-static const QString HTML_COMMENT_BEGIN     = "<!--";
-static const QString HTML_COMMENT_END       = "-->";
+        if ((character == '?' || character == '/') && CharAt(text, i + 1) == '>') {
+            length = 2;
+            return i;
+        }
 
-static const QString CSS_BEGIN              = "<\\s*style[^>]*>";
-static const QString CSS_END                = "</\\s*style[^>]*>";
+        if (character == '>') {
+            length = 1;
+            return i;
+        }
+    }
 
-static const QString CSS_COMMENT_BEGIN      = "/\\*";
-static const QString CSS_COMMENT_END        = "\\*/";
+    return -1;
+}
 
-static const QString ATTRIBUTE_VALUE        = "\"[^<\"]*\"|'[^<']*'";
-static const QString ATTRIBUTE_NAME         = "[\\w:-]+";
+// "<!(?!--)"
+static int FindDoctypeBegin(const QString &text, int from, int &length)
+{
+    for (int i = text.indexOf(QLatin1String("<!"), from); i != -1; i = text.indexOf(QLatin1String("<!"), i + 1)) {
+        if (CharAt(text, i + 2) != '-' || CharAt(text, i + 3) != '-') {
+            length = 2;
+            return i;
+        }
+    }
 
-static const QString ENTITY_BEGIN           = "&(?=[^\\s;]+;)";
-static const QString ENTITY_END             = ";";
+    return -1;
+}
+
+// "<\s*style[^>]*>" or, for closing, "</\s*style[^>]*>"
+static int FindStyleTag(const QString &text, int from, bool closing, int &length)
+{
+    for (int i = text.indexOf('<', from); i != -1; i = text.indexOf('<', i + 1)) {
+        int j = i + 1;
+
+        if (closing) {
+            if (CharAt(text, j) != '/') {
+                continue;
+            }
+
+            j++;
+        }
+
+        while (j < text.length() && IsSpace(text.at(j))) {
+            j++;
+        }
+
+        if (text.midRef(j, 5) != QLatin1String("style")) {
+            continue;
+        }
+
+        int end = text.indexOf('>', j + 5);
+
+        // No later tag can be closed either
+        if (end == -1) {
+            return -1;
+        }
+
+        length = end - i + 1;
+        return i;
+    }
+
+    return -1;
+}
+
+static int FindString(const QString &text, int from, const QLatin1String &string, int &length)
+{
+    length = string.size();
+    return text.indexOf(string, from);
+}
+
+// "[\w:-]+"
+static int FindAttributeName(const QString &text, int from, int &length)
+{
+    for (int i = from; i < text.length(); i++) {
+        if (IsNameChar(text.at(i))) {
+            int j = i + 1;
+
+            while (j < text.length() && IsNameChar(text.at(j))) {
+                j++;
+            }
+
+            length = j - i;
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+// "\"[^<\"]*\"|'[^<']*'"
+static int FindAttributeValue(const QString &text, int from, int &length)
+{
+    for (int i = from; i < text.length(); i++) {
+        QChar quote = text.at(i);
+
+        if (quote != '"' && quote != '\'') {
+            continue;
+        }
+
+        int j = i + 1;
+
+        while (j < text.length() && text.at(j) != quote && text.at(j) != '<') {
+            j++;
+        }
+
+        if (j < text.length() && text.at(j) == quote) {
+            length = j - i + 1;
+            return i;
+        }
+    }
+
+    return -1;
+}
 
 
 // Constructor
@@ -59,62 +274,19 @@ XHTMLHighlighter::XHTMLHighlighter(bool checkSpelling, QObject *parent)
 {
     SettingsStore settings;
     m_codeViewAppearance = settings.codeViewAppearance();
-    QTextCharFormat html_format;
-    QTextCharFormat doctype_format;
-    QTextCharFormat html_comment_format;
-    QTextCharFormat css_format;
-    QTextCharFormat css_comment_format;
-    QTextCharFormat attribute_name_format;
-    QTextCharFormat attribute_value_format;
-    QTextCharFormat entity_format;
-    doctype_format        .setForeground(m_codeViewAppearance.xhtml_doctype_color);
-    html_format           .setForeground(m_codeViewAppearance.xhtml_html_color);
-    html_comment_format   .setForeground(m_codeViewAppearance.xhtml_html_comment_color);
-    css_format            .setForeground(m_codeViewAppearance.xhtml_css_color);
-    css_comment_format    .setForeground(m_codeViewAppearance.xhtml_css_comment_color);
-    attribute_name_format .setForeground(m_codeViewAppearance.xhtml_attribute_name_color);
-    attribute_value_format.setForeground(m_codeViewAppearance.xhtml_attribute_value_color);
-    entity_format         .setForeground(m_codeViewAppearance.xhtml_entity_color);
-    HighlightingRule rule;
-    rule.pattern = QRegularExpression(DOCTYPE_BEGIN);
-    rule.format  = doctype_format;
-    m_Rules[ "DOCTYPE_BEGIN" ] = rule;
-    rule.pattern = QRegularExpression(HTML_ELEMENT_BEGIN);
-    rule.format  = html_format;
-    m_Rules[ "HTML_ELEMENT_BEGIN" ] = rule;
-    rule.pattern = QRegularExpression(HTML_ELEMENT_END);
-    rule.format  = html_format;
-    m_Rules[ "HTML_ELEMENT_END" ] = rule;
-    rule.pattern = QRegularExpression(HTML_COMMENT_BEGIN);
-    rule.format  = html_comment_format;
-    m_Rules[ "HTML_COMMENT_BEGIN" ] = rule;
-    rule.pattern = QRegularExpression(HTML_COMMENT_END);
-    rule.format  = html_comment_format;
-    m_Rules[ "HTML_COMMENT_END" ] = rule;
-    rule.pattern = QRegularExpression(CSS_BEGIN);
-    rule.format  = css_format;
-    m_Rules[ "CSS_BEGIN" ] = rule;
-    rule.pattern = QRegularExpression(CSS_END);
-    rule.format  = css_format;
-    m_Rules[ "CSS_END" ] = rule;
-    rule.pattern = QRegularExpression(CSS_COMMENT_BEGIN);
-    rule.format  = css_comment_format;
-    m_Rules[ "CSS_COMMENT_BEGIN" ] = rule;
-    rule.pattern = QRegularExpression(CSS_COMMENT_END);
-    rule.format  = css_comment_format;
-    m_Rules[ "CSS_COMMENT_END" ] = rule;
-    rule.pattern = QRegularExpression(ATTRIBUTE_NAME);
-    rule.format  = attribute_name_format;
-    m_Rules[ "ATTRIBUTE_NAME" ] = rule;
-    rule.pattern = QRegularExpression(ATTRIBUTE_VALUE);
-    rule.format  = attribute_value_format;
-    m_Rules[ "ATTRIBUTE_VALUE" ] = rule;
-    rule.pattern = QRegularExpression(ENTITY_BEGIN);
-    rule.format  = entity_format;
-    m_Rules[ "ENTITY_BEGIN" ] = rule;
-    rule.pattern = QRegularExpression(ENTITY_END);
-    rule.format  = entity_format;
-    m_Rules[ "ENTITY_END" ] = rule;
+    m_DoctypeFormat       .setForeground(m_codeViewAppearance.xhtml_doctype_color);
+    m_HTMLFormat          .setForeground(m_codeViewAppearance.xhtml_html_color);
+    m_HTMLCommentFormat   .setForeground(m_codeViewAppearance.xhtml_html_comment_color);
+    m_CSSFormat           .setForeground(m_codeViewAppearance.xhtml_css_color);
+    m_CSSCommentFormat    .setForeground(m_codeViewAppearance.xhtml_css_comment_color);
+    m_AttributeNameFormat .setForeground(m_codeViewAppearance.xhtml_attribute_name_color);
+    m_AttributeValueFormat.setForeground(m_codeViewAppearance.xhtml_attribute_value_color);
+    m_EntityFormat        .setForeground(m_codeViewAppearance.xhtml_entity_color);
+    m_SpellingFormat.setUnderlineColor(m_codeViewAppearance.spelling_underline_color);
+    // QTextCharFormat::SpellCheckUnderline has issues with Qt 5. It only displays
+    // at some zoom levels and often doesn't display at all. So we're using wave
+    // underline since it's good enough for most people.
+    m_SpellingFormat.setUnderlineStyle(QTextCharFormat::WaveUnderline);
 }
 
 
@@ -137,11 +309,11 @@ void XHTMLHighlighter::highlightBlock(const QString &text)
         return;
     }
 
-    SettingsStore settings;
-    m_enableSpellCheck = settings.spellCheck();
+    m_enableSpellCheck = SettingsSnapshot::instance()->spellCheck();
 
-    // Run spell check over the text.
-    if (m_enableSpellCheck && m_checkSpelling) {
+    // Run spell check over the text. Blocks are highlighted
+    // again once a dictionary still loading is ready.
+    if (m_enableSpellCheck && m_checkSpelling && !SpellCheck::instance()->isLoading()) {
         CheckSpelling(text);
     }
 
@@ -156,60 +328,58 @@ void XHTMLHighlighter::highlightBlock(const QString &text)
 }
 
 
-// Returns the regex that matches the left bracket of a state
-QRegularExpression XHTMLHighlighter::GetLeftBracketRegEx(int state) const
+// Returns the index of the first left bracket of a state
+// at or after "from", or -1; "length" is set to its length
+int XHTMLHighlighter::FindLeftBracket(const QString &text, int state, int from, int &length) const
 {
-    QRegularExpression empty;
-
     switch (state) {
         case State_Entity:
-            return m_Rules.value("ENTITY_BEGIN").pattern;
+            return FindEntityBegin(text, from, length);
 
         case State_HTML:
-            return m_Rules.value("HTML_ELEMENT_BEGIN").pattern;
+            return FindHTMLElementBegin(text, from, length);
 
         case State_HTMLComment:
-            return m_Rules.value("HTML_COMMENT_BEGIN").pattern;
+            return FindString(text, from, QLatin1String("<!--"), length);
 
         case State_CSS:
-            return m_Rules.value("CSS_BEGIN").pattern;
+            return FindStyleTag(text, from, false, length);
 
         case State_CSSComment:
-            return m_Rules.value("CSS_COMMENT_BEGIN").pattern;
+            return FindString(text, from, QLatin1String("/*"), length);
 
         case State_DOCTYPE:
-            return m_Rules.value("DOCTYPE_BEGIN").pattern;
+            return FindDoctypeBegin(text, from, length);
 
         default:
-            return empty;
+            return -1;
     }
 }
 
 
-// Returns the regex that matches the right bracket of a state
-QRegularExpression XHTMLHighlighter::GetRightBracketRegEx(int state) const
+// Returns the index of the first right bracket of a state
+// at or after "from", or -1; "length" is set to its length
+int XHTMLHighlighter::FindRightBracket(const QString &text, int state, int from, int &length) const
 {
-    QRegularExpression empty;
-
     switch (state) {
         case State_Entity:
-            return m_Rules.value("ENTITY_END").pattern;
+            return FindString(text, from, QLatin1String(";"), length);
 
         case State_DOCTYPE:
         case State_HTML:
-            return m_Rules.value("HTML_ELEMENT_END").pattern;
+            return FindHTMLElementEnd(text, from, length);
 
         case State_HTMLComment:
-            return m_Rules.value("HTML_COMMENT_END").pattern;
+            return FindString(text, from, QLatin1String("-->"), length);
 
         case State_CSS:
-            return m_Rules.value("CSS_END").pattern;
+            return FindStyleTag(text, from, true, length);
 
         case State_CSSComment:
-            return m_Rules.value("CSS_COMMENT_END").pattern;
+            return FindString(text, from, QLatin1String("*/"), length);
 
         default:
-            return empty;
+            return -1;
     }
 }
 
@@ -257,57 +427,39 @@ void XHTMLHighlighter::FormatBody(const QString &text, int state, int index, int
 {
     if (state == State_HTML) {
         // First paint everything the color of the brackets
-        setFormat(index, length, m_Rules.value("HTML_ELEMENT_BEGIN").format);
-        QRegularExpression name  = m_Rules.value("ATTRIBUTE_NAME").pattern;
-        QRegularExpression value = m_Rules.value("ATTRIBUTE_VALUE").pattern;
+        setFormat(index, length, m_HTMLFormat);
         // Used to move over the line
         int main_index = index;
-
         // We skip over the left bracket (if it's present)
-        QRegularExpression bracket(HTML_ELEMENT_BEGIN);
-        QRegularExpressionMatch bracket_match = bracket.match(text, main_index);
-        if (bracket_match.hasMatch() && bracket_match.capturedStart() == main_index) {
-            main_index += bracket_match.capturedLength();
-        }
-
+        main_index += HTMLElementBeginLength(text, main_index);
         // We skip over the element name (if it's present)
         // because we want it to be the same color as the brackets
-        QRegularExpression elem_name(HTML_ELEMENT_NAME);
-        QRegularExpressionMatch elem_name_match = elem_name.match(text, main_index);
-        if (elem_name_match.hasMatch() && elem_name_match.capturedStart() == main_index) {
-            main_index += elem_name_match.capturedLength();
-        }
+        main_index += HTMLElementNameLength(text, main_index);
 
         while (true) {
             // Get the indexes of the attribute names and values
-            int name_index = -1;
             int name_len = 0;
-            QRegularExpressionMatch name_match = name.match(text, main_index);
-            if (name_match.hasMatch()) {
-                name_index = name_match.capturedStart();
-                name_len = name_match.capturedLength();
-            }
-
-            int value_index = -1;
+            int name_index = FindAttributeName(text, main_index, name_len);
             int value_len = 0;
-            QRegularExpressionMatch value_match = value.match(text, main_index);
-            if (value_match.hasMatch()) {
-                value_index = value_match.capturedStart();
-                value_len = value_match.capturedLength();
-            }
+            int value_index = FindAttributeValue(text, main_index, value_len);
 
             // If we can't find the names and values or we found them
             // outside of the area we are formatting, we exit
             if (((name_index  != -1) && (name_index  < index + length)) ||
                 ((value_index != -1) && (value_index < index + length))) {
                 // ... otherwise format the found sections
-                setFormat(name_index,  name_len,  m_Rules.value("ATTRIBUTE_NAME").format);
-                setFormat(value_index, value_len, m_Rules.value("ATTRIBUTE_VALUE").format);
+                if (name_index != -1) {
+                    setFormat(name_index, name_len, m_AttributeNameFormat);
+                }
+
+                if (value_index != -1) {
+                    setFormat(value_index, value_len, m_AttributeValueFormat);
+                }
             } else {
                 break;
             }
 
-            // Update the main index with the regex that matched "further down the line"
+            // Update the main index with the match that is "further down the line"
             if (name_index + name_len > value_index + value_len) {
                 main_index = name_index + name_len;
             } else {
@@ -315,15 +467,15 @@ void XHTMLHighlighter::FormatBody(const QString &text, int state, int index, int
             }
         }
     } else if (state == State_HTMLComment) {
-        setFormat(index, length, m_Rules.value("HTML_COMMENT_BEGIN").format);
+        setFormat(index, length, m_HTMLCommentFormat);
     } else if (state == State_CSS) {
-        setFormat(index, length, m_Rules.value("CSS_BEGIN").format);
+        setFormat(index, length, m_CSSFormat);
     } else if (state == State_CSSComment) {
-        setFormat(index, length, m_Rules.value("CSS_COMMENT_BEGIN").format);
+        setFormat(index, length, m_CSSCommentFormat);
     } else if (state == State_Entity) {
-        setFormat(index, length, m_Rules.value("ENTITY_BEGIN").format);
+        setFormat(index, length, m_EntityFormat);
     } else if (state == State_DOCTYPE) {
-        setFormat(index, length, m_Rules.value("DOCTYPE_BEGIN").format);
+        setFormat(index, length, m_DoctypeFormat);
     }
 }
 
@@ -333,33 +485,15 @@ void XHTMLHighlighter::FormatBody(const QString &text, int state, int index, int
 // if it is, the node is formatted
 void XHTMLHighlighter::HighlightLine(const QString &text, int state)
 {
-    QRegularExpression left_bracket_regex  = GetLeftBracketRegEx(state);
-    QRegularExpression right_bracket_regex = GetRightBracketRegEx(state);
     int main_index = 0;
 
     // We loop over the line several times
     // because we could have several nodes on it
     while (main_index < text.length()) {
-        int left_bracket_index  = -1;
         int left_bracket_len = 0;
-        int right_bracket_index = -1;
+        int left_bracket_index = FindLeftBracket(text, state, main_index, left_bracket_len);
         int right_bracket_len = 0;
-
-        if (!left_bracket_regex.pattern().isEmpty()) {
-            QRegularExpressionMatch left_bracket_match = left_bracket_regex.match(text, main_index);
-            if (left_bracket_match.hasMatch()) {
-                left_bracket_index = left_bracket_match.capturedStart();
-                left_bracket_len = left_bracket_match.capturedLength();
-            }
-        }
-
-        if (!right_bracket_regex.pattern().isEmpty()) {
-            QRegularExpressionMatch right_bracket_match = right_bracket_regex.match(text, main_index);
-            if (right_bracket_match.hasMatch()) {
-                right_bracket_index = right_bracket_match.capturedStart();
-                right_bracket_len = right_bracket_match.capturedLength();
-            }
-        }
+        int right_bracket_index = FindRightBracket(text, state, main_index, right_bracket_len);
 
         // If we are not starting our state and our state is
         // not already set, we don't format; see the four cases explanation below
@@ -419,14 +553,10 @@ void XHTMLHighlighter::HighlightLine(const QString &text, int state)
 
 void XHTMLHighlighter::CheckSpelling(const QString &text)
 {
-    QTextCharFormat format;
-    format.setUnderlineColor(m_codeViewAppearance.spelling_underline_color);
-    // QTextCharFormat::SpellCheckUnderline has issues with Qt 5. It only displays
-    // at some zoom levels and often doesn't display at all. So we're using wave
-    // underline since it's good enough for most people.
-    format.setUnderlineStyle(QTextCharFormat::WaveUnderline);
-    QList<HTMLSpellCheck::MisspelledWord> misspelled_words = HTMLSpellCheck::GetMisspelledWords(text);
+    // Rehighlighted when a language dictionary finishes loading
+    QList<HTMLSpellCheck::MisspelledWord> misspelled_words =
+        HTMLSpellCheck::GetMisspelledWords(text, 0, text.count(), "", false, false, false);
     foreach(HTMLSpellCheck::MisspelledWord misspelled_word, misspelled_words) {
-        setFormat(misspelled_word.offset, misspelled_word.length, format);
+        setFormat(misspelled_word.offset, misspelled_word.length, m_SpellingFormat);
     }
 }
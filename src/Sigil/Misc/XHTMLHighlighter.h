@@ -24,7 +24,7 @@
 #define XHTMLHIGHLIGHTER_H
 
 #include <QtGui/QSyntaxHighlighter>
-#include <QRegularExpression>
+#include <QtGui/QTextCharFormat>
 
 #include "Misc/SettingsStore.h"
 
@@ -45,11 +45,13 @@ protected:
 
 private:
 
-    // Returns the regex that matches the left bracket of a state
-    QRegularExpression GetLeftBracketRegEx(int state) const;
+    // Returns the index of the first left bracket of a state
+    // at or after "from", or -1; "length" is set to its length
+    int FindLeftBracket(const QString &text, int state, int from, int &length) const;
 
-    // Returns the regex that matches the right bracket of a state
-    QRegularExpression GetRightBracketRegEx(int state) const;
+    // Returns the index of the first right bracket of a state
+    // at or after "from", or -1; "length" is set to its length
+    int FindRightBracket(const QString &text, int state, int from, int &length) const;
 
     // Sets the requested state for the current text block
     void SetState(int state);
@@ -91,14 +93,16 @@ private:
         State_DOCTYPE       = 1 << 6
     };
 
-    struct HighlightingRule {
-        QRegularExpression pattern;
-        QTextCharFormat format;
-    };
-
-    // Stores all of our highlighting rules
-    // and the text formats used
-    QHash<QString, HighlightingRule> m_Rules;
+    // The text formats used for each node/state
+    QTextCharFormat m_HTMLFormat;
+    QTextCharFormat m_DoctypeFormat;
+    QTextCharFormat m_HTMLCommentFormat;
+    QTextCharFormat m_CSSFormat;
+    QTextCharFormat m_CSSCommentFormat;
+    QTextCharFormat m_AttributeNameFormat;
+    QTextCharFormat m_AttributeValueFormat;
+    QTextCharFormat m_EntityFormat;
+    QTextCharFormat m_SpellingFormat;
 
     // Determine if spell check should be used on the document.
     bool m_checkSpelling;
@@ -22,13 +22,12 @@
 #include <QtCore/QChar>
 
 #include "PCRE/PCREReplaceTextBuilder.h"
-#include "Misc/Utility.h"
 
 #define is_hex(a) (((a) >= '0' && (a) <= '9') || ((a) >= 'a' && (a) <= 'f') || ((a) >= 'A' && (a) <= 'F') ? true : false)
 
 PCREReplaceTextBuilder::PCREReplaceTextBuilder()
+    : m_caseChangeState(CaseChange_None)
 {
-    resetState();
 }
 
 bool PCREReplaceTextBuilder::BuildReplacementText(SPCRE &sre,
@@ -37,7 +36,22 @@ bool PCREReplaceTextBuilder::BuildReplacementText(SPCRE &sre,
         const QString &replacement_pattern,
         QString &out)
 {
-    resetState();
+    CompiledReplacement replacement;
+
+    if (!CompileReplacement(sre, replacement_pattern, replacement)) {
+        return false;
+    }
+
+    out.clear();
+    AppendReplacementText(replacement, text, 0, capture_groups_offsets, out);
+    return true;
+}
+
+bool PCREReplaceTextBuilder::CompileReplacement(SPCRE &sre,
+        const QString &replacement_pattern,
+        CompiledReplacement &out)
+{
+    out.clear();
 
     if (!sre.isValid()) {
         return false;
@@ -45,11 +59,11 @@ bool PCREReplaceTextBuilder::BuildReplacementText(SPCRE &sre,
 
     // Check if the \ start control is in the string.
     // If it's not we don't need to run though the replacment code and we
-    // can just return the pattern as the replaced text.
+    // can just use the pattern as the replaced text.
     // This is a simple and quick way that will catch a large number of
     // cases but not all.
     if (!replacement_pattern.contains("\\")) {
-        out = replacement_pattern;
+        addLiteral(replacement_pattern, out);
         return true;
     }
 
@@ -115,45 +129,40 @@ bool PCREReplaceTextBuilder::BuildReplacementText(SPCRE &sre,
                 if (c.isDigit()) {
                     int backref_number = c.digitValue();
 
-                    // Check if this number is a back reference we can
-                    // actually get.
-                    if (backref_number >= 0 && backref_number < capture_groups_offsets.count()) {
-                        accumulateReplcementText(Utility::Substring(capture_groups_offsets.at(backref_number).first, capture_groups_offsets.at(backref_number).second, text));
-                    } else {
-                        accumulateReplcementText(invalid_contol);
-                    }
-
+                    // Whether the match has this group is only
+                    // known once the replacement is applied.
+                    addBackReference(backref_number, invalid_contol, out);
                     in_control = false;
                 }
                 // Metacharacters
                 else if (c == 'a') {
-                    accumulateReplcementText("\a");
+                    addLiteral("\a", out);
                     in_control = false;
                 } else if (c == 'b') {
-                    accumulateReplcementText("\b");
+                    addLiteral("\b", out);
                     in_control = false;
                 } else if (c == 'f') {
-                    accumulateReplcementText("\f");
+                    addLiteral("\f", out);
                     in_control = false;
                 } else if (c == 'n') {
-                    accumulateReplcementText("\n");
+                    addLiteral("\n", out);
                     in_control = false;
                 } else if (c == 'r') {
-                    accumulateReplcementText("\r");
+                    addLiteral("\r", out);
                     in_control = false;
                 } else if (c == 't') {
-                    accumulateReplcementText("\t");
+                    addLiteral("\t", out);
                     in_control = false;
                 } else if (c == 'v') {
-                    accumulateReplcementText("\v");
+                    addLiteral("\v", out);
                     in_control = false;
                 } else if (c == '\\') {
-                    accumulateReplcementText("\\");
+                    addLiteral("\\", out);
                     in_control = false;
                 }
                 // End case change.
                 else if (c == 'E') {
-                    m_caseChangeState = CaseChange_None;
+                    addCaseChange(Segment::EndCaseChange, CaseChange_None, out);
                     in_control = false;
                 }
                 // Backreference.
@@ -162,22 +171,22 @@ bool PCREReplaceTextBuilder::BuildReplacementText(SPCRE &sre,
                 }
                 // Lower case next character.
                 else if (c == 'l') {
-                    trySetCaseChange(CaseChange_LowerNext);
+                    addCaseChange(Segment::StartCaseChange, CaseChange_LowerNext, out);
                     in_control = false;
                 }
                 // Lower case until \E.
                 else if (c == 'L') {
-                    trySetCaseChange(CaseChange_Lower);
+                    addCaseChange(Segment::StartCaseChange, CaseChange_Lower, out);
                     in_control = false;
                 }
                 // Upper case next character.
                 else if (c == 'u') {
-                    trySetCaseChange(CaseChange_UpperNext);
+                    addCaseChange(Segment::StartCaseChange, CaseChange_UpperNext, out);
                     in_control = false;
                 }
                 // Upper case until \E.
                 else if (c == 'U') {
-                    trySetCaseChange(CaseChange_Upper);
+                    addCaseChange(Segment::StartCaseChange, CaseChange_Upper, out);
                     in_control = false;
                 }
             }
@@ -192,7 +201,7 @@ bool PCREReplaceTextBuilder::BuildReplacementText(SPCRE &sre,
                             backref_name.clear();
                         } else {
                             in_control = false;
-                            accumulateReplcementText(invalid_contol);
+                            addLiteral(invalid_contol, out);
                         }
                     } else {
                         if ((c == '}' && backref_bracket_start_char == '{') ||
@@ -208,14 +217,7 @@ bool PCREReplaceTextBuilder::BuildReplacementText(SPCRE &sre,
                                 backref_number = sre.getCaptureStringNumber(backref_name);
                             }
 
-                            // Check if there is we have a back reference we can
-                            // actually get.
-                            if (backref_number >= 0 && backref_number < capture_groups_offsets.count()) {
-                                accumulateReplcementText(Utility::Substring(capture_groups_offsets.at(backref_number).first, capture_groups_offsets.at(backref_number).second, text));
-                            } else {
-                                accumulateReplcementText(invalid_contol);
-                            }
-
+                            addBackReference(backref_number, invalid_contol, out);
                             in_control = false;
                         } else {
                             backref_name += c;
@@ -226,17 +228,17 @@ bool PCREReplaceTextBuilder::BuildReplacementText(SPCRE &sre,
                         control_x_hex += c;
 
                         if (control_x_hex.count() == 2) {
-                            accumulateReplcementText(QChar(control_x_hex.toUInt(NULL, 16)));
+                            addLiteral(QChar(control_x_hex.toUInt(NULL, 16)), out);
                             in_control = false;
                         }
                     } else {
-                        accumulateReplcementText(invalid_contol);
+                        addLiteral(invalid_contol, out);
                         in_control = false;
                     }
                 }
                 // Invalid or unsupported control.
                 else {
-                    accumulateReplcementText(invalid_contol);
+                    addLiteral(invalid_contol, out);
                     in_control = false;
                 }
             }
@@ -256,7 +258,7 @@ bool PCREReplaceTextBuilder::BuildReplacementText(SPCRE &sre,
             }
             // Normal text.
             else {
-                accumulateReplcementText(c);
+                addLiteral(c, out);
             }
         }
     }
@@ -265,63 +267,110 @@ bool PCREReplaceTextBuilder::BuildReplacementText(SPCRE &sre,
     // a back reference then we have an invalid back reference because
     // it never ended. Put the invalid reference into the replacment string.
     if (in_control) {
-        accumulateReplcementText(invalid_contol);
+        addLiteral(invalid_contol, out);
     }
 
-    out = m_finalText;
     return true;
 }
 
-void PCREReplaceTextBuilder::accumulateReplcementText(const QChar &ch)
+void PCREReplaceTextBuilder::AppendReplacementText(const CompiledReplacement &replacement,
+        const QString &text,
+        int match_start,
+        const QList<std::pair<int, int>> &capture_groups_offsets,
+        QString &out)
 {
-    m_finalText += processTextSegement(ch);
+    m_caseChangeState = CaseChange_None;
+    foreach(const Segment & segment, replacement) {
+        switch (segment.type) {
+            case Segment::LiteralText:
+                appendTextSegment(QStringRef(&segment.text), out);
+                break;
+
+            case Segment::BackReference:
+
+                // Check if there is we have a back reference we can
+                // actually get.
+                if (segment.group >= 0 && segment.group < capture_groups_offsets.count()) {
+                    const std::pair<int, int> &group = capture_groups_offsets.at(segment.group);
+                    appendTextSegment(text.midRef(match_start + group.first, group.second - group.first), out);
+                } else {
+                    appendTextSegment(QStringRef(&segment.text), out);
+                }
+
+                break;
+
+            case Segment::StartCaseChange:
+                trySetCaseChange(segment.case_change);
+                break;
+
+            case Segment::EndCaseChange:
+                m_caseChangeState = CaseChange_None;
+                break;
+        }
+    }
 }
 
-void PCREReplaceTextBuilder::accumulateReplcementText(const QString &text)
+void PCREReplaceTextBuilder::addLiteral(const QString &text, CompiledReplacement &out)
 {
-    m_finalText += processTextSegement(text);
+    if (!out.isEmpty() && out.last().type == Segment::LiteralText) {
+        out.last().text += text;
+        return;
+    }
+
+    Segment segment;
+    segment.type = Segment::LiteralText;
+    segment.text = text;
+    out.append(segment);
 }
 
-QString PCREReplaceTextBuilder::processTextSegement(const QChar &ch)
+void PCREReplaceTextBuilder::addBackReference(int group, const QString &pattern_text, CompiledReplacement &out)
 {
-    return processTextSegement(QString(ch));
+    Segment segment;
+    segment.type = Segment::BackReference;
+    segment.text = pattern_text;
+    segment.group = group;
+    out.append(segment);
 }
 
-QString PCREReplaceTextBuilder::processTextSegement(const QString &text)
+void PCREReplaceTextBuilder::addCaseChange(Segment::Type type, CaseChange state, CompiledReplacement &out)
 {
-    QString processedText;
+    Segment segment;
+    segment.type = type;
+    segment.case_change = state;
+    out.append(segment);
+}
 
+void PCREReplaceTextBuilder::appendTextSegment(const QStringRef &text, QString &out)
+{
     if (text.length() == 0) {
-        return processedText;
+        return;
     }
 
     switch (m_caseChangeState) {
         case CaseChange_LowerNext:
-            processedText += text.at(0).toLower();
-            processedText += text.mid(1);
+            out += text.at(0).toLower();
+            out += QStringRef(text.string(), text.position() + 1, text.length() - 1);
             m_caseChangeState = CaseChange_None;
             break;
 
         case CaseChange_Lower:
-            processedText += text.toLower();
+            out += text.toString().toLower();
             break;
 
         case CaseChange_UpperNext:
-            processedText += text.at(0).toUpper();
-            processedText += text.mid(1);
+            out += text.at(0).toUpper();
+            out += QStringRef(text.string(), text.position() + 1, text.length() - 1);
             m_caseChangeState = CaseChange_None;
             break;
 
         case CaseChange_Upper:
-            processedText += text.toUpper();
+            out += text.toString().toUpper();
             break;
 
         default:
-            processedText += text;
+            out += text;
             break;
     }
-
-    return processedText;
 }
 
 void PCREReplaceTextBuilder::trySetCaseChange(CaseChange state)
@@ -331,8 +380,3 @@ void PCREReplaceTextBuilder::trySetCaseChange(CaseChange state)
     }
 }
 
-void PCREReplaceTextBuilder::resetState()
-{
-    m_finalText.clear();
-    m_caseChangeState = CaseChange_None;
-}
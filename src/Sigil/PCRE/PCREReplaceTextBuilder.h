@@ -32,10 +32,49 @@ class QChar;
 
 /**
  * Build replacement text from a given replacement pattern.
+ *
+ * The pattern can be parsed once with CompileReplacement() and then
+ * applied to any number of matches with AppendReplacementText().
  */
 class PCREReplaceTextBuilder
 {
 public:
+    /**
+     * The state of case changes.
+     */
+    enum CaseChange {
+        CaseChange_LowerNext,
+        CaseChange_Lower,
+        CaseChange_UpperNext,
+        CaseChange_Upper,
+        CaseChange_None
+    };
+
+    /**
+     * One piece of a parsed replacement pattern.
+     */
+    struct Segment {
+        enum Type {
+            LiteralText,
+            BackReference,
+            StartCaseChange,
+            EndCaseChange
+        };
+
+        Type type;
+        // The literal text. For a back reference, the pattern text
+        // that is used instead when the match has no such group.
+        QString text;
+        // The capture group of a back reference, -1 if the name is unknown.
+        int group;
+        // The case change to start.
+        CaseChange case_change;
+
+        Segment() : type(LiteralText), group(-1), case_change(CaseChange_None) {}
+    };
+
+    typedef QList<Segment> CompiledReplacement;
+
     /**
      * Constructor.
      */
@@ -60,58 +99,72 @@ public:
                               const QString &replacement_pattern,
                               QString &out);
 
-private:
     /**
-     * The state of case changes.
+     * Parse a replacement pattern into literal text, back references
+     * and case changes.
+     *
+     * @param sre The SPCRE the replacement is used with.
+     * @param replacement_pattern The replacement pattern.
+     * @param[out] out The parsed replacement.
+     *
+     * @return True if the SPCRE is valid and the replacement can be used.
      */
-    enum CaseChange {
-        CaseChange_LowerNext,
-        CaseChange_Lower,
-        CaseChange_UpperNext,
-        CaseChange_Upper,
-        CaseChange_None
-    };
+    bool CompileReplacement(SPCRE &sre,
+                            const QString &replacement_pattern,
+                            CompiledReplacement &out);
 
     /**
-     * Reset the state of the replacement process.
+     * Append the replacement text for one match.
+     *
+     * @param replacement The parsed replacement pattern.
+     * @param text The text that was searched.
+     * @param match_start The offset of the match within text.
+     * @param capture_groups_offsets The offsets within the match
+     * representing the captured subpatterns.
+     * @param[out] out The string the replacement is appended to.
      */
-    void resetState();
+    void AppendReplacementText(const CompiledReplacement &replacement,
+                               const QString &text,
+                               int match_start,
+                               const QList<std::pair<int, int>> &capture_groups_offsets,
+                               QString &out);
 
+private:
     /**
-     * Add to the final replacement text we are building.
-     *
-     * Processes by calling processTextSegement before adding.
+     * Add literal text to the replacement being compiled, merging it
+     * with the previous segment if that is literal text too.
      *
-     * @param ch The character to add.
+     * @param text The text to add.
+     * @param[out] out The replacement being compiled.
      */
-    void accumulateReplcementText(const QChar &ch);
+    void addLiteral(const QString &text, CompiledReplacement &out);
+
     /**
-     * Add to the final replacement text we are building.
-     *
-     * Processes by calling processTextSegement before adding.
+     * Add a back reference to the replacement being compiled.
      *
-     * @param text The text to add.
+     * @param group The capture group, -1 if it doesn't exist.
+     * @param pattern_text The back reference as written in the pattern.
+     * @param[out] out The replacement being compiled.
      */
-    void accumulateReplcementText(const QString &text);
+    void addBackReference(int group, const QString &pattern_text, CompiledReplacement &out);
 
     /**
-     * Processes the text segment making any changes necessary based upon
-     * the state.
-     *
-     * @param ch The character to process.
+     * Add the start or end of a case change to the replacement being compiled.
      *
-     * @return The processed and transformed text.
+     * @param type Segment::StartCaseChange or Segment::EndCaseChange.
+     * @param state The case change to start.
+     * @param[out] out The replacement being compiled.
      */
-    QString processTextSegement(const QChar &ch);
+    void addCaseChange(Segment::Type type, CaseChange state, CompiledReplacement &out);
+
     /**
-     * Processes the text segment making any changes necessary based upon
+     * Appends the text segment making any changes necessary based upon
      * the state.
      *
      * @param text The text to process.
-     *
-     * @return The processed and transformed text.
+     * @param[out] out The string the processed text is appended to.
      */
-    QString processTextSegement(const QString &text);
+    void appendTextSegment(const QStringRef &text, QString &out);
 
     /**
      * Change the case state if possible.
@@ -125,8 +178,6 @@ private:
 
     // Case change state.
     CaseChange m_caseChangeState;
-    // The final replacement text.
-    QString m_finalText;
 };
 
 #endif // PCREREPLACETEXTBUILDER_H
@@ -211,6 +211,32 @@ bool SPCRE::replaceText(const QString &text, const QList<std::pair<int, int>> &c
     return builder.BuildReplacementText(*this, text, capture_groups_offsets, replacement_pattern, out);
 }
 
+int SPCRE::replaceMatches(const QString &text, const QList<MatchInfo> &matches, const QString &replacement_pattern, QString &out)
+{
+    PCREReplaceTextBuilder builder;
+    PCREReplaceTextBuilder::CompiledReplacement replacement;
+
+    if (matches.isEmpty() || !builder.CompileReplacement(*this, replacement_pattern, replacement)) {
+        out = text;
+        return 0;
+    }
+
+    int matched_length = 0;
+    foreach(const MatchInfo & match, matches) {
+        matched_length += match.offset.second - match.offset.first;
+    }
+    out.clear();
+    out.reserve(text.length() - matched_length + matches.count() * replacement_pattern.length());
+    int copied_to = 0;
+    foreach(const MatchInfo & match, matches) {
+        out += text.midRef(copied_to, match.offset.first - copied_to);
+        builder.AppendReplacementText(replacement, text, match.offset.first, match.capture_groups_offsets, out);
+        copied_to = match.offset.second;
+    }
+    out += text.midRef(copied_to);
+    return matches.count();
+}
+
 SPCRE::MatchInfo SPCRE::generateMatchInfo(int ovector[], int ovector_count)
 {
     MatchInfo match_info;
@@ -142,6 +142,22 @@ public:
      */
     bool replaceText(const QString &text, const QList<std::pair<int, int>> &capture_groups_offsets, const QString &replacement_pattern, QString &out);
 
+    /**
+     * Replaces every given match within the text. The replacement pattern
+     * is parsed once and the new text is built in a single forward pass,
+     * so the cost does not grow with the number of matches times the
+     * length of the text.
+     *
+     * @param text The text the matches were found in.
+     * @param matches The matches to replace, in the order they occur.
+     * @param replacement_pattern The pattern / text to use to create the
+     * replacement text.
+     * @param[out] out The text with the replacements made. Must not be text.
+     *
+     * @return The number of replacements made.
+     */
+    int replaceMatches(const QString &text, const QList<MatchInfo> &matches, const QString &replacement_pattern, QString &out);
+
 private:
     MatchInfo generateMatchInfo(int ovector[], int ovector_count);
 
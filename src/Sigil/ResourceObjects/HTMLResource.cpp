@@ -31,6 +31,7 @@
 #include "BookManipulation/XercesCppUse.h"
 #include "BookManipulation/XhtmlDoc.h"
 #include "Misc/Utility.h"
+#include "ResourceObjects/CSSResource.h"
 #include "ResourceObjects/HTMLResource.h"
 #include "sigil_exception.h"
 
@@ -47,7 +48,8 @@ HTMLResource::HTMLResource(const QString &mainfolder, const QString &fullfilepat
                            QObject *parent)
     :
     XMLResource(mainfolder, fullfilepath, parent),
-    m_Resources(resources)
+    m_Resources(resources),
+    m_CachedHeadingsVersion(-1)
 {
 }
 
@@ -60,8 +62,10 @@ Resource::ResourceType HTMLResource::Type() const
 bool HTMLResource::LoadFromDisk()
 {
     try {
-        const QString &text = Utility::ReadUnicodeTextFile(GetFullPath());
+        QByteArray content_hash;
+        const QString &text = Utility::ReadUnicodeTextFile(GetFullPath(), &content_hash);
         SetText(text);
+        MarkTextAsOnDisk(content_hash);
         emit LoadedFromDisk();
         return true;
     } catch (CannotOpenFile) {
@@ -85,7 +89,12 @@ void HTMLResource::SetText(const QString &text)
 
 void HTMLResource::SaveToDisk(bool book_wide_save)
 {
-    SetText(GetText());
+    // Edits made in Code View don't go through SetText(), so pick up
+    // their links here. Setting the same text again would reload the document.
+    if (IsDirty()) {
+        TrackNewResources(GetPathsToLinkedResources());
+    }
+
     XMLResource::SaveToDisk(book_wide_save);
 }
 
@@ -142,7 +151,7 @@ void HTMLResource::TrackNewResources(const QStringList &filepaths)
         filenames.append(QFileInfo(filepath).fileName());
     }
     foreach(Resource * resource, m_Resources.values()) {
-        disconnect(resource, SIGNAL(ResourceUpdatedOnDisk()),    this, SIGNAL(LinkedResourceUpdated()));
+        disconnect(resource, SIGNAL(ResourceUpdatedOnDisk()),    this, SLOT(LinkedResourceUpdatedOnDisk()));
         disconnect(resource, SIGNAL(Deleted(const Resource &)), this, SIGNAL(LinkedResourceUpdated()));
 
         if (filenames.contains(resource->Filename())) {
@@ -153,12 +162,24 @@ void HTMLResource::TrackNewResources(const QStringList &filepaths)
         Resource *resource = m_Resources.value(resource_id);
 
         if (resource) {
-            connect(resource, SIGNAL(ResourceUpdatedOnDisk()),    this, SIGNAL(LinkedResourceUpdated()));
+            connect(resource, SIGNAL(ResourceUpdatedOnDisk()),    this, SLOT(LinkedResourceUpdatedOnDisk()));
             connect(resource, SIGNAL(Deleted(const Resource &)), this, SIGNAL(LinkedResourceUpdated()));
         }
     }
 }
 
+void HTMLResource::LinkedResourceUpdatedOnDisk()
+{
+    // Views can swap in a changed stylesheet without reloading the page
+    CSSResource *css_resource = qobject_cast<CSSResource *>(sender());
+
+    if (css_resource) {
+        emit LinkedStylesheetUpdated(css_resource->GetFullPath());
+    } else {
+        emit LinkedResourceUpdated();
+    }
+}
+
 bool HTMLResource::DeleteCSStyles(QList<CSSInfo::CSSSelector *> css_selectors)
 {
     CSSInfo css_info(GetText(), false);
@@ -174,3 +195,24 @@ bool HTMLResource::DeleteCSStyles(QList<CSSInfo::CSSSelector *> css_selectors)
 
     return false;
 }
+
+
+bool HTMLResource::GetCachedHeadings(int text_version, QList<Headings::Heading> &headings) const
+{
+    QMutexLocker locker(&m_CachedHeadingsMutex);
+
+    if (m_CachedHeadingsVersion != text_version) {
+        return false;
+    }
+
+    headings = m_CachedHeadings;
+    return true;
+}
+
+
+void HTMLResource::SetCachedHeadings(int text_version, const QList<Headings::Heading> &headings)
+{
+    QMutexLocker locker(&m_CachedHeadingsMutex);
+    m_CachedHeadings = headings;
+    m_CachedHeadingsVersion = text_version;
+}
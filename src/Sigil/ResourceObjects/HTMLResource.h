@@ -24,9 +24,11 @@
 #define HTMLRESOURCE_H
 
 #include <QtCore/QHash>
+#include <QtCore/QMutex>
 
 #include "Misc/CSSInfo.h"
 #include "BookManipulation/GuideSemantics.h"
+#include "BookManipulation/Headings.h"
 #include "ResourceObjects/XMLResource.h"
 
 class QString;
@@ -100,11 +102,36 @@ public:
 
     bool DeleteCSStyles(QList<CSSInfo::CSSSelector *> css_selectors);
 
+    /**
+     * Gets the headings cached by SetCachedHeadings().
+     * Can be called from any thread.
+     *
+     * @param text_version The current text version of the resource.
+     * @param headings Filled with the cached headings.
+     * @return \c true if the headings were read from this text version.
+     */
+    bool GetCachedHeadings(int text_version, QList<Headings::Heading> &headings) const;
+
+    /**
+     * Caches the headings read from the given text version.
+     * Can be called from any thread.
+     */
+    void SetCachedHeadings(int text_version, const QList<Headings::Heading> &headings);
+
 signals:
     void LinkedResourceUpdated();
+
+    /**
+     * Emitted instead of LinkedResourceUpdated() when
+     * the updated resource is a stylesheet.
+     */
+    void LinkedStylesheetUpdated(const QString &path);
     void TextChanging();
     void LoadedFromDisk();
 
+private slots:
+    void LinkedResourceUpdatedOnDisk();
+
 private:
     /**
      * Makes sure the given paths are watched for updates.
@@ -122,6 +149,14 @@ private:
      * @todo This is ugly as hell. Find a way to remove this.
      */
     const QHash<QString, Resource *> &m_Resources;
+
+    /**
+     * The headings found in the text by Headings,
+     * and the text version they were read from.
+     */
+    QList<Headings::Heading> m_CachedHeadings;
+    int m_CachedHeadingsVersion;
+    mutable QMutex m_CachedHeadingsMutex;
 };
 
 #endif // HTMLRESOURCE_H
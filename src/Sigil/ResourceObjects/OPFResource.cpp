@@ -28,6 +28,7 @@
 #include <QtCore/QDate>
 #include <QtCore/QDir>
 #include <QtCore/QFileInfo>
+#include <QtCore/QSet>
 #include <QtCore/QUuid>
 #include <QRegularExpression>
 
@@ -204,10 +205,16 @@ QString OPFResource::GetMainIdentifierValue() const
 
 void OPFResource::SaveToDisk(bool book_wide_save)
 {
-    QString text = GetText();
+    QString original_text = GetText();
+    QString text = original_text;
     // Work around for covers appearing on the Nook. Issue 942.
     text = text.replace(QRegularExpression("<meta content=\"([^\"]+)\" name=\"cover\""), "<meta name=\"cover\" content=\"\\1\"");
-    SetText(text);
+
+    // Resetting unchanged text would only bump the text version
+    if (text != original_text) {
+        SetText(text);
+    }
+
     TextResource::SaveToDisk(book_wide_save);
 }
 
@@ -507,6 +514,7 @@ void OPFResource::AddResource(const Resource &resource)
     }
 
     UpdateTextFromDom(*document);
+    emit StructureChanged();
 }
 
 void OPFResource::RemoveCoverMetaForImage(const Resource &resource, xc::DOMDocument &document)
@@ -572,6 +580,7 @@ void OPFResource::RemoveResource(const Resource &resource)
     }
 
     UpdateTextFromDom(*document);
+    emit StructureChanged();
 }
 
 
@@ -594,6 +603,7 @@ void OPFResource::AddGuideSemanticType(
     }
 
     UpdateTextFromDom(*document);
+    emit StructureChanged();
 }
 
 
@@ -609,6 +619,7 @@ void OPFResource::SetResourceAsCoverImage(const ::ImageResource &image_resource)
     }
 
     UpdateTextFromDom(*document);
+    emit StructureChanged();
 }
 
 
@@ -630,44 +641,93 @@ void OPFResource::UpdateSpineOrder(const QList<::HTMLResource *> html_files)
         }
     }
     UpdateTextFromDom(*document);
+    emit StructureChanged();
 }
 
 
 void OPFResource::ResourceRenamed(const Resource &resource, QString old_full_path)
+{
+    QHash<const Resource *, QString> old_full_paths;
+    old_full_paths[ &resource ] = old_full_path;
+    ResourcesRenamed(old_full_paths);
+}
+
+
+void OPFResource::ResourcesRenamed(const QHash<const Resource *, QString> &old_full_paths)
 {
     QWriteLocker locker(&GetLock());
     shared_ptr<xc::DOMDocument> document = GetDocument();
     QString path_to_oebps_folder = QFileInfo(GetFullPath()).absolutePath() + "/";
-    QString resource_oebps_path  = Utility::URLEncodePath(QString(old_full_path).remove(path_to_oebps_folder));
     QList<xc::DOMElement *> items =
         XhtmlDoc::GetTagMatchingDescendants(*document, "item", OPF_XML_NAMESPACE);
-    QString old_id;
-    QString new_id;
+    QHash<QString, xc::DOMElement *> items_by_href;
     foreach(xc::DOMElement * item, items) {
-        QString href = XtoQ(item->getAttribute(QtoX("href")));
+        items_by_href[ XtoQ(item->getAttribute(QtoX("href"))) ] = item;
+    }
+    // New ids must not clash with any id in the OPF,
+    // not just the manifest ones (dc:identifier, meta and so on).
+    QSet<QString> used_ids;
+    foreach(xc::DOMElement * element, XhtmlDoc::GetTagMatchingDescendants(*document, "*")) {
+        if (element->hasAttribute(QtoX("id"))) {
+            used_ids.insert(XtoQ(element->getAttribute(QtoX("id"))));
+        }
+    }
+    // The new manifest ids keyed by the old ones
+    QHash<QString, QString> new_ids;
+    QHashIterator<const Resource *, QString> it(old_full_paths);
 
-        if (href == resource_oebps_path) {
-            item->setAttribute(QtoX("href"), QtoX(Utility::URLEncodePath(resource.GetRelativePathToOEBPS())));
-            old_id = XtoQ(item->getAttribute(QtoX("id")));
-            new_id = GetUniqueID(GetValidID(resource.Filename()), *document);
-            item->setAttribute(QtoX("id"), QtoX(new_id));
-            break;
+    while (it.hasNext()) {
+        it.next();
+        const Resource &resource = *it.key();
+        QString resource_oebps_path = Utility::URLEncodePath(QString(it.value()).remove(path_to_oebps_folder));
+        xc::DOMElement *item = items_by_href.value(resource_oebps_path, NULL);
+
+        if (!item) {
+            continue;
+        }
+
+        item->setAttribute(QtoX("href"), QtoX(Utility::URLEncodePath(resource.GetRelativePathToOEBPS())));
+        QString old_id = XtoQ(item->getAttribute(QtoX("id")));
+        used_ids.remove(old_id);
+        QString new_id = GetValidID(resource.Filename());
+
+        if (used_ids.contains(new_id)) {
+            new_id = Utility::CreateUUID();
+        }
+
+        used_ids.insert(new_id);
+        item->setAttribute(QtoX("id"), QtoX(new_id));
+        new_ids[ old_id ] = new_id;
+
+        if (resource.Type() == Resource::ImageResourceType) {
+            // Change meta entry for cover if necessary
+            // Check using IDs since file is already renamed
+            if (IsCoverImageCheck(old_id, *document)) {
+                // Add will automatically replace an existing id
+                // Assumes only one cover but removing duplicates
+                // can cause timing issues
+                AddCoverMetaForImage(resource, *document);
+            }
         }
     }
-    UpdateItemrefID(old_id, new_id, *document);
 
-    if (resource.Type() == Resource::ImageResourceType) {
-        // Change meta entry for cover if necessary
-        // Check using IDs since file is already renamed
-        if (IsCoverImageCheck(old_id, *document)) {
-            // Add will automatically replace an existing id
-            // Assumes only one cover but removing duplicates
-            // can cause timing issues
-            AddCoverMetaForImage(resource, *document);
+    // Each itemref is looked up by its original idref only once,
+    // so ids that move from one file to another are handled correctly.
+    xc::DOMElement *spine = GetSpineElement(*document);
+
+    if (spine) {
+        std::vector<xc::DOMElement *> children = xe::GetElementChildren(*spine);
+        foreach(xc::DOMElement * child, children) {
+            QString idref = XtoQ(child->getAttribute(QtoX("idref")));
+
+            if (new_ids.contains(idref)) {
+                child->setAttribute(QtoX("idref"), QtoX(new_ids.value(idref)));
+            }
         }
     }
 
     UpdateTextFromDom(*document);
+    emit StructureChanged();
 }
 
 
@@ -703,21 +763,6 @@ void OPFResource::RemoveFromSpine(const QString &id, xc::DOMDocument &document)
 }
 
 
-void OPFResource::UpdateItemrefID(const QString &old_id, const QString &new_id, xc::DOMDocument &document)
-{
-    xc::DOMElement *spine = GetSpineElement(document);
-    std::vector<xc::DOMElement *> children = xe::GetElementChildren(*spine);
-    foreach(xc::DOMElement * child, children) {
-        QString idref = XtoQ(child->getAttribute(QtoX("idref")));
-
-        if (idref == old_id) {
-            child->setAttribute(QtoX("idref"), QtoX(new_id));
-            break;
-        }
-    }
-}
-
-
 shared_ptr<xc::DOMDocument> OPFResource::GetDocument() const
 {
     // The call to ProcessXML is needed because even though we have well-formed
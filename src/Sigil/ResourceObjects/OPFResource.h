@@ -151,14 +151,30 @@ public slots:
 
     void ResourceRenamed(const Resource &resource, QString old_full_path);
 
+    /**
+     * Updates the manifest and spine for several renamed resources
+     * in a single pass over the OPF.
+     *
+     * @param old_full_paths The full paths the resources had before the rename.
+     */
+    void ResourcesRenamed(const QHash<const Resource *, QString> &old_full_paths);
+
+signals:
+
+    /**
+     * Emitted after the manifest, spine or guide was changed
+     * by one of the slots above. It is emitted from whichever thread
+     * made the change while the OPF is still locked, so receivers
+     * should use a queued connection.
+     */
+    void StructureChanged();
+
 private:
 
     static void AppendToSpine(const QString &id, xc::DOMDocument &document);
 
     static void RemoveFromSpine(const QString &id, xc::DOMDocument &document);
 
-    static void UpdateItemrefID(const QString &old_id, const QString &new_id, xc::DOMDocument &document);
-
     boost::shared_ptr<xc::DOMDocument> GetDocument() const;
 
     static xc::DOMElement *GetPackageElement(const xc::DOMDocument &document);
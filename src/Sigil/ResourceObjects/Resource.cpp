@@ -162,6 +162,11 @@ bool Resource::LoadFromDisk()
     return false;
 }
 
+bool Resource::IsDirty() const
+{
+    return false;
+}
+
 void Resource::SaveToDisk(bool book_wide_save)
 {
     const QDateTime lastModifiedDate = QFileInfo(m_FullFilePath).lastModified();
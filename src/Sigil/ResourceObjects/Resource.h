@@ -179,6 +179,14 @@ public:
      */
     virtual void SaveToDisk(bool book_wide_save = false);
 
+    /**
+     * Returns whether the resource holds changes in memory
+     * that SaveToDisk() has not written out yet.
+     * The default implementation returns \c false since
+     * the resource data is not being cached in memory.
+     */
+    virtual bool IsDirty() const;
+
     /**
      * Called by FolderKeeper when files get changed on disk.
      * May trigger a resource internal update if the files were not changed by Sigil.
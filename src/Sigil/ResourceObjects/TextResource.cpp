@@ -19,7 +19,9 @@
 **
 *************************************************************************/
 
+#include <QtCore/QDateTime>
 #include <QtCore/QFile>
+#include <QtCore/QFileInfo>
 #include <QtCore/QString>
 #include <QtCore/QThread>
 #include <QtCore/QTimer>
@@ -36,10 +38,16 @@ TextResource::TextResource(const QString &mainfolder, const QString &fullfilepat
     Resource(mainfolder, fullfilepath, parent),
     m_CacheInUse(false),
     m_TextDocument(new QTextDocument(this)),
-    m_IsLoaded(false)
+    m_IsLoaded(false),
+    m_TextVersion(0),
+    m_SavedTextVersion(0),
+    m_DiskContentModified(0),
+    m_DiskContentSize(-1),
+    m_SettingText(false)
 {
     m_TextDocument->setDocumentLayout(new QPlainTextDocumentLayout(m_TextDocument));
     connect(m_TextDocument, SIGNAL(contentsChanged()), this, SIGNAL(Modified()));
+    connect(m_TextDocument, SIGNAL(contentsChanged()), this, SLOT(TextDocumentChanged()));
 }
 
 
@@ -69,9 +77,11 @@ void TextResource::SetText(const QString &text)
     // of that.
     if (QThread::currentThread() == QApplication::instance()->thread()) {
         SetTextInternal(text);
+        m_TextVersion.ref();
     } else {
         QMutexLocker locker(&m_CacheAccessMutex);
         m_Cache = text;
+        m_TextVersion.ref();
 
         // We want to make sure we schedule only one delayed update
         if (!m_CacheInUse) {
@@ -82,6 +92,20 @@ void TextResource::SetText(const QString &text)
 }
 
 
+void TextResource::MarkTextAsOnDisk(const QByteArray &content_hash)
+{
+    RecordDiskContent(content_hash);
+    m_SavedTextVersion.store(m_TextVersion.load());
+    m_TextDocument->setModified(false);
+}
+
+
+int TextResource::GetTextVersion() const
+{
+    return m_TextVersion.load();
+}
+
+
 QTextDocument &TextResource::GetTextDocumentForWriting()
 {
     Q_ASSERT(m_TextDocument);
@@ -99,12 +123,24 @@ void TextResource::SaveToDisk(bool book_wide_save)
     // here because that causes problems with epub export
     // when the user has not changed the text file.
     // (some text files have placeholder text on disk)
+    // Comparing against a hash of what is on disk is safe though.
+    bool written = false;
     {
         QWriteLocker locker(&GetLock());
-        Utility::WriteUnicodeTextFile(GetText(), GetFullPath());
+        int version = m_TextVersion.load();
+        QByteArray data = Utility::EncodeUnicodeText(GetText());
+        QByteArray content_hash = Utility::ContentHash(data.constData(), data.size());
+
+        if (!DiskContentMatches(content_hash)) {
+            Utility::WriteFileAtomically(data, GetFullPath());
+            RecordDiskContent(content_hash);
+            written = true;
+        }
+
+        m_SavedTextVersion.store(version);
     }
 
-    if (!book_wide_save) {
+    if (written && !book_wide_save) {
         emit ResourceUpdatedOnDisk();
     }
 
@@ -113,6 +149,12 @@ void TextResource::SaveToDisk(bool book_wide_save)
 }
 
 
+bool TextResource::IsDirty() const
+{
+    return m_TextVersion.load() != m_SavedTextVersion.load();
+}
+
+
 void TextResource::InitialLoad()
 {
     /**
@@ -139,7 +181,11 @@ void TextResource::InitialLoad()
     Q_ASSERT(m_TextDocument);
 
     if (m_TextDocument->toPlainText().isEmpty() && QFile::exists(GetFullPath())) {
-        SetText(Utility::ReadUnicodeTextFile(GetFullPath()));
+        QByteArray content_hash;
+        SetText(Utility::ReadUnicodeTextFile(GetFullPath(), &content_hash));
+        RecordDiskContent(content_hash);
+        // The text is what is on disk
+        m_SavedTextVersion.store(m_TextVersion.load());
     }
 }
 
@@ -152,9 +198,13 @@ Resource::ResourceType TextResource::Type() const
 bool TextResource::LoadFromDisk()
 {
     try {
-        const QString &text = Utility::ReadUnicodeTextFile(GetFullPath());
+        QByteArray content_hash;
+        const QString &text = Utility::ReadUnicodeTextFile(GetFullPath(), &content_hash);
+        RecordDiskContent(content_hash);
         QMutexLocker locker(&m_CacheAccessMutex);
         m_Cache = text;
+        m_TextVersion.ref();
+        m_SavedTextVersion.store(m_TextVersion.load());
 
         // We want to make sure we schedule only one delayed update
         if (!m_CacheInUse) {
@@ -183,9 +233,19 @@ void TextResource::DelayedUpdateToTextDocument()
 }
 
 
+void TextResource::TextDocumentChanged()
+{
+    if (!m_SettingText) {
+        m_TextVersion.ref();
+    }
+}
+
+
 void TextResource::SetTextInternal(const QString &text)
 {
+    m_SettingText = true;
     m_TextDocument->setPlainText(text);
+    m_SettingText = false;
     m_TextDocument->setModified(false);
     // Clear anything left in the cache
     m_Cache = "";
@@ -194,6 +254,35 @@ void TextResource::SetTextInternal(const QString &text)
     m_IsLoaded = true;
 }
 
+
+void TextResource::RecordDiskContent(const QByteArray &content_hash)
+{
+    QFileInfo fileinfo(GetFullPath());
+    const QDateTime lastModifiedDate = fileinfo.lastModified();
+    QMutexLocker locker(&m_CacheAccessMutex);
+    m_DiskContentHash = content_hash;
+    m_DiskContentModified = lastModifiedDate.isValid() ? lastModifiedDate.toMSecsSinceEpoch() : 0;
+    m_DiskContentSize = fileinfo.exists() ? fileinfo.size() : -1;
+}
+
+
+bool TextResource::DiskContentMatches(const QByteArray &content_hash) const
+{
+    QFileInfo fileinfo(GetFullPath());
+
+    if (!fileinfo.exists()) {
+        return false;
+    }
+
+    const QDateTime lastModifiedDate = fileinfo.lastModified();
+    QMutexLocker locker(&m_CacheAccessMutex);
+    return !m_DiskContentHash.isEmpty() &&
+           m_DiskContentHash == content_hash &&
+           m_DiskContentSize == fileinfo.size() &&
+           lastModifiedDate.isValid() &&
+           m_DiskContentModified == lastModifiedDate.toMSecsSinceEpoch();
+}
+
 bool TextResource::IsLoaded()
 {
     return m_IsLoaded;
@@ -23,6 +23,7 @@
 #ifndef TEXTRESOURCE_H
 #define TEXTRESOURCE_H
 
+#include <QtCore/QAtomicInt>
 #include <QtCore/QMutex>
 
 #include "ResourceObjects/Resource.h"
@@ -60,6 +61,24 @@ public:
      */
     void SetText(const QString &text);
 
+    /**
+     * Marks the current text as being what is on disk, so the
+     * resource is no longer dirty. Call right after setting text
+     * that was read from the resource file.
+     *
+     * @param content_hash The hash of the file content that was read.
+     */
+    void MarkTextAsOnDisk(const QByteArray &content_hash);
+
+    /**
+     * Returns a number that changes every time the text changes.
+     * Lets consumers cache data derived from the text and know
+     * when that data has gone stale without comparing the text itself.
+     *
+     * @return The current text version.
+     */
+    int GetTextVersion() const;
+
     /**
      * Returns a reference to the QTextDocument that can be read and written to
      * in consumers. If you need just read access, use GetTextDocumentForReading().
@@ -73,6 +92,9 @@ public:
     // inherited
     void SaveToDisk(bool book_wide_save = false);
 
+    // inherited
+    bool IsDirty() const;
+
     /**
      * Loads the text content into the QTextDocument cache if
      * nothing has been loaded so far. This is not done automatically
@@ -96,6 +118,11 @@ private slots:
      */
     void DelayedUpdateToTextDocument();
 
+    /**
+     * Bumps the text version whenever the QTextDocument changes.
+     */
+    void TextDocumentChanged();
+
 private:
 
     /**
@@ -105,6 +132,18 @@ private:
      */
     void SetTextInternal(const QString &text);
 
+    /**
+     * Remembers the hash of what is now on disk, along with
+     * the file modification time and size it was seen with.
+     */
+    void RecordDiskContent(const QByteArray &content_hash);
+
+    /**
+     * Returns \c true if the file on disk already holds content
+     * with the given hash, so there is no need to write it.
+     */
+    bool DiskContentMatches(const QByteArray &content_hash) const;
+
 
     ///////////////////////////////
     // PRIVATE MEMBER VARIABLES
@@ -131,6 +170,31 @@ private:
     QTextDocument *m_TextDocument;
 
     bool m_IsLoaded;
+
+    /**
+     * Incremented on every change to the text. @see GetTextVersion()
+     */
+    QAtomicInt m_TextVersion;
+
+    /**
+     * The text version that was last written to or read from disk.
+     */
+    QAtomicInt m_SavedTextVersion;
+
+    /**
+     * The content hash of the file as last read or written by us.
+     * Only trusted while the file still has the modification time and size
+     * it had then, since the file can be replaced behind our back.
+     */
+    QByteArray m_DiskContentHash;
+    qint64 m_DiskContentModified;
+    qint64 m_DiskContentSize;
+
+    /**
+     * \c true while SetTextInternal() is replacing the document text.
+     * The callers account for that change themselves.
+     */
+    bool m_SettingText;
 };
 
 #endif // TEXTRESOURCE_H
@@ -32,6 +32,8 @@
 #include "BookManipulation/XercesCppUse.h"
 #include "BookManipulation/XhtmlDoc.h"
 #include "Misc/HTMLEncodingResolver.h"
+#include "Misc/MultiStringMatcher.h"
+#include "Misc/SettingsSnapshot.h"
 #include "Misc/SettingsStore.h"
 #include "Misc/Utility.h"
 #include "ResourceObjects/OPFResource.h"
@@ -86,9 +88,20 @@ QStringList UniversalUpdates::PerformUniversalUpdates(bool resources_already_loa
     QFuture<QString> html_future;
     QFuture<void> css_future;
 
+    // When updating loaded files, those that don't mention any of the updated
+    // file names are left alone instead of going through a full parse and rewrite.
+    QStringList needles;
+
+    if (resources_already_loaded) {
+        needles = GetReferenceNeedles(updates);
+    }
+
+    MultiStringMatcher reference_filter(needles);
+    const MultiStringMatcher *prefilter = needles.isEmpty() ? NULL : &reference_filter;
+
     if (resources_already_loaded) {
-        html_future = QtConcurrent::mapped(html_resources, boost::bind(UpdateOneHTMLFile, _1, html_updates, css_updates));
-        css_future = QtConcurrent::map(css_resources,  boost::bind(UpdateOneCSSFile,  _1, css_updates));
+        html_future = QtConcurrent::mapped(html_resources, boost::bind(UpdateOneHTMLFile, _1, html_updates, css_updates, prefilter));
+        css_future = QtConcurrent::map(css_resources,  boost::bind(UpdateOneCSSFile,  _1, css_updates, prefilter));
     } else {
         html_future = QtConcurrent::mapped(html_resources, boost::bind(LoadAndUpdateOneHTMLFile, _1, html_updates, css_updates, non_well_formed));
         css_future = QtConcurrent::map(css_resources,  boost::bind(LoadAndUpdateOneCSSFile,  _1, css_updates));
@@ -161,9 +174,43 @@ tuple <QHash<QString, QString>,
 }
 
 
+QStringList UniversalUpdates::GetReferenceNeedles(const QHash<QString, QString> &updates)
+{
+    QStringList needles;
+    foreach(QString key_path, updates.keys()) {
+        // Only the longest run of characters that are never URL encoded is
+        // looked for, so both raw and encoded references are found.
+        const QString &filename = QFileInfo(key_path).fileName();
+        QString needle;
+        QString run;
+
+        foreach(QChar c, filename + QChar('/')) {
+            if (c.unicode() < 128 && (c.isLetterOrNumber() || c == '.' || c == '-' || c == '_' || c == '~')) {
+                run.append(c);
+            } else {
+                if (run.length() > needle.length()) {
+                    needle = run;
+                }
+
+                run.clear();
+            }
+        }
+
+        // Without a usable needle every file has to be checked the slow way
+        if (needle.isEmpty()) {
+            return QStringList();
+        }
+
+        needles.append(needle);
+    }
+    return needles;
+}
+
+
 QString UniversalUpdates::UpdateOneHTMLFile(HTMLResource *html_resource,
         const QHash<QString, QString> &html_updates,
-        const QHash<QString, QString> &css_updates)
+        const QHash<QString, QString> &css_updates,
+        const MultiStringMatcher *prefilter)
 {
     if (!html_resource) {
         return QString();
@@ -171,7 +218,13 @@ QString UniversalUpdates::UpdateOneHTMLFile(HTMLResource *html_resource,
 
     try {
         QWriteLocker locker(&html_resource->GetLock());
-        shared_ptr<xc::DOMDocument> d = XhtmlDoc::LoadTextIntoDocument(html_resource->GetText());
+        const QString &source = html_resource->GetText();
+
+        if (prefilter && !prefilter->ContainsAny(source)) {
+            return QString();
+        }
+
+        shared_ptr<xc::DOMDocument> d = XhtmlDoc::LoadTextIntoDocument(source);
         shared_ptr<xc::DOMDocument> u = PerformHTMLUpdates(*d.get(), html_updates, css_updates)();
         html_resource->SetText(XhtmlDoc::GetDomDocumentAsString(*u.get()));
         return QString();
@@ -185,7 +238,8 @@ QString UniversalUpdates::UpdateOneHTMLFile(HTMLResource *html_resource,
 
 
 void UniversalUpdates::UpdateOneCSSFile(CSSResource *css_resource,
-                                        const QHash<QString, QString> &css_updates)
+                                        const QHash<QString, QString> &css_updates,
+                                        const MultiStringMatcher *prefilter)
 {
     if (!css_resource) {
         return;
@@ -193,6 +247,11 @@ void UniversalUpdates::UpdateOneCSSFile(CSSResource *css_resource,
 
     QWriteLocker locker(&css_resource->GetLock());
     const QString &source = css_resource->GetText();
+
+    if (prefilter && !prefilter->ContainsAny(source)) {
+        return;
+    }
+
     css_resource->SetText(PerformCSSUpdates(source, css_updates)());
 }
 
@@ -201,7 +260,7 @@ QString UniversalUpdates::LoadAndUpdateOneHTMLFile(HTMLResource *html_resource,
         const QHash<QString, QString> &css_updates,
         const QList<XMLResource *> &non_well_formed)
 {
-    SettingsStore ss;
+    int clean_on = SettingsSnapshot::instance()->cleanOn();
     QString source;
 
     if (!html_resource) {
@@ -218,7 +277,7 @@ QString UniversalUpdates::LoadAndUpdateOneHTMLFile(HTMLResource *html_resource,
         source = XhtmlDoc::ResolveCustomEntities(html_resource->GetText());
         source = CleanSource::CharToEntity(source);
 
-        if (ss.cleanOn() & CLEANON_OPEN) {
+        if (clean_on & CLEANON_OPEN) {
             source = CleanSource::Clean(source);
         }
         // Even though well formed checks might have already run we need to double check because cleaning might
@@ -230,7 +289,7 @@ QString UniversalUpdates::LoadAndUpdateOneHTMLFile(HTMLResource *html_resource,
         source = XhtmlDoc::GetDomDocumentAsString(*PerformHTMLUpdates(source, html_updates, css_updates)().get());
         // For files that are valid we need to do a second clean because Xerces (PerformHTMLUpdates) will remove
         // the formatting.
-        if (ss.cleanOn() & CLEANON_OPEN) {
+        if (clean_on & CLEANON_OPEN) {
             source = CleanSource::Clean(source);
         }
         html_resource->SetText(source);
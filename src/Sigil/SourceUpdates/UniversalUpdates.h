@@ -25,6 +25,7 @@
 
 class CSSResource;
 class HTMLResource;
+class MultiStringMatcher;
 class XMLResource;
 class NCXResource;
 class OPFResource;
@@ -52,12 +53,19 @@ public:
 
 private:
 
+    // Returns the strings one of which every file referencing an
+    // updated path has to contain, or an empty list if there are none.
+    static QStringList GetReferenceNeedles(const QHash<QString, QString> &updates);
+
+    // Files not matching the prefilter are skipped; NULL updates every file.
     static QString UpdateOneHTMLFile(HTMLResource *html_resource,
                                      const QHash<QString, QString> &html_updates,
-                                     const QHash<QString, QString> &css_updates);
+                                     const QHash<QString, QString> &css_updates,
+                                     const MultiStringMatcher *prefilter);
 
     static void UpdateOneCSSFile(CSSResource *css_resource,
-                                 const QHash<QString, QString> &css_updates);
+                                 const QHash<QString, QString> &css_updates,
+                                 const MultiStringMatcher *prefilter);
 
     static QString LoadAndUpdateOneHTMLFile(HTMLResource *html_resource,
                                             const QHash<QString, QString> &html_updates,
@@ -25,29 +25,38 @@
 #include <QtCore/QString>
 #include <QtConcurrent/QtConcurrent>
 
-#include "Misc/HTMLSpellCheck.h"
+#include "BookManipulation/WordIndex.h"
 #include "ResourceObjects/HTMLResource.h"
 #include "SourceUpdates/WordUpdates.h"
 
-void WordUpdates::UpdateWordInAllFiles(const QList<HTMLResource *> &html_resources, const QString old_word, QString new_word)
+using boost::make_tuple;
+using boost::tie;
+using boost::tuple;
+
+void WordUpdates::UpdateWordInAllFiles(const WordIndex &word_index, const QString old_word, QString new_word)
 {
-    QtConcurrent::blockingMap(html_resources, boost::bind(UpdateWordsInOneFile, _1, old_word, new_word));
+    QList<tuple<HTMLResource *, QList<int>>> occurrences;
+    foreach(HTMLResource * html_resource, word_index.GetFilesContaining(old_word)) {
+        occurrences.append(make_tuple(html_resource, word_index.GetOffsets(html_resource, old_word)));
+    }
+    QtConcurrent::blockingMap(occurrences, boost::bind(UpdateWordsInOneFile, _1, old_word, new_word));
 }
 
-void WordUpdates::UpdateWordsInOneFile(HTMLResource *html_resource, QString old_word, QString new_word)
+void WordUpdates::UpdateWordsInOneFile(const tuple<HTMLResource *, QList<int>> &occurrences, QString old_word, QString new_word)
 {
+    HTMLResource *html_resource;
+    QList<int> offsets;
+    tie(html_resource, offsets) = occurrences;
     Q_ASSERT(html_resource);
     QWriteLocker locker(&html_resource->GetLock());
     QString text = html_resource->GetText();
-    QList<HTMLSpellCheck::MisspelledWord> words = HTMLSpellCheck::GetWords(text);
 
     // Change in reverse to preserve location information
-    for (int i = words.count() - 1; i >= 0; i--) {
-        HTMLSpellCheck::MisspelledWord word = words[i];
-        if (word.text != old_word) {
+    for (int i = offsets.count() - 1; i >= 0; i--) {
+        if (text.midRef(offsets[i], old_word.length()) != old_word) {
             continue;
         }
-        text.replace(word.offset, word.length, new_word);
+        text.replace(offsets[i], old_word.length(), new_word);
     }
     html_resource->SetText(text);
 }
@@ -23,17 +23,24 @@
 #ifndef WORDUPDATES_H
 #define WORDUPDATES_H
 
+#include <boost/tuple/tuple.hpp>
+
 class HTMLResource;
+class WordIndex;
 
 class WordUpdates
 {
 
 public:
 
-    static void UpdateWordInAllFiles(const QList<HTMLResource *> &html_resources, const QString old_word, QString new_word);
+    /**
+     * Replaces the word in the files that use it, as found by the index.
+     * Files not using the word are left untouched.
+     */
+    static void UpdateWordInAllFiles(const WordIndex &word_index, const QString old_word, QString new_word);
 
 private:
-    static void UpdateWordsInOneFile(HTMLResource *html_resource, QString old_word, QString new_word);
+    static void UpdateWordsInOneFile(const boost::tuple<HTMLResource *, QList<int>> &occurrences, QString old_word, QString new_word);
 };
 
 #endif // WORDUPDATES_H
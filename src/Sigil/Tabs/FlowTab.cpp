@@ -75,23 +75,58 @@ FlowTab::FlowTab(HTMLResource &resource,
     m_suspendTabReloading(false),
     m_defaultCaretLocationToTop(false)
 {
+    m_Layout.addWidget(m_views);
+    // The editor, its highlighter and the web view are only created when the
+    // tab first becomes the current one (see CreateViewsIfRequired), so tabs
+    // opened in the background cost next to nothing until they are shown.
+}
+
+FlowTab::~FlowTab()
+{
+    // Explicitly disconnect signals because Modified is causing the ResourceModified
+    // function to be called after we delete BV and PV later in this destructor.
+    // No idea how that's possible but this prevents a segfault...
+    disconnect();
+    m_WellFormedCheckComponent.deleteLater();
+
+    if (m_wBookView) {
+        delete m_wBookView;
+        m_wBookView = 0;
+    }
+
+    if (m_wCodeView) {
+        delete m_wCodeView;
+        m_wCodeView = 0;
+    }
+
+    if (m_views) {
+        delete(m_views);
+        m_views = 0;
+    }
+}
+
+void FlowTab::CreateViewsIfRequired()
+{
+    if (m_wBookView || m_wCodeView) {
+        return;
+    }
+
     // Loading a flow tab can take a while. We set the wait
     // cursor and clear it at the end of the delayed initialization.
     QApplication::setOverrideCursor(Qt::WaitCursor);
 
-    if (view_state == MainWindow::ViewState_BookView) {
+    if (m_ViewState == MainWindow::ViewState_BookView) {
         CreateBookViewIfRequired(false);
     } else {
         CreateCodeViewIfRequired(false);
     }
 
-    m_Layout.addWidget(m_views);
     LoadSettings();
 
-    // We need to set this in the constructor too,
+    // We need to set this before the tab is shown,
     // so that the ContentTab focus handlers don't
     // get called when the tab is created.
-    if (view_state == MainWindow::ViewState_BookView) {
+    if (m_ViewState == MainWindow::ViewState_BookView) {
         setFocusProxy(m_wBookView);
         ConnectBookViewSignalsToSlots();
     } else {
@@ -104,13 +139,32 @@ FlowTab::FlowTab(HTMLResource &resource,
     QTimer::singleShot(0, this, SLOT(DelayedInitialization()));
 }
 
-FlowTab::~FlowTab()
+bool FlowTab::ReleaseViews()
 {
-    // Explicitly disconnect signals because Modified is causing the ResourceModified
-    // function to be called after we delete BV and PV later in this destructor.
-    // No idea how that's possible but this prevents a segfault...
-    disconnect();
-    m_WellFormedCheckComponent.deleteLater();
+    if (!m_wBookView && !m_wCodeView) {
+        return true;
+    }
+
+    if (m_initialLoad || !IsLoadingFinished()) {
+        return false;
+    }
+
+    SaveTabContent();
+    // Come back to where the user left off when the views are created again.
+    ClearPendingScroll();
+
+    if (m_ViewState == MainWindow::ViewState_CodeView) {
+        m_PositionToScrollTo = m_wCodeView->GetCursorPosition();
+    } else if (m_wBookView) {
+        m_CaretLocationToScrollTo = m_wBookView->GetCaretLocationUpdate();
+    }
+
+    disconnect(&m_HTMLResource, SIGNAL(TextChanging()), this, SLOT(ResourceTextChanging()));
+    disconnect(&m_HTMLResource, SIGNAL(LinkedResourceUpdated()), this, SLOT(LinkedResourceModified()));
+    disconnect(&m_HTMLResource, SIGNAL(LinkedStylesheetUpdated(const QString &)), this, SLOT(LinkedStylesheetModified(const QString &)));
+    disconnect(&m_HTMLResource, SIGNAL(Modified()), this, SLOT(ResourceModified()));
+    disconnect(&m_HTMLResource, SIGNAL(LoadedFromDisk()), this, SLOT(ReloadTabIfPending()));
+    setFocusProxy(NULL);
 
     if (m_wBookView) {
         delete m_wBookView;
@@ -122,10 +176,12 @@ FlowTab::~FlowTab()
         m_wCodeView = 0;
     }
 
-    if (m_views) {
-        delete(m_views);
-        m_views = 0;
-    }
+    // The content is always loaded fresh from the resource.
+    m_previousViewState = m_ViewState;
+    m_safeToLoad = false;
+    m_bookViewNeedsReload = false;
+    m_initialLoad = true;
+    return true;
 }
 
 void FlowTab::CreateBookViewIfRequired(bool is_delayed_load)
@@ -359,7 +415,7 @@ void FlowTab::LoadTabContent()
     // In BV, we will only allow loading if the document is well formed, since loading the
     //        resource into BV and then saving will alter badly formed sections of text.
     if (m_ViewState == MainWindow::ViewState_BookView) {
-        if (m_safeToLoad && m_bookViewNeedsReload) {
+        if (m_safeToLoad && m_bookViewNeedsReload && m_wBookView) {
             m_wBookView->CustomSetDocument(m_HTMLResource.GetFullPath(), m_HTMLResource.GetText());
             m_bookViewNeedsReload = false;
         }
@@ -408,6 +464,22 @@ void FlowTab::ResourceModified()
 
 void FlowTab::LinkedResourceModified()
 {
+    MainWindow::clearMemoryCaches();
+    emit ReloadPreview();
+    ResourceModified();
+    ReloadTabIfPending();
+}
+
+void FlowTab::LinkedStylesheetModified(const QString &path)
+{
+    // Preview swaps in the stylesheet by itself
+    emit PreviewStylesheetChanged(path);
+
+    if (m_ViewState == MainWindow::ViewState_BookView && !m_bookViewNeedsReload &&
+        m_wBookView && m_wBookView->ReloadStylesheet(path)) {
+        return;
+    }
+
     MainWindow::clearMemoryCaches();
     ResourceModified();
     ReloadTabIfPending();
@@ -782,6 +854,12 @@ Searchable *FlowTab::GetSearchableContent()
 
 void FlowTab::ScrollToFragment(const QString &fragment)
 {
+    if (m_initialLoad) {
+        ClearPendingScroll();
+        m_FragmentToScroll = QUrl(fragment);
+        return;
+    }
+
     if (m_ViewState == MainWindow::ViewState_BookView) {
         m_wBookView->ScrollToFragment(fragment);
     } else if (m_ViewState == MainWindow::ViewState_CodeView) {
@@ -791,6 +869,12 @@ void FlowTab::ScrollToFragment(const QString &fragment)
 
 void FlowTab::ScrollToLine(int line)
 {
+    if (m_initialLoad) {
+        ClearPendingScroll();
+        m_LineToScrollTo = line;
+        return;
+    }
+
     if (m_ViewState == MainWindow::ViewState_CodeView) {
         m_wCodeView->ScrollToLine(line);
     }
@@ -803,6 +887,12 @@ void FlowTab::ScrollToLine(int line)
 
 void FlowTab::ScrollToPosition(int cursor_position)
 {
+    if (m_initialLoad) {
+        ClearPendingScroll();
+        m_PositionToScrollTo = cursor_position;
+        return;
+    }
+
     if (m_ViewState == MainWindow::ViewState_CodeView) {
         m_wCodeView->ScrollToPosition(cursor_position);
     }
@@ -810,6 +900,12 @@ void FlowTab::ScrollToPosition(int cursor_position)
 
 void FlowTab::ScrollToCaretLocation(QString caret_location_update)
 {
+    if (m_initialLoad) {
+        ClearPendingScroll();
+        m_CaretLocationToScrollTo = caret_location_update;
+        return;
+    }
+
     if (m_ViewState == MainWindow::ViewState_BookView) {
         m_wBookView->ExecuteCaretUpdate(caret_location_update);
     }
@@ -817,6 +913,11 @@ void FlowTab::ScrollToCaretLocation(QString caret_location_update)
 
 void FlowTab::ScrollToTop()
 {
+    if (m_initialLoad) {
+        ClearPendingScroll();
+        return;
+    }
+
     if (m_wBookView) {
         m_wBookView->ScrollToTop();
     }
@@ -826,6 +927,14 @@ void FlowTab::ScrollToTop()
     }
 }
 
+void FlowTab::ClearPendingScroll()
+{
+    m_FragmentToScroll = QUrl();
+    m_LineToScrollTo = -1;
+    m_PositionToScrollTo = -1;
+    m_CaretLocationToScrollTo.clear();
+}
+
 void FlowTab::AutoFixWellFormedErrors()
 {
     if (m_ViewState == MainWindow::ViewState_CodeView) {
@@ -1499,6 +1608,7 @@ void FlowTab::DelayedConnectSignalsToSlots()
 {
     connect(&m_HTMLResource, SIGNAL(TextChanging()), this, SLOT(ResourceTextChanging()));
     connect(&m_HTMLResource, SIGNAL(LinkedResourceUpdated()), this, SLOT(LinkedResourceModified()));
+    connect(&m_HTMLResource, SIGNAL(LinkedStylesheetUpdated(const QString &)), this, SLOT(LinkedStylesheetModified(const QString &)));
     connect(&m_HTMLResource, SIGNAL(Modified()), this, SLOT(ResourceModified()));
     connect(&m_HTMLResource, SIGNAL(LoadedFromDisk()), this, SLOT(ReloadTabIfPending()));
 }
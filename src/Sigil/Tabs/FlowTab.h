@@ -129,6 +129,22 @@ public:
 
     bool IsLoadingFinished();
 
+    /**
+     * Creates the editor for the tab and starts loading the content.
+     * Until this is called the tab is a lightweight placeholder,
+     * which is how tabs that were never shown stay.
+     */
+    void CreateViewsIfRequired();
+
+    /**
+     * Saves the content and deletes the editors, returning the tab
+     * to a placeholder. The caret position is restored when the views
+     * are created again.
+     *
+     * @return \c false if the tab is still loading and was left alone.
+     */
+    bool ReleaseViews();
+
     /**
      * Scrolls the tab to the specified fragment (if in Book View).
      *
@@ -300,6 +316,18 @@ signals:
     void UpdatePreview();
     void UpdatePreviewImmediately();
 
+    /**
+     * Emitted when a file the page links to changed. The
+     * text is the same, so the preview has to be reloaded.
+     */
+    void ReloadPreview();
+
+    /**
+     * Emitted when a stylesheet the page links to changed on disk,
+     * so the preview can swap it in without reloading the page.
+     */
+    void PreviewStylesheetChanged(const QString &path);
+
     void InspectElement();
 
 
@@ -346,6 +374,10 @@ private slots:
     void ResourceModified();
     void LinkedResourceModified();
 
+    // Called when a linked stylesheet is modified. A Book View
+    // showing the page swaps in the stylesheet without a reload.
+    void LinkedStylesheetModified(const QString &path);
+
     // Called when the underlying text inside the control is being replaced
     // Store our caret location as required.
     void ResourceTextChanging();
@@ -363,6 +395,11 @@ private:
     void ConnectBookViewSignalsToSlots();
     void ConnectCodeViewSignalsToSlots();
 
+    /**
+     * Forgets where the tab should scroll to once it is loaded.
+     */
+    void ClearPendingScroll();
+
 
     ///////////////////////////////
     // PRIVATE MEMBER VARIABLES
@@ -371,7 +408,7 @@ private:
     /**
      * The fragment to scroll to after the tab is initialized.
      */
-    const QUrl m_FragmentToScroll;
+    QUrl m_FragmentToScroll;
 
     /**
      * The line to scroll to after the tab is initialized.
@@ -40,6 +40,10 @@
 #include "Tabs/WellFormedContent.h"
 #include "Tabs/TabBar.h"
 
+// The number of flow tabs that keep their editors loaded. The views of the
+// least recently used tabs past this are released to save memory.
+static const int MAX_LOADED_FLOW_TABS = 8;
+
 TabManager::TabManager(QWidget *parent)
     :
     QTabWidget(parent)
@@ -148,15 +152,17 @@ void TabManager::ReloadTabDataForResources(const QList<Resource *> &resources)
 
 void TabManager::ReopenTabs(MainWindow::ViewState view_state)
 {
-    ContentTab &currentTab = GetCurrentContentTab();
+    Resource &current_resource = GetCurrentContentTab().GetLoadedResource();
     QList<Resource *> resources = GetTabResources();
     foreach(Resource * resource, resources) {
         CloseTabForResource(*resource);
     }
+    // Only the current tab is loaded now, the rest are
+    // loaded when the user first switches to them.
     foreach(Resource * resource, resources) {
-        OpenResource(*resource, -1, -1, QString(), view_state);
+        OpenResource(*resource, -1, -1, QString(), view_state, QUrl(), false, true);
     }
-    OpenResource(currentTab.GetLoadedResource(), -1, -1, QString(), view_state);
+    OpenResource(current_resource, -1, -1, QString(), view_state);
 }
 
 
@@ -198,7 +204,8 @@ void TabManager::OpenResource(Resource &resource,
                               const QString &caret_location_to_scroll_to,
                               MainWindow::ViewState view_state,
                               const QUrl &fragment,
-                              bool precede_current_tab)
+                              bool precede_current_tab,
+                              bool in_background)
 {
     if (SwitchedToExistingTab(resource, line_to_scroll_to, position_to_scroll_to, caret_location_to_scroll_to, fragment)) {
         return;
@@ -209,7 +216,7 @@ void TabManager::OpenResource(Resource &resource,
                           caret_location_to_scroll_to, view_state, fragment, grab_focus);
 
     if (new_tab) {
-        AddNewContentTab(new_tab, precede_current_tab);
+        AddNewContentTab(new_tab, precede_current_tab, in_background);
         emit ShowStatusMessageRequest("");
     } else {
         QString message = tr("Cannot edit file") + ": " + resource.Filename();
@@ -302,6 +309,11 @@ void TabManager::MakeCentralTab(ContentTab *tab)
 void TabManager::EmitTabChanged()
 {
     ContentTab *current_tab = qobject_cast<ContentTab *>(currentWidget());
+    FlowTab *flow_tab = qobject_cast<FlowTab *>(current_tab);
+
+    if (flow_tab) {
+        UpdateLoadedFlowTabs(flow_tab);
+    }
 
     if (m_LastContentTab.data() != current_tab) {
         emit TabChanged(m_LastContentTab.data(), current_tab);
@@ -310,6 +322,29 @@ void TabManager::EmitTabChanged()
 }
 
 
+void TabManager::UpdateLoadedFlowTabs(FlowTab *current_tab)
+{
+    current_tab->CreateViewsIfRequired();
+    QList<QPointer<FlowTab> > loaded_tabs;
+    loaded_tabs.append(QPointer<FlowTab>(current_tab));
+    foreach(QPointer<FlowTab> tab, m_LoadedFlowTabs) {
+        // Skip tabs that have been closed since
+        if (tab && tab.data() != current_tab && indexOf(tab.data()) != -1) {
+            loaded_tabs.append(tab);
+        }
+    }
+
+    // Tabs that are still loading can't be released and keep their place.
+    for (int i = loaded_tabs.count() - 1; i > 0 && loaded_tabs.count() > MAX_LOADED_FLOW_TABS; --i) {
+        if (loaded_tabs.at(i)->ReleaseViews()) {
+            loaded_tabs.removeAt(i);
+        }
+    }
+
+    m_LoadedFlowTabs = loaded_tabs;
+}
+
+
 void TabManager::DeleteTab(ContentTab *tab_to_delete)
 {
     Q_ASSERT(tab_to_delete);
@@ -517,7 +552,7 @@ ContentTab *TabManager::CreateTabForResource(Resource &resource,
 }
 
 
-bool TabManager::AddNewContentTab(ContentTab *new_tab, bool precede_current_tab)
+bool TabManager::AddNewContentTab(ContentTab *new_tab, bool precede_current_tab, bool in_background)
 {
     if (new_tab == NULL) {
         return false;
@@ -525,8 +560,11 @@ bool TabManager::AddNewContentTab(ContentTab *new_tab, bool precede_current_tab)
 
     if (!precede_current_tab) {
         addTab(new_tab, new_tab->GetIcon(), new_tab->GetFilename());
-        setCurrentWidget(new_tab);
-        new_tab->setFocus();
+
+        if (!in_background) {
+            setCurrentWidget(new_tab);
+            new_tab->setFocus();
+        }
     } else {
         insertTab(currentIndex(), new_tab, new_tab->GetIcon(), new_tab->GetFilename());
     }
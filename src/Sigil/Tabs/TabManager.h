@@ -30,6 +30,7 @@
 #include "MainUI/MainWindow.h"
 #include "Tabs/ContentTab.h"
 
+class FlowTab;
 class Resource;
 class HTMLResource;
 class WellFormedContent;
@@ -103,6 +104,7 @@ public slots:
      * @param view_state - In which View should the resource open or switch to.
      * @param fragment - The fragment ID to which the new tab should be scrolled to.
      * @param precede_current_tab - Should the new tab precede the currently opened one.
+     * @param in_background - Should a new tab be added without becoming the current one.
      */
     void OpenResource(Resource &resource,
                       int line_to_scroll_to = -1,
@@ -110,7 +112,8 @@ public slots:
                       const QString &caret_location_to_scroll_to = QString(),
                       MainWindow::ViewState view_state = MainWindow::ViewState_Unknown,
                       const QUrl &fragment = QUrl(),
-                      bool precede_current_tab = false);
+                      bool precede_current_tab = false,
+                      bool in_background = false);
 
     /**
      * Makes the next (right) tab the current one.
@@ -273,9 +276,19 @@ private:
      *
      * @param new_tab The tab to add.
      * @param precede_current_tab Should the new tab precede the current one.
+     * @param in_background Should an appended tab be left as it is rather than made current.
      * @return \c true if the tab was successfully added.
      */
-    bool AddNewContentTab(ContentTab *new_tab, bool precede_current_tab);
+    bool AddNewContentTab(ContentTab *new_tab, bool precede_current_tab, bool in_background = false);
+
+    /**
+     * Makes sure the views of the current flow tab exist and releases
+     * the views of the least recently used flow tabs that go over
+     * the number of flow tabs allowed to keep their views loaded.
+     *
+     * @param current_tab The flow tab that just became the current one.
+     */
+    void UpdateLoadedFlowTabs(FlowTab *current_tab);
 
     ///////////////////////////////
     // PRIVATE MEMBER VARIABLES
@@ -287,6 +300,12 @@ private:
      */
     QPointer<ContentTab> m_LastContentTab;
 
+    /**
+     * The flow tabs that have their views loaded,
+     * the most recently used first.
+     */
+    QList<QPointer<FlowTab> > m_LoadedFlowTabs;
+
     bool m_CheckWellFormedErrors;
 
     QTabBar *m_TabBar;
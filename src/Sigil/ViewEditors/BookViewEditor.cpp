@@ -191,6 +191,7 @@ QString BookViewEditor::GetHtml()
     // Set the xml tag here rather than let Tidy do it.
     // This prevents false mismatches with the cache later on.
     QString html_from_Qt = page()->mainFrame()->toHtml();
+    html_from_Qt = RemoveStylesheetReloadMarkers(html_from_Qt);
     html_from_Qt = RemoveBookViewReplaceSpans(html_from_Qt);
     // Convert nbsp to entity because it cannot be seen and there are issues
     // where CV will remove them if they are a single character.
@@ -236,7 +237,7 @@ void BookViewEditor::SetZoomFactor(float factor)
 
 QString BookViewEditor::SplitSection()
 {
-    QString head     = page()->mainFrame()->documentElement().findFirst("head").toOuterXml();
+    QString head     = RemoveStylesheetReloadMarkers(page()->mainFrame()->documentElement().findFirst("head").toOuterXml());
     QString body_tag = EvaluateJavascript(GET_BODY_TAG_HTML).toString();
     QString segment  = EvaluateJavascript(c_GetBlock % c_GetSegmentHTML).toString();
     emit contentsChangedExtra();
@@ -27,6 +27,7 @@
 #include <QtWidgets/QMessageBox>
 #include <QtWebKit/QWebSettings>
 #include <QtWebKitWidgets/QWebFrame>
+#include <QRegularExpression>
 
 #include "BookManipulation/XercesCppUse.h"
 #include "BookManipulation/XhtmlDoc.h"
@@ -45,6 +46,43 @@ const QString SET_CURSOR_JS =
     "selection.removeAllRanges();"
     "selection.addRange(range);";
 
+// Replaces "removed" top level body elements from "start" with the
+// elements in the markup. Nothing is changed if the markup does not
+// parse into the expected number of elements.
+const QString PATCH_BODY_JS =
+    "(function() {"
+    "var body = document.body;"
+    "var start = %1, removed = %2, inserted = %3;"
+    "if (!body || body.children.length < start + removed) { return false; }"
+    "var fragment = document.createElementNS('http://www.w3.org/1999/xhtml', 'div');"
+    "try { fragment.innerHTML = %4; } catch (e) { return false; }"
+    "if (fragment.children.length != inserted) { return false; }"
+    "var next = body.children[start + removed] || null;"
+    "for (var i = 0; i < removed; i++) { body.removeChild(body.children[start]); }"
+    "while (fragment.firstChild) { body.insertBefore(fragment.firstChild, next); }"
+    "return true;"
+    "})();";
+
+// Points every stylesheet link to the target at a new URL so only that
+// stylesheet is fetched again. The query is the reload marker.
+const QString RELOAD_STYLESHEET_JS =
+    "(function() {"
+    "var target = decodeURIComponent(%1);"
+    "var found = false;"
+    "var links = document.getElementsByTagName('link');"
+    "for (var i = 0; i < links.length; i++) {"
+    "var link = links[i];"
+    "if ((link.getAttribute('rel') || '').toLowerCase() != 'stylesheet' ||"
+    "    decodeURIComponent(link.href.split('?')[0]) != target) { continue; }"
+    "var href = link.getAttribute('href').split('?sigil_reload=')[0];"
+    "link.setAttribute('href', href + '?sigil_reload=' + new Date().getTime());"
+    "found = true;"
+    "}"
+    "return found;"
+    "})();";
+
+const QString STYLESHEET_RELOAD_MARKER = "\\?sigil_reload=\\d+";
+
 
 BookViewPreview::BookViewPreview(QWidget *parent)
     : QWebView(parent),
@@ -138,6 +176,12 @@ void BookViewPreview::CustomSetDocument(const QString &path, const QString &html
     }
 
     m_isLoadFinished = false;
+    m_LoadedPath = path;
+
+    if (!SplitBody(html, m_LoadedHead, m_LoadedBlocks)) {
+        m_LoadedHead = QString();
+    }
+
     // If Tidy is turned off, then Sigil will explode if there is no xmlns
     // on the <html> element. So we will silently add it if needed to ensure
     // no errors occur, to allow loading of documents created outside of
@@ -147,6 +191,169 @@ void BookViewPreview::CustomSetDocument(const QString &path, const QString &html
     setContent(replaced_html.toUtf8(), "application/xhtml+xml", QUrl::fromLocalFile(path));
 }
 
+bool BookViewPreview::PatchDocument(const QString &path, const QString &html)
+{
+    if (!m_isLoadFinished || m_pendingLoadCount > 0 || path != m_LoadedPath || m_LoadedHead.isNull()) {
+        return false;
+    }
+
+    QString head;
+    QStringList blocks;
+
+    if (!SplitBody(html, head, blocks) || head != m_LoadedHead) {
+        return false;
+    }
+
+    // Only the elements between the unchanged ones at
+    // the start and the end of the body are replaced.
+    int old_count = m_LoadedBlocks.count();
+    int new_count = blocks.count();
+    int prefix = 0;
+
+    while (prefix < old_count && prefix < new_count && m_LoadedBlocks.at(prefix) == blocks.at(prefix)) {
+        prefix++;
+    }
+
+    int suffix = 0;
+
+    while (suffix < old_count - prefix && suffix < new_count - prefix &&
+           m_LoadedBlocks.at(old_count - 1 - suffix) == blocks.at(new_count - 1 - suffix)) {
+        suffix++;
+    }
+
+    int removed = old_count - prefix - suffix;
+    int inserted = new_count - prefix - suffix;
+
+    if (removed > 0 || inserted > 0) {
+        QString markup = QStringList(blocks.mid(prefix, inserted)).join(QString());
+        QString javascript = PATCH_BODY_JS.arg(prefix).arg(removed).arg(inserted).arg(JSStringLiteral(markup));
+
+        if (!EvaluateJavascript(javascript).toBool()) {
+            return false;
+        }
+    }
+
+    m_LoadedBlocks = blocks;
+    return true;
+}
+
+bool BookViewPreview::ReloadStylesheet(const QString &path)
+{
+    if (!m_isLoadFinished || m_pendingLoadCount > 0) {
+        return false;
+    }
+
+    QString target = QUrl::fromLocalFile(path).toString(QUrl::FullyEncoded);
+    return EvaluateJavascript(RELOAD_STYLESHEET_JS.arg(JSStringLiteral(target))).toBool();
+}
+
+QString BookViewPreview::RemoveStylesheetReloadMarkers(const QString &html)
+{
+    return QString(html).remove(QRegularExpression(STYLESHEET_RELOAD_MARKER));
+}
+
+bool BookViewPreview::SplitBody(const QString &html, QString &head, QStringList &blocks)
+{
+    blocks.clear();
+    int body_tag_start = html.indexOf("<body");
+    int body_start = body_tag_start < 0 ? -1 : FindTagEnd(html, body_tag_start);
+    int body_end = html.lastIndexOf("</body>");
+
+    if (body_start < 0 || body_end < body_start) {
+        return false;
+    }
+
+    body_start++;
+    head = html.left(body_start) % html.mid(body_end);
+    int depth = 0;
+    int block_start = body_start;
+
+    for (int i = body_start; i < body_end; ++i) {
+        QChar c = html.at(i);
+
+        if (c != QChar('<')) {
+            if (depth == 0 && !c.isSpace()) {
+                return false;
+            }
+
+            continue;
+        }
+
+        if (html.midRef(i, 4) == "<!--" || html.midRef(i, 9) == "<![CDATA[") {
+            if (depth == 0) {
+                return false;
+            }
+
+            int end = html.indexOf(html.at(i + 2) == QChar('-') ? "-->" : "]]>", i);
+
+            if (end < 0 || end > body_end) {
+                return false;
+            }
+
+            i = end + 2;
+            continue;
+        }
+
+        int tag_end = FindTagEnd(html, i);
+
+        if (tag_end < 0 || tag_end > body_end || html.at(i + 1) == QChar('?') || html.at(i + 1) == QChar('!')) {
+            return false;
+        }
+
+        if (html.at(i + 1) == QChar('/')) {
+            depth--;
+        } else if (html.at(tag_end - 1) != QChar('/')) {
+            if (html.midRef(i + 1, 6).compare(QLatin1String("script"), Qt::CaseInsensitive) == 0) {
+                return false;
+            }
+
+            depth++;
+        }
+
+        if (depth < 0) {
+            return false;
+        }
+
+        if (depth == 0) {
+            blocks.append(html.mid(block_start, tag_end + 1 - block_start));
+            block_start = tag_end + 1;
+        }
+
+        i = tag_end;
+    }
+
+    return depth == 0;
+}
+
+int BookViewPreview::FindTagEnd(const QString &html, int tag_start)
+{
+    QChar quote;
+
+    for (int i = tag_start + 1; i < html.length(); ++i) {
+        QChar c = html.at(i);
+
+        if (!quote.isNull()) {
+            if (c == quote) {
+                quote = QChar();
+            }
+        } else if (c == QChar('"') || c == QChar('\'')) {
+            quote = c;
+        } else if (c == QChar('>')) {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+QString BookViewPreview::JSStringLiteral(const QString &string)
+{
+    QString literal(string);
+    literal.replace("\\", "\\\\").replace("\"", "\\\"").replace("\n", "\\n").replace("\r", "\\r")
+           .replace(QChar(0x2028), "\\u2028").replace(QChar(0x2029), "\\u2029");
+    return "\"" % literal % "\"";
+}
+
 bool BookViewPreview::IsLoadingFinished()
 {
     return m_isLoadFinished;
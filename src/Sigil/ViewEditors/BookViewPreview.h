@@ -52,6 +52,31 @@ public:
 
     void CustomSetDocument(const QString &path, const QString &html);
 
+    /**
+     * Shows html in place of the current document by replacing only
+     * the top level body elements that changed, without reloading
+     * the page or running its load scripts again.
+     *
+     * @return False if the page has to be reloaded with CustomSetDocument
+     *         instead because it is another file, the content outside the
+     *         body changed or the body can't be patched.
+     */
+    bool PatchDocument(const QString &path, const QString &html);
+
+    /**
+     * Reloads the stylesheet at path in the displayed page
+     * without reloading the document or its images.
+     *
+     * @return False if the page does not link to the stylesheet.
+     */
+    bool ReloadStylesheet(const QString &path);
+
+    /**
+     * Removes the markers ReloadStylesheet adds to the stylesheet
+     * links of the page from html taken from the page.
+     */
+    static QString RemoveStylesheetReloadMarkers(const QString &html);
+
     bool IsLoadingFinished();
 
     void SetZoomFactor(float factor);
@@ -439,6 +464,28 @@ private:
     int m_pendingLoadCount;
     QString m_pendingScrollToFragment;
 
+    /**
+     * Splits html into everything outside the body and
+     * the markup of each top level element in the body.
+     * Returns false if the body has top level text, comments
+     * or scripts which can't be patched element by element.
+     */
+    static bool SplitBody(const QString &html, QString &head, QStringList &blocks);
+
+    /**
+     * Returns the position of the '>' ending the tag starting at
+     * tag_start, skipping quoted attribute values; -1 if there is none.
+     */
+    static int FindTagEnd(const QString &html, int tag_start);
+
+    static QString JSStringLiteral(const QString &string);
+
+    // What is displayed, as last loaded or patched.
+    // The head is null if the document can't be patched.
+    QString m_LoadedPath;
+    QString m_LoadedHead;
+    QStringList m_LoadedBlocks;
+
     QAction *m_InspectElement;
 
 };
@@ -25,9 +25,11 @@
 #include <boost/shared_ptr.hpp>
 #include <boost/tuple/tuple.hpp>
 
+#include <QtCore/QElapsedTimer>
 #include <QtCore/QFileInfo>
 #include <QtGui/QContextMenuEvent>
 #include <QtCore/QSignalMapper>
+#include <QtCore/QTimer>
 #include <QtWidgets/QAction>
 #include <QtWidgets/QMenu>
 #include <QtGui/QPainter>
@@ -46,6 +48,7 @@
 #include "Misc/XHTMLHighlighter.h"
 #include "Dialogs/ClipEditor.h"
 #include "Misc/CSSHighlighter.h"
+#include "Misc/SettingsSnapshot.h"
 #include "Misc/SettingsStore.h"
 #include "Misc/SpellCheck.h"
 #include "Misc/HTMLSpellCheck.h"
@@ -62,6 +65,8 @@ using boost::tuple;
 
 static const int TAB_SPACES_WIDTH        = 4;
 static const int LINE_NUMBER_MARGIN      = 5;
+// How long each step of the background highlighting may run for
+static const int HIGHLIGHT_STEP_MSECS    = 20;
 
 static const QString XML_OPENING_TAG        = "(<[^>/][^>]*[^>/]>|<[^>/]>)";
 static const QString NEXT_CLOSE_TAG_LOCATION = "</\\s*[^>]+>";
@@ -97,7 +102,8 @@ CodeViewEditor::CodeViewEditor(HighlighterType high_type, bool check_spelling, Q
     m_clipMapper(new QSignalMapper(this)),
     m_MarkedTextStart(-1),
     m_MarkedTextEnd(-1),
-    m_ReplacingInMarkedText(false)
+    m_ReplacingInMarkedText(false),
+    m_HighlightBlockNumber(-1)
 {
     if (high_type == CodeViewEditor::Highlight_XHTML) {
         m_Highlighter = new XHTMLHighlighter(check_spelling, this);
@@ -140,7 +146,7 @@ void CodeViewEditor::CustomSetDocument(QTextDocument &document)
         // QTextDocument gets fired by the syntax highlighting. This in turn causes issues
         // with our own logic trying to do stuff in response to genunine document changes.
         // So we will synchronously highlight now, and block signals while doing so.
-        RehighlightDocument();
+        HighlightDocument();
     }
 
     ResetFont();
@@ -653,8 +659,7 @@ void CodeViewEditor::SetZoomFactor(float factor)
 
 float CodeViewEditor::GetZoomFactor() const
 {
-    SettingsStore settings;
-    return settings.zoomText();
+    return SettingsSnapshot::instance()->zoomText();
 }
 
 
@@ -669,8 +674,7 @@ void CodeViewEditor::Zoom()
 
 void CodeViewEditor::UpdateDisplay()
 {
-    SettingsStore settings;
-    float stored_factor = settings.zoomText();
+    float stored_factor = SettingsSnapshot::instance()->zoomText();
 
     if (stored_factor != m_CurrentZoomFactor) {
         m_CurrentZoomFactor = stored_factor;
@@ -892,31 +896,30 @@ int CodeViewEditor::ReplaceAll(const QString &search_regex,
     SPCRE *spcre = PCRECache::instance()->getObject(search_regex);
     QList<SPCRE::MatchInfo> match_info = spcre->getEveryMatchInfo(text);
 
-    // Run though all match offsets making the replacement in reverse order.
-    // This way changes in text length won't change the offsets as we make
-    // our changes.
-    for (int i = match_info.count() - 1; i >= 0; i--) {
-        QString replaced_text;
+    // Walk back from the last match to find the first one in range.
+    int first_match = match_info.count();
+
+    while (first_match > 0) {
+        const SPCRE::MatchInfo &match = match_info.at(first_match - 1);
+
         if (!wrap) {
             if (direction == Searchable::Direction_Up) {
-                if (match_info.at(i).offset.first > position) {
-                    break;
-                }
-            } else if (!wrap) {
-                if (match_info.at(i).offset.second < position) {
+                if (match.offset.first > position) {
                     break;
                 }
+            } else if (match.offset.second < position) {
+                break;
             }
         }
 
-        bool replacement_made = spcre->replaceText(Utility::Substring(match_info.at(i).offset.first, match_info.at(i).offset.second, text), match_info.at(i).capture_groups_offsets, replacement, replaced_text);
-
-        if (replacement_made) {
-            // Replace the text.
-            text = text.replace(match_info.at(i).offset.first, match_info.at(i).offset.second - match_info.at(i).offset.first, replaced_text);
-            count++;
-        }
+        first_match--;
     }
+
+    // Then build the new text in one pass instead of
+    // replacing each match within the whole text.
+    QString replaced_text;
+    count = spcre->replaceMatches(text, match_info.mid(first_match), replacement, replaced_text);
+    text = replaced_text;
     if (marked_text) {
         // Merge the replaced marked text into the original text and adjust the marker.
         QString replaced_text = toPlainText();
@@ -1833,7 +1836,7 @@ void CodeViewEditor::TextChangedFilter()
     }
 }
 
-void CodeViewEditor::RehighlightDocument()
+void CodeViewEditor::HighlightDocument()
 {
     if (!isVisible()) {
         return;
@@ -1846,6 +1849,65 @@ void CodeViewEditor::RehighlightDocument()
         document()->blockSignals(true);
         m_Highlighter->rehighlight();
         document()->blockSignals(false);
+        m_HighlightBlockNumber = -1;
+    }
+}
+
+
+void CodeViewEditor::RehighlightDocument()
+{
+    if (!isVisible()) {
+        return;
+    }
+
+    if (m_Highlighter) {
+        // The state of every block is already known from when the document
+        // was highlighted, so blocks can be highlighted on their own. Only the
+        // blocks on screen are done now, the rest is done in the background.
+        document()->blockSignals(true);
+        QTextBlock block = firstVisibleBlock();
+
+        while (block.isValid() && block.isVisible() &&
+               blockBoundingGeometry(block).translated(contentOffset()).top() <= viewport()->height()) {
+            m_Highlighter->rehighlightBlock(block);
+            block = block.next();
+        }
+
+        document()->blockSignals(false);
+        bool highlight_pending = m_HighlightBlockNumber != -1;
+        m_HighlightBlockNumber = 0;
+
+        if (!highlight_pending) {
+            QTimer::singleShot(0, this, SLOT(HighlightRemainingBlocks()));
+        }
+    }
+}
+
+
+void CodeViewEditor::HighlightRemainingBlocks()
+{
+    if (!m_Highlighter || m_HighlightBlockNumber == -1) {
+        return;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    QTextBlock block = document()->findBlockByNumber(m_HighlightBlockNumber);
+    document()->blockSignals(true);
+
+    while (block.isValid() && timer.elapsed() < HIGHLIGHT_STEP_MSECS) {
+        m_Highlighter->rehighlightBlock(block);
+        block = block.next();
+    }
+
+    document()->blockSignals(false);
+
+    if (block.isValid()) {
+        // Let the user type and scroll before carrying on
+        m_HighlightBlockNumber = block.blockNumber();
+        QTimer::singleShot(0, this, SLOT(HighlightRemainingBlocks()));
+    } else {
+        m_HighlightBlockNumber = -1;
     }
 }
 
@@ -467,8 +467,18 @@ private slots:
      */
     void TextChangedFilter();
 
+    /**
+     * Highlights the blocks on screen again straight away
+     * and the rest of the document in the background.
+     */
     void RehighlightDocument();
 
+    /**
+     * Highlights the next few blocks of a background highlighting
+     * pass and schedules the next step until the end is reached.
+     */
+    void HighlightRemainingBlocks();
+
     void PasteClipEntryFromName(const QString &name);
 
     /**
@@ -529,6 +539,12 @@ private slots:
 private:
     bool IsMarkedText();
 
+    /**
+     * Highlights the whole document synchronously.
+     * Used when a document is set, when the state of no block is known yet.
+     */
+    void HighlightDocument();
+
     QString GetCurrentWordAtCaret(bool select_word);
 
     bool PasteClipEntry(ClipEditorModel::clipEntry *clip);
@@ -812,6 +828,12 @@ private:
     int m_MarkedTextEnd;
     bool m_ReplacingInMarkedText;
 
+    /**
+     * The block the background highlighting pass continues from,
+     * -1 when there is no pass in progress.
+     */
+    int m_HighlightBlockNumber;
+
     /**
      * The fonts and colors for appearance of xhtml and text.
      */
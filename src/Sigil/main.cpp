@@ -37,6 +37,7 @@
 #include "MainUI/MainApplication.h"
 #include "MainUI/MainWindow.h"
 #include "Misc/AppEventFilter.h"
+#include "Misc/SettingsSnapshot.h"
 #include "Misc/SettingsStore.h"
 #include "Misc/TempFolder.h"
 #include "Misc/UpdateChecker.h"
@@ -235,6 +236,9 @@ int main(int argc, char *argv[])
         QCoreApplication::setOrganizationDomain("sigil-ebook.com");
         QCoreApplication::setApplicationName("sigil");
         QCoreApplication::setApplicationVersion(SIGIL_VERSION);
+        // Load the settings snapshot here on the GUI thread
+        // before worker threads start reading from it.
+        SettingsSnapshot::instance();
         // Setup the translator and load the translation for the selected language
         QTextCodec::setCodecForLocale(QTextCodec::codecForName("utf8"));
         QTranslator translator;